@@ -0,0 +1,194 @@
+/**
+ * wl-color: color all graphs in a directory and write one certificate per graph to a single output file.
+ *
+ * Usage: wl-color <input directory> <output file> [--k 1|2] [--ignore-counting] [--directed] [--certificate histogram|quotient] [--threads N]
+ *
+ * Each output line is "<file>[#<index of the graph in the file>]\t<certificate>". Histograms are "<color>:<count>" pairs
+ * preceded by whether the coloring is stable and the number of iterations. All graphs share one color function, so
+ * histograms are comparable among the lines of one output file. Files are parsed in parallel, but graphs are colored one
+ * after another in file order by the serial compute_coloring, so runs on the same input write the same file. Quotient certificates
+ * are the canonical quotient matrix of CanonicalColorRefinement, preceded by the sorted distinct node labels, are computed
+ * in parallel, and are comparable across runs.
+ */
+
+#include "wl/wl.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct Arguments
+{
+    fs::path input_directory;
+    fs::path output_file;
+    int k = 1;
+    bool ignore_counting = false;
+    bool directed = false;
+    bool quotient = false;
+    size_t num_threads = 0;
+};
+
+static void print_usage()
+{
+    std::cerr << "Usage: wl-color <input directory> <output file> [--k 1|2] [--ignore-counting] [--directed] [--certificate histogram|quotient] [--threads N]"
+              << std::endl;
+}
+
+static bool parse_arguments(int argc, char** argv, Arguments& ref_arguments)
+{
+    auto positional = std::vector<std::string>();
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string(argv[i]);
+        const bool has_value = i + 1 < argc;
+
+        if (argument == "--k" && has_value)
+            ref_arguments.k = std::stoi(argv[++i]);
+        else if (argument == "--ignore-counting")
+            ref_arguments.ignore_counting = true;
+        else if (argument == "--directed")
+            ref_arguments.directed = true;
+        else if (argument == "--certificate" && has_value)
+        {
+            const auto certificate = std::string(argv[++i]);
+            if (certificate != "histogram" && certificate != "quotient")
+                return false;
+            ref_arguments.quotient = (certificate == "quotient");
+        }
+        else if (argument == "--threads" && has_value)
+            ref_arguments.num_threads = std::stoul(argv[++i]);
+        else if (argument.rfind("--", 0) == 0)
+            return false;
+        else
+            positional.push_back(argument);
+    }
+
+    if (positional.size() != 2)
+        return false;
+    ref_arguments.input_directory = positional[0];
+    ref_arguments.output_file = positional[1];
+    return true;
+}
+
+/// @brief The graphs of a file, or their certificates once computed.
+struct FileResult
+{
+    std::vector<wl::EdgeColoredGraph> graphs;
+    std::vector<std::string> certificates;
+};
+
+static std::string get_histogram_certificate(wl::WeisfeilerLeman& engine, const wl::EdgeColoredGraph& graph)
+{
+    // compute_coloring_parallel names colors in scheduling order, which would make the output differ between runs
+    const auto [is_stable, num_iterations, unique, counts] = engine.compute_coloring(graph);
+
+    auto stream = std::ostringstream();
+    stream << (is_stable ? "stable" : "unstable") << " " << num_iterations;
+    for (size_t i = 0; i < unique.size(); ++i)
+        stream << " " << unique[i] << ":" << counts[i];
+    return stream.str();
+}
+
+static std::string get_quotient_certificate(const wl::EdgeColoredGraph& graph)
+{
+    // CanonicalColorRefinement requires the colors 1, ..., k, so the labels are compressed and listed in the certificate
+    auto labels = graph.get_node_labels();
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    auto alpha = std::vector<int>();
+    for (const auto& label : graph.get_node_labels())
+        alpha.push_back(static_cast<int>(std::lower_bound(labels.begin(), labels.end(), label) - labels.begin()) + 1);
+
+    thread_local auto color_refinement = wl::CanonicalColorRefinement();
+    color_refinement.calculate(graph, alpha, true);
+
+    auto stream = std::ostringstream();
+    for (size_t i = 0; i < labels.size(); ++i)
+        stream << (i == 0 ? "" : ",") << labels[i];
+    stream << " " << color_refinement.get_quotient_matrix_string();
+    return stream.str();
+}
+
+int main(int argc, char** argv)
+{
+    auto arguments = Arguments();
+    if (!parse_arguments(argc, argv, arguments))
+    {
+        print_usage();
+        return 2;
+    }
+
+    auto files = std::vector<fs::path>();
+    for (const auto& entry : fs::directory_iterator(arguments.input_directory))
+    {
+        if (entry.is_regular_file())
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+
+    auto pool = std::make_shared<wl::ThreadPool>(arguments.num_threads);
+    auto engine = wl::WeisfeilerLeman(arguments.k, arguments.ignore_counting);
+
+    // One task per file. A single large file is parsed in parallel instead.
+    const size_t num_reader_threads = files.size() == 1 ? arguments.num_threads : 1;
+
+    // Histograms depend on the order in which graphs extend the shared color function, so the tasks only parse them.
+    auto futures = std::vector<std::future<FileResult>>();
+    for (const auto& file : files)
+    {
+        futures.push_back(pool->submit(
+            [&, file]()
+            {
+                auto result = FileResult { wl::read_graphs(file.string(), arguments.directed, num_reader_threads), {} };
+                if (arguments.quotient)
+                {
+                    for (const auto& graph : result.graphs)
+                        result.certificates.push_back(get_quotient_certificate(graph));
+                    result.graphs.clear();
+                }
+                return result;
+            }));
+    }
+
+    auto output = std::ofstream(arguments.output_file);
+    if (!output)
+    {
+        std::cerr << "Cannot open " << arguments.output_file << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        try
+        {
+            auto result = futures[i].get();
+            for (const auto& graph : result.graphs)
+                result.certificates.push_back(get_histogram_certificate(engine, graph));
+
+            for (size_t j = 0; j < result.certificates.size(); ++j)
+            {
+                output << files[i].filename().string();
+                if (result.certificates.size() > 1)
+                    output << "#" << j;
+                output << "\t" << result.certificates[j] << "\n";
+            }
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << files[i] << ": " << error.what() << std::endl;
+            status = 1;
+        }
+    }
+
+    return status;
+}
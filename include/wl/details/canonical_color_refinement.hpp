@@ -9,6 +9,8 @@
 
 #include "wl/details/edge_colored_graph.hpp"
 #include "wl/details/printer.hpp"
+#include "wl/details/result_cache.hpp"
+#include "wl/details/thread_pool.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -16,6 +18,7 @@
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <tuple>
 #include <vector>
@@ -23,11 +26,38 @@
 namespace wl
 {
 
+/// @brief Nonzero entry of a sparse quotient matrix: every vertex of color row has count out-neighbors of color column.
+/// Colors are 1-based. Quotient matrices list their entries sorted by row and then column.
+struct QuotientEntry
+{
+    int row;
+    int column;
+    int count;
+
+    bool operator==(const QuotientEntry& other) const = default;
+};
+
+/// @brief Grouping of a batch of graphs into 1-WL equivalence classes.
+struct EquivalenceClasses
+{
+    std::vector<int> class_ids;                                 // Indexed by graph. Classes are numbered in order of first occurrence
+    std::vector<std::vector<QuotientEntry>> quotient_matrices;  // Indexed by class. Quotient matrix in the format of get_quotient_matrix
+};
+
+/// @brief Final coloring of a call of calculate in flat arrays, with 0-based vertices.
+struct FlatPartition
+{
+    std::vector<int> node_colors;        // Indexed by vertex. Color of the vertex in 1, ..., k
+    std::vector<int> partition_nodes;    // Vertices grouped by color, each group in increasing order
+    std::vector<int> partition_offsets;  // Size k + 1. The vertices of color c are partition_nodes[offsets[c - 1], offsets[c])
+};
+
 class CanonicalColorRefinement
 {
 protected:
     int debug_;
     bool use_stack_;
+    bool invariant_seeding_;
 
     std::vector<std::set<int>> C_;     // Indexed by color. Partition. C[c] is set of vertices with color c
     std::vector<std::vector<int>> A_;  // Indexed by color. A[c] is vertices of color c adjacent to vertices of color r
@@ -36,19 +66,78 @@ protected:
     std::vector<int> maxcdeg_;         // Indexed by color. maxcdeg[c] = max { d^+_r(v) : v is of color c }
     std::vector<int> mincdeg_;         // Indexed by color. mincdeg[c] = min { d^+_r(v) : v is of color c }
 
-    bool valid_QM_;                     // Whether the factor matrix was computed
-    std::vector<std::vector<int>> QM_;  // Factor matrix
+    bool valid_QM_;                  // Whether the factor matrix was computed
+    std::vector<QuotientEntry> QM_;  // Factor matrix
+    std::vector<int> QM_counts_;     // Indexed by color. Workspace of the out-neighbors of a representative per color, zero between rows
+    std::vector<int> QM_columns_;    // Workspace of the colors with nonzero QM_counts
 
     int k_;
     std::deque<int> s_refine_;
     std::vector<bool> in_s_refine_;
 
+    std::shared_ptr<const FlatPartition> partition_;  // Never modified. Every call of calculate creates a new one
+
+    std::vector<int> colors_adj_;      // Colors adjacent to color r
+    std::vector<int> colors_split_;    // Colors in colors_adj that generate non-trivial splits
+    std::vector<bool> in_colors_adj_;  // Indexed by color. Whether the color is in colors_adj
+
+    std::vector<int> refining_nodes_;                 // Workspace of the vertices of color r, split into chunks
+    std::vector<std::vector<int>> touched_nodes_;     // Indexed by chunk. Vertices whose color degree the chunk raised from 0
+    std::vector<std::vector<int>> split_numcdeg_;     // Indexed by position in colors_split. numcdeg of the color
+    std::vector<std::vector<int>> split_new_colors_;  // Indexed by position in colors_split. New color per color degree
+
+    /// @brief Final coloring of a call of calculate, and its quotient matrix if it was computed.
+    struct CachedPartition
+    {
+        std::shared_ptr<const FlatPartition> partition;
+        bool has_quotient_matrix;
+        std::vector<QuotientEntry> quotient_matrix;
+    };
+
+    std::shared_ptr<ResultCache<CachedPartition>> cache_;  // Null unless enabled. Shared by copies
+
+    /// @brief Restore the coloring and quotient matrix of a cached partition of a graph with n vertices.
+    void restore_partition(int n, const CachedPartition& partition);
+
+    void calculate_impl(const EdgeColoredGraph& graph, const std::vector<int>& alpha, ThreadPool* pool, bool calculate_qm);
+
+    template<typename InboundAdjacent>
+    void refine(int num_nodes, const std::vector<int>& alpha, const InboundAdjacent& inbound_adjacent, ThreadPool* pool = nullptr);
+
+    /// @brief Compute cdeg, A, colors_adj, and maxcdeg for the refining color r with chunks of its vertices in the pool.
+    template<typename InboundAdjacent>
+    void compute_color_degrees_parallel(int r, const InboundAdjacent& inbound_adjacent, ThreadPool& pool);
+
+    /// @brief Count the vertices of color s per color degree, from 0 to maxcdeg[s].
+    void count_color_degrees(int s, std::vector<int>& ref_numcdeg) const;
+
+    /// @brief Map the color degrees of color s to their new colors. New colors are numbered and queued here, so calls must follow colors_split.
+    void assign_split_colors(int s, const std::vector<int>& numcdeg, std::vector<int>& ref_new_colors);
+
+    /// @brief Move the vertices of color s to their new colors. Splits of distinct colors touch disjoint cells and vertices.
+    void move_split_vertices(int s, const std::vector<int>& new_colors);
+
     void split_up_color(int s);
 
+    /// @brief Split all colors of colors_split: color degrees and moves run in the pool, new colors are assigned in the serial order.
+    void split_up_colors_parallel(ThreadPool& pool);
+
     void calculate_quotient_matrix(const EdgeColoredGraph& graph);
 
+    /// @brief Append the row of a representative vertex to a quotient matrix in time proportional to its degree.
+    /// get_column maps a neighbor to its 1-based column, which must be at most the size of QM_counts_.
+    template<typename GetColumn>
+    void append_quotient_row(int row, const std::vector<int>& adjacent, GetColumn&& get_column, std::vector<QuotientEntry>& ref_quotient_matrix);
+
 public:
-    CanonicalColorRefinement(int debug = 0, bool use_stack = false) : debug_(debug), use_stack_(use_stack), valid_QM_(false) {}
+    CanonicalColorRefinement(int debug = 0, bool use_stack = false) :
+        debug_(debug),
+        use_stack_(use_stack),
+        invariant_seeding_(false),
+        valid_QM_(false),
+        partition_(std::make_shared<FlatPartition>())
+    {
+    }
     ~CanonicalColorRefinement() {}
 
     /// @brief Calculate the canonical equitable partition of a vertex colored graph.
@@ -56,12 +145,39 @@ public:
     /// @param factor_matrix
     void calculate(const EdgeColoredGraph& graph, bool calculate_qm = false);
 
+    /// @brief Calculate the canonical equitable partition refining the initial coloring alpha instead of the node labels.
+    /// The workspace of previous calls is reused, so repeated calls on graphs of similar size only allocate the FlatPartition of the result.
+    /// @param graph
+    /// @param alpha is indexed by vertex and must use the colors 1, ..., k without gaps.
+    /// @param factor_matrix
+    void calculate(const EdgeColoredGraph& graph, const std::vector<int>& alpha, bool calculate_qm = false);
+
+    /// @brief Like calculate, but large refining colors compute their color degrees in the pool, and the colors they split are split concurrently.
+    /// New colors are numbered and queued as in calculate, so the results are identical.
+    void calculate_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, bool calculate_qm = false);
+
+    void calculate_parallel(const EdgeColoredGraph& graph, const std::vector<int>& alpha, ThreadPool& pool, bool calculate_qm = false);
+
+    /// @brief Group the graphs into 1-WL equivalence classes with a single refinement of their disjoint union.
+    /// Node labels are shared among the graphs, i.e., equal labels are equal initial colors. All graphs must be directed or all undirected.
+    /// The quotient matrices use the colors of the union, renumbered to 1, ..., k per class in increasing order,
+    /// so they are canonical within a batch. Afterwards, get_coloring returns the coloring of the union.
+    /// @param graphs
+    EquivalenceClasses calculate_equivalence_classes(const std::vector<const EdgeColoredGraph*>& graphs);
+
     /**
      * Getters
      */
 
     const std::vector<std::set<int>>& get_coloring() const;
-    const std::vector<std::vector<int>>& get_quotient_matrix() const;
+    /// @brief The final coloring in flat arrays, with 0-based vertices, valid until the next call of calculate.
+    const std::vector<int>& get_node_colors() const;
+    const std::vector<int>& get_partition_nodes() const;
+    const std::vector<int>& get_partition_offsets() const;
+    /// @brief The final coloring, which stays valid and unchanged after later calls of calculate.
+    std::shared_ptr<const FlatPartition> get_partition() const;
+    /// @brief The sparse quotient matrix, valid after calculate with calculate_qm set.
+    const std::vector<QuotientEntry>& get_quotient_matrix() const;
     std::string get_quotient_matrix_string() const;
 
     /**
@@ -70,6 +186,16 @@ public:
 
     void set_debug(int debug);
     void set_use_stack(bool use_stack);
+    /// @brief Refine the initial coloring by the out-degrees before calculate and calculate_parallel, see compute_degree_seeded_coloring.
+    /// The partition stays the same, but the colors are numbered differently.
+    void set_invariant_seeding(bool invariant_seeding);
+
+    /// @brief Keep the partitions of up to capacity calls of calculate and calculate_parallel, keyed by the content hash of the graph
+    /// and the initial coloring, and evict the least recently used. A capacity of 0 disables the cache.
+    void set_cache_capacity(size_t capacity);
+
+    /// @brief Hits, misses, and evictions since the cache was enabled.
+    CacheStatistics get_cache_statistics() const;
 
     /**
      * Translators
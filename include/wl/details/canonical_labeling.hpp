@@ -0,0 +1,79 @@
+/**
+ * A canonical labeling search by individualization-refinement on top of CanonicalColorRefinement.
+ *
+ * Each search node refines its coloring to the canonical equitable partition, individualizes each vertex of the first smallest non-singleton cell,
+ * and branches. Leaves are discrete partitions, i.e., labelings, and the labeling with the lexicographically smallest certificate is canonical.
+ * Leaves with equal certificates yield automorphisms, and the orbits of the automorphisms that fix the individualized vertices prune the siblings.
+ */
+
+#ifndef WL_DETAILS_CANONICAL_LABELING_HPP_
+#define WL_DETAILS_CANONICAL_LABELING_HPP_
+
+#include "wl/details/canonical_color_refinement.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+struct CanonicalForm
+{
+    std::vector<int> labeling;               // Indexed by vertex. labeling[v] is the canonical position of vertex v
+    std::vector<int> node_labels;            // Indexed by canonical position. Node labels in canonical order
+    std::vector<std::pair<int, int>> edges;  // Sorted outbound edges between canonical positions
+    uint64_t hash;                           // Hash of node_labels and edges
+
+    bool operator==(const CanonicalForm& other) const { return node_labels == other.node_labels && edges == other.edges; }
+    bool operator!=(const CanonicalForm& other) const { return !(*this == other); }
+};
+
+class CanonicalLabeling
+{
+protected:
+    CanonicalColorRefinement refinement_;  // Workspace shared by all search nodes
+
+    const EdgeColoredGraph* graph_;
+    std::vector<int> initial_alpha_;
+
+    bool has_best_;
+    CanonicalForm first_;  // First leaf, used to detect automorphisms
+    CanonicalForm best_;   // Leaf with the smallest certificate so far
+
+    std::vector<std::vector<int>> generators_;  // Automorphisms found so far
+    std::vector<int> path_;                     // Individualized vertices from the root to the current node
+
+    size_t num_nodes_;
+    size_t num_leaves_;
+
+    std::vector<int> refine(const std::vector<int>& alpha);
+
+    void search(const std::vector<int>& alpha);
+
+    void visit_leaf(const std::vector<int>& colors);
+
+    bool is_in_explored_orbit(int vertex, const std::vector<int>& explored) const;
+
+public:
+    CanonicalLabeling();
+
+    /// @brief Calculate the canonical form of a vertex colored graph.
+    /// Isomorphic graphs, including their node labels, get identical canonical forms.
+    const CanonicalForm& calculate(const EdgeColoredGraph& graph);
+
+    /**
+     * Getters
+     */
+
+    const CanonicalForm& get_canonical_form() const;
+    uint64_t get_hash() const;
+    const std::vector<std::vector<int>>& get_automorphism_generators() const;
+    size_t get_num_search_nodes() const;
+    size_t get_num_leaves() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef WL_DETAILS_CERTIFICATE_STORE_HPP_
+#define WL_DETAILS_CERTIFICATE_STORE_HPP_
+
+#include "wl/details/canonical_color_refinement.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief 128-bit fingerprint of a certificate.
+struct Fingerprint
+{
+    uint64_t high;
+    uint64_t low;
+
+    bool operator==(const Fingerprint& other) const { return high == other.high && low == other.low; }
+    bool operator!=(const Fingerprint& other) const { return !(*this == other); }
+};
+
+struct CertificateStoreOptions
+{
+    size_t num_bloom_filter_bits = 0;  // Size of the Bloom filter in front of the store. 0 disables it
+    int num_bloom_filter_hashes = 4;   // Number of bits set per certificate in the Bloom filter
+    bool verify = false;               // Keep the certificates and compare them exactly. Otherwise, equal fingerprints are duplicates
+};
+
+/// @brief Thread-safe set of WL certificates, i.e., color histograms or canonical quotient matrices, that assigns each certificate an id.
+///
+/// Certificates are identified by a 128-bit fingerprint, so without verification two distinct certificates
+/// are merged with probability about 2^-128 per pair. With verification, the certificates are kept and compared exactly.
+/// The store is split into shards by fingerprint. Lookups only take a shared lock of one shard, and the optional
+/// Bloom filter answers most lookups of unseen certificates without taking any lock.
+class CertificateStore
+{
+private:
+    struct Entry
+    {
+        size_t id;
+        std::vector<int> certificate;  // Empty unless verification is enabled
+    };
+
+    struct FingerprintHash
+    {
+        size_t operator()(const Fingerprint& fingerprint) const { return static_cast<size_t>(fingerprint.low); }
+    };
+
+    struct Shard
+    {
+        std::unordered_multimap<Fingerprint, Entry, FingerprintHash> entries;
+        mutable std::shared_mutex mutex;
+    };
+
+    CertificateStoreOptions m_options;
+    std::vector<Shard> m_shards;
+    std::vector<std::atomic<uint64_t>> m_bloom_filter;
+    std::atomic<size_t> m_size;
+
+    Shard& get_shard(const Fingerprint& fingerprint);
+    const Shard& get_shard(const Fingerprint& fingerprint) const;
+
+    bool bloom_filter_may_contain(const Fingerprint& fingerprint) const;
+    void add_to_bloom_filter(const Fingerprint& fingerprint);
+
+    /// @brief Return the id of the certificate in the shard, or NOT_FOUND. The caller holds the lock of the shard.
+    size_t find(const Shard& shard, const Fingerprint& fingerprint, const std::vector<int>& certificate) const;
+
+public:
+    static constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    explicit CertificateStore(const CertificateStoreOptions& options = CertificateStoreOptions());
+
+    CertificateStore(const CertificateStore&) = delete;
+    CertificateStore& operator=(const CertificateStore&) = delete;
+
+    /// @brief Certificate of the color histogram returned by compute_coloring.
+    static std::vector<int> make_certificate(const std::vector<int>& unique, const std::vector<int>& counts);
+
+    /// @brief Certificate of a quotient matrix as returned by CanonicalColorRefinement::get_quotient_matrix.
+    static std::vector<int> make_certificate(const std::vector<QuotientEntry>& quotient_matrix);
+
+    static Fingerprint get_fingerprint(const std::vector<int>& certificate);
+
+    /// @brief Return the id of the certificate and whether it was inserted, i.e., whether it was unseen.
+    std::pair<size_t, bool> insert(const std::vector<int>& certificate);
+
+    /// @brief Return the id of the certificate, or NOT_FOUND.
+    size_t find(const std::vector<int>& certificate) const;
+
+    bool contains(const std::vector<int>& certificate) const;
+
+    /// @brief Color the graph and insert the certificate of its color histogram.
+    std::pair<size_t, bool> insert_coloring(WeisfeilerLeman& engine,
+                                            const EdgeColoredGraph& graph,
+                                            size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    size_t size() const;
+
+    const CertificateStoreOptions& get_options() const;
+};
+
+}
+
+#endif
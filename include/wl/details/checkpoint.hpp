@@ -0,0 +1,81 @@
+#ifndef WL_DETAILS_CHECKPOINT_HPP_
+#define WL_DETAILS_CHECKPOINT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief When a long run writes checkpoints. A checkpoint is written after a round if either condition holds.
+struct CheckpointOptions
+{
+    std::string path;              // File of the checkpoint. Each checkpoint replaces the previous one atomically
+    size_t every_num_rounds = 0;   // Write a checkpoint every that many rounds, 0 disables
+    double every_num_seconds = 0;  // Write a checkpoint once that many seconds passed since the last one, 0 disables
+};
+
+/* Compact native-endian binary encoding of checkpoints */
+
+template<typename T>
+void write_binary(std::ostream& out, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T read_binary(std::istream& in)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    auto value = T();
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        throw std::runtime_error("read_binary: unexpected end of checkpoint");
+    }
+    return value;
+}
+
+/// @brief Write the size of the vector followed by its elements.
+template<typename T>
+void write_binary_vector(std::ostream& out, const std::vector<T>& values)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    write_binary<uint64_t>(out, values.size());
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template<typename T>
+std::vector<T> read_binary_vector(std::istream& in)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto size = read_binary<uint64_t>(in);
+    auto values = std::vector<T>();
+    // Grow in bounded steps so that a corrupt size fails on the missing data instead of allocating it.
+    constexpr size_t MAX_NUM_VALUES_PER_STEP = (size_t(1) << 24) / sizeof(T);
+    while (values.size() < size)
+    {
+        const auto begin = values.size();
+        values.resize(begin + std::min<size_t>(size - begin, MAX_NUM_VALUES_PER_STEP));
+        if (!in.read(reinterpret_cast<char*>(values.data() + begin), static_cast<std::streamsize>((values.size() - begin) * sizeof(T))))
+        {
+            throw std::runtime_error("read_binary_vector: unexpected end of checkpoint");
+        }
+    }
+    return values;
+}
+
+/// @brief Write a file through a temporary file in the same directory that is renamed over path, so that path always holds a complete file.
+void write_file_atomically(const std::string& path, const std::function<void(std::ostream&)>& write);
+
+}
+
+#endif
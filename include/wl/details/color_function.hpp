@@ -0,0 +1,93 @@
+#ifndef WL_DETAILS_COLOR_FUNCTION_HPP_
+#define WL_DETAILS_COLOR_FUNCTION_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace wl
+{
+
+using Color = int;
+using AdjacentColor = std::pair<Color, Color>;
+/// @brief Head of a context: the color of the node, or a negative packed label of an initial context.
+/// It is 64-bit so that pairs of 32-bit labels pack without collisions.
+using ContextColor = int64_t;
+using NodeColorContext = std::tuple<ContextColor, std::vector<AdjacentColor>, std::vector<AdjacentColor>>;
+
+/// @brief Color of the contexts that a frozen color function has not seen.
+/// Every color derived from an unknown color is unknown as well, since no known context contains it.
+inline constexpr Color UNKNOWN_COLOR = std::numeric_limits<Color>::max();
+
+/// @brief What a frozen color function does with contexts it has not seen.
+enum class UnseenContextPolicy
+{
+    UNKNOWN_COLOR,  // Map them to the unknown color
+    THROW           // Throw UnseenContextError, which stops the run early
+};
+
+/// @brief Thrown by a frozen color function with UnseenContextPolicy::THROW on an unseen context.
+class UnseenContextError : public std::runtime_error
+{
+public:
+    UnseenContextError() : std::runtime_error("ColorFunction::get_or_insert: unseen context in a frozen color function") {}
+};
+
+/// @brief Injective mapping from node color contexts to colors.
+///
+/// The mapping is read-mostly: after the first few graphs almost every context is already known.
+/// Lookups of known contexts therefore only take a shared lock, and only unseen contexts take the exclusive lock.
+/// A single instance can be shared by several engines that run concurrently in different threads.
+///
+/// For inference, the mapping can be frozen. A frozen color function is immutable, so lookups take no lock at all,
+/// and unseen contexts are handled by the UnseenContextPolicy instead of growing the mapping.
+class ColorFunction
+{
+private:
+    std::map<NodeColorContext, Color> m_color_function;
+    mutable std::shared_mutex m_mutex;
+
+    std::atomic<bool> m_frozen;
+    UnseenContextPolicy m_policy;
+    Color m_unknown_color;
+
+    Color get_unseen_color() const;
+
+public:
+    ColorFunction();
+
+    ColorFunction(const ColorFunction&) = delete;
+    ColorFunction& operator=(const ColorFunction&) = delete;
+
+    /// @brief Return the color of the context, assigning the next free color if the context is unseen.
+    /// If the color function is frozen, unseen contexts are handled by its UnseenContextPolicy instead.
+    Color get_or_insert(NodeColorContext&& node_color_context);
+
+    /// @brief Make the color function immutable from now on. Can be called while other threads use it, but only once.
+    void freeze(UnseenContextPolicy policy = UnseenContextPolicy::UNKNOWN_COLOR, Color unknown_color = UNKNOWN_COLOR);
+
+    bool is_frozen() const;
+
+    UnseenContextPolicy get_unseen_context_policy() const;
+
+    Color get_unknown_color() const;
+
+    size_t size() const;
+
+    /// @brief Write the mapping in a compact binary form.
+    void write(std::ostream& out) const;
+
+    /// @brief Replace the mapping by one written by write. The color function must not be frozen.
+    void read(std::istream& in);
+};
+
+}
+
+#endif
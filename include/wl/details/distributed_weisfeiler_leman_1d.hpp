@@ -0,0 +1,113 @@
+/**
+ * A distributed implementation of 1-WL where each worker rank owns a contiguous range of vertices.
+ *
+ * Rank 0 is the coordinator, ranks 1, ..., P are workers. The color function is split into one shard per worker by context hash.
+ * Each round, the workers send their distinct contexts to the workers that own them, which look them up in their shards.
+ * New contexts get consecutive colors in order of their first vertex, from offsets that the coordinator computes as a prefix sum
+ * of the number of new contexts per worker, so the colors match WeisfeilerLeman1D exactly. Finally, the workers exchange the
+ * colors of boundary (ghost) vertices with the workers that reference them. The coordinator only handles O(P) numbers per round.
+ */
+
+#ifndef WL_DETAILS_DISTRIBUTED_WEISFEILER_LEMAN_1D_HPP_
+#define WL_DETAILS_DISTRIBUTED_WEISFEILER_LEMAN_1D_HPP_
+
+#include "wl/details/color_function.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/transport.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief The part of a graph that a worker needs: its own vertices with their adjacency in global vertex ids.
+struct GraphPartition
+{
+    int num_nodes;                          // Number of vertices of the whole graph
+    bool directed;                          //
+    std::vector<int> boundaries;            // Indexed by worker. Worker w owns the vertices [boundaries[w], boundaries[w + 1])
+    int worker;                             // Index of the worker that owns this partition
+    std::vector<int> node_labels;           // Indexed by owned vertex - boundaries[worker]
+    std::vector<int64_t> outbound_offsets;  // CSR offsets of the outbound adjacency of owned vertices
+    std::vector<int> outbound_nodes;        //
+    std::vector<int> outbound_labels;       //
+    std::vector<int64_t> inbound_offsets;   // CSR offsets of the inbound adjacency of owned vertices, only for directed graphs
+    std::vector<int> inbound_nodes;         //
+    std::vector<int> inbound_labels;        //
+
+    int get_begin() const { return boundaries.at(worker); }
+    int get_end() const { return boundaries.at(worker + 1); }
+};
+
+/// @brief Boundaries of num_workers contiguous vertex ranges of nearly equal size, see GraphPartition.
+std::vector<int> get_partition_boundaries(int num_nodes, int num_workers);
+
+/// @brief Split the graph into num_workers partitions of contiguous vertex ranges of nearly equal size.
+std::vector<GraphPartition> partition_graph(const EdgeColoredGraph& graph, int num_workers);
+
+struct LabeledEdge
+{
+    int source;
+    int target;
+    int label;
+};
+
+/// @brief Build the partition of the worker on the calling rank from the input of that rank alone, without the whole graph in one process.
+/// node_labels are the labels of the vertices that the worker owns by get_partition_boundaries(num_nodes, P).
+/// edges may be any part of the edge list, as long as every edge is passed on exactly one worker rank.
+/// All worker ranks must call this collectively; it sends each edge to the owners of its endpoints.
+GraphPartition distribute_graph(Transport& transport, int num_nodes, bool directed, std::vector<int> node_labels, const std::vector<LabeledEdge>& edges);
+
+/// @brief The shard of the distributed color function that a worker owns: the contexts whose hash maps to that worker.
+class ColorFunctionShard
+{
+private:
+    std::map<NodeColorContext, Color> m_color_function;
+
+public:
+    ColorFunctionShard();
+
+    /// @brief Return the color of the context, or -1 if it has none yet.
+    Color find(const NodeColorContext& node_color_context) const;
+
+    void insert(const NodeColorContext& node_color_context, Color color);
+
+    size_t size() const;
+};
+
+/// @brief Coordinator of the distributed 1-WL.
+class DistributedWeisfeilerLeman1D
+{
+private:
+    size_t m_num_colors;  // Number of contexts over all shards
+    bool m_ignore_counting;
+
+public:
+    explicit DistributedWeisfeilerLeman1D(bool ignore_counting = false);
+
+    /* Getters */
+
+    size_t get_coloring_function_size() const;
+
+    bool get_ignore_counting() const;
+
+    /// @brief Run the coordinator on rank 0 of the transport until the workers on the other ranks converge or max_num_iterations is reached.
+    /// Returns the same result as WeisfeilerLeman1D::compute_coloring. Later runs continue the same color function if the workers keep their shards.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(Transport& transport,
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max());
+};
+
+/// @brief Run a worker of the distributed 1-WL on rank partition.worker + 1 of the transport with its shard of the color function.
+void run_weisfeiler_leman_1d_worker(Transport& transport, const GraphPartition& partition, ColorFunctionShard& ref_shard, bool ignore_counting = false);
+
+/// @brief Run a worker of the distributed 1-WL with a new shard, for a coordinator that has not colored other graphs.
+void run_weisfeiler_leman_1d_worker(Transport& transport, const GraphPartition& partition, bool ignore_counting = false);
+
+}
+
+#endif
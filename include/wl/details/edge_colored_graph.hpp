@@ -1,8 +1,10 @@
 #ifndef WL_DETAILS_EDGE_COLORED_GRAPH_HPP_
 #define WL_DETAILS_EDGE_COLORED_GRAPH_HPP_
 
+#include "wl/details/graph_view.hpp"
 #include "wl/details/printer.hpp"
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
@@ -12,12 +14,12 @@ namespace wl
 class EdgeColoredGraph
 {
 private:
-    std::vector<std::vector<int>> m_outgoing_edges;
-    std::vector<std::vector<int>> m_ingoing_edges;
+    std::vector<std::vector<EdgeId>> m_outgoing_edges;
+    std::vector<std::vector<EdgeId>> m_ingoing_edges;
     std::vector<std::vector<int>> m_outgoing_adjacent;
     std::vector<std::vector<int>> m_ingoing_adjacent;
-    std::vector<std::unordered_map<int, std::vector<int>>> m_outgoing_edges_between;
-    std::vector<std::unordered_map<int, std::vector<int>>> m_ingoing_edges_between;
+    std::vector<std::unordered_map<int, std::vector<EdgeId>>> m_outgoing_edges_between;
+    std::vector<std::unordered_map<int, std::vector<EdgeId>>> m_ingoing_edges_between;
     std::vector<int> m_node_labels;
     std::vector<int> m_edge_labels;
     bool m_directed;
@@ -29,39 +31,52 @@ public:
 
     void add_edge(int src_node, int dst_node, int label = 0);
 
-    const std::vector<int>& get_outbound_edges(int node) const;
+    const std::vector<EdgeId>& get_outbound_edges(int node) const;
 
-    const std::vector<int>& get_inbound_edges(int node) const;
+    const std::vector<EdgeId>& get_inbound_edges(int node) const;
 
     const std::vector<int>& get_outbound_adjacent(int node) const;
 
     const std::vector<int>& get_inbound_adjacent(int node) const;
 
+    /// @brief Outbound neighbors with the labels of the edges to them, see GraphView.
+    LabeledNeighborSpan get_outbound_neighbors(int node) const;
+
+    /// @brief Inbound neighbors with the labels of the edges from them, see GraphView.
+    LabeledNeighborSpan get_inbound_neighbors(int node) const;
+
     int get_num_nodes() const;
 
-    int get_num_edges() const;
+    EdgeId get_num_edges() const;
 
     int get_node_label(int node) const;
 
-    int get_edge_label(int edge) const;
+    int get_edge_label(EdgeId edge) const;
 
     const std::vector<int>& get_node_labels() const;
 
     const std::vector<int>& get_edge_labels() const;
 
-    const std::vector<int>& get_edges(int src_node, int dst_node) const;
+    const std::vector<EdgeId>& get_edges(int src_node, int dst_node) const;
 
     bool is_directed() const;
 
+    /// @brief Hash of the direction, the node labels, and the labeled edges in insertion order.
+    /// Equal graphs have equal hashes, isomorphic graphs in general do not.
+    uint64_t get_content_hash() const;
+
     std::string to_string() const;
 };
 
+static_assert(GraphView<EdgeColoredGraph>);
+
 struct GraphColoring
 {
     std::vector<int> colorings;
 
     std::pair<std::vector<int>, std::vector<int>> get_frequencies() const;
 
+    /// @brief Return true iff both colorings induce the same partition of the nodes (or node pairs).
     bool is_identical_to(const GraphColoring& other) const;
 };
 
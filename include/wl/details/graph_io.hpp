@@ -0,0 +1,56 @@
+#ifndef WL_DETAILS_GRAPH_IO_HPP_
+#define WL_DETAILS_GRAPH_IO_HPP_
+
+#include "wl/details/edge_colored_graph.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief Read-only view of a whole file, memory mapped where the platform supports it.
+class MappedFile
+{
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::string m_buffer;  // Contents of the file if it could not be mapped
+
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view get_view() const;
+};
+
+/**
+ * Readers. Files are split into chunks at line boundaries that num_threads threads parse in parallel, or one per hardware thread if num_threads is 0.
+ */
+
+/// @brief Read a graph in DIMACS format: "p edge <num_nodes> <num_edges>", edges "e <u> <v> [<label>]", and node labels "n <v> <label>",
+/// with 1-based vertices. Lines starting with "c" are comments.
+EdgeColoredGraph read_dimacs(const std::string& path, bool directed = false, size_t num_threads = 0);
+
+/// @brief Read a labeled edge list: edges "<u> <v> [<label>]" and node labels "n <v> <label>", with 0-based vertices.
+/// The number of vertices is one more than the largest vertex. Lines starting with "#" or "%" are comments.
+EdgeColoredGraph read_edge_list(const std::string& path, bool directed = false, size_t num_threads = 0);
+
+/// @brief Read a file with one undirected graph per line in graph6 or sparse6 format.
+std::vector<EdgeColoredGraph> read_graph6(const std::string& path, size_t num_threads = 0);
+
+/// @brief Parse a single graph in graph6 format, or in sparse6 format if it starts with ':'.
+EdgeColoredGraph parse_graph6(std::string_view line);
+
+/// @brief Read all graphs of a file, choosing the format by extension: .g6, .s6 (graph6/sparse6), .dimacs, .col, .clq (DIMACS), and edge lists otherwise.
+std::vector<EdgeColoredGraph> read_graphs(const std::string& path, bool directed = false, size_t num_threads = 0);
+
+}
+
+#endif
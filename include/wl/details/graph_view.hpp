@@ -0,0 +1,99 @@
+#ifndef WL_DETAILS_GRAPH_VIEW_HPP_
+#define WL_DETAILS_GRAPH_VIEW_HPP_
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+
+namespace wl
+{
+
+/// @brief Id of an edge. Graphs may have more than 2^31 edges, while node ids and labels are ints.
+using EdgeId = int64_t;
+
+/// @brief A neighbor of a node and the label of the edge between them.
+struct LabeledNeighbor
+{
+    int node;
+    int label;
+};
+
+template<typename R>
+concept LabeledNeighborRange = std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, LabeledNeighbor>;
+
+/// @brief Read-only graph interface of the engines that run on user graph types without converting them to an EdgeColoredGraph.
+///
+/// Nodes are 0, ..., num_nodes - 1 and labels are non-negative. An undirected edge is a neighbor of both of its nodes,
+/// and the inbound neighbors of undirected graphs are not used. EdgeColoredGraph is a model of the concept.
+template<typename G>
+concept GraphView = requires(const G& graph, int node) {
+    { graph.get_num_nodes() } -> std::convertible_to<int>;
+    { graph.get_node_label(node) } -> std::convertible_to<int>;
+    { graph.is_directed() } -> std::convertible_to<bool>;
+    { graph.get_outbound_neighbors(node) } -> LabeledNeighborRange;
+    { graph.get_inbound_neighbors(node) } -> LabeledNeighborRange;
+};
+
+/// @brief Zero-copy range over adjacency stored as parallel arrays of neighbors and edge ids, with the labels indexed by edge id.
+class LabeledNeighborSpan
+{
+private:
+    const int* m_nodes;
+    const EdgeId* m_edges;
+    const int* m_edge_labels;
+    size_t m_size;
+
+public:
+    class Iterator
+    {
+    private:
+        const int* m_nodes;
+        const EdgeId* m_edges;
+        const int* m_edge_labels;
+
+    public:
+        using value_type = LabeledNeighbor;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() : m_nodes(nullptr), m_edges(nullptr), m_edge_labels(nullptr) {}
+        Iterator(const int* nodes, const EdgeId* edges, const int* edge_labels) : m_nodes(nodes), m_edges(edges), m_edge_labels(edge_labels) {}
+
+        LabeledNeighbor operator*() const { return { *m_nodes, m_edge_labels[*m_edges] }; }
+
+        Iterator& operator++()
+        {
+            ++m_nodes;
+            ++m_edges;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const { return m_nodes == other.m_nodes; }
+    };
+
+    LabeledNeighborSpan(const int* nodes, const EdgeId* edges, const int* edge_labels, size_t size) :
+        m_nodes(nodes),
+        m_edges(edges),
+        m_edge_labels(edge_labels),
+        m_size(size)
+    {
+    }
+
+    Iterator begin() const { return Iterator(m_nodes, m_edges, m_edge_labels); }
+    Iterator end() const { return Iterator(m_nodes + m_size, m_edges + m_size, m_edge_labels); }
+    size_t size() const { return m_size; }
+};
+
+static_assert(std::forward_iterator<LabeledNeighborSpan::Iterator>);
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef WL_DETAILS_JOB_QUEUE_HPP_
+#define WL_DETAILS_JOB_QUEUE_HPP_
+
+#include "wl/details/canonical_color_refinement.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/thread_pool.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <cstddef>
+#include <future>
+#include <limits>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace wl
+{
+
+using ColoringResult = std::tuple<bool, size_t, std::vector<int>, std::vector<int>>;
+
+/// @brief Result of CanonicalColorRefinement::calculate.
+struct RefinementResult
+{
+    std::vector<std::set<int>> coloring;
+    std::vector<QuotientEntry> quotient_matrix;
+};
+
+/// @brief Asynchronous submission of coloring and refinement jobs to a work-stealing thread pool.
+///
+/// The engine and the graphs must outlive the returned futures. Engines are thread-safe,
+/// so one engine can serve all jobs. Graphs with at least min_num_nodes_to_split nodes are colored
+/// by compute_coloring_parallel, which splits every iteration into sub-tasks on the same pool, and refined by calculate_parallel.
+class JobQueue
+{
+private:
+    std::shared_ptr<ThreadPool> m_pool;
+    int m_min_num_nodes_to_split;
+
+public:
+    explicit JobQueue(std::shared_ptr<ThreadPool> pool = ThreadPool::get_default(), int min_num_nodes_to_split = 4096);
+
+    const std::shared_ptr<ThreadPool>& get_pool() const;
+
+    int get_min_num_nodes_to_split() const;
+
+    std::future<ColoringResult>
+    submit_coloring(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    /// @brief Compute the canonical equitable partition and its quotient matrix. Each worker reuses the workspace of one CanonicalColorRefinement
+    /// for graphs below min_num_nodes_to_split.
+    std::future<RefinementResult> submit_refinement(const EdgeColoredGraph& graph);
+};
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef WL_DETAILS_KERNELS_HPP_
+#define WL_DETAILS_KERNELS_HPP_
+
+#include "wl/details/color_function.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wl
+{
+
+/* Hot loops of the engines, built for several instruction sets if WL_ENABLE_TARGET_CLONES is set.
+ *
+ * The variant that matches the CPU is selected once when the library is loaded, so a generic x86-64 build
+ * still uses AVX2 and AVX-512 where they are available. All variants compute the same results. */
+
+/// @brief Sort the adjacent colors in increasing order.
+void sort_adjacent_colors(std::vector<AdjacentColor>& ref_colors);
+
+/// @brief Return true iff second[i] == first[i] + offset for all i < size, where the addition wraps around.
+bool is_shifted_copy(const int* first, const int* second, size_t size, int offset);
+
+/// @brief Count the occurrences of each color. The order of the distinct colors is unspecified.
+void count_colors(const std::vector<int>& colors, std::vector<int>& ref_unique, std::vector<int>& ref_counts);
+
+/// @brief Write the pairs (palette[row[k]], palette[column[k * stride]]) for k < size, the compositions of 2-FWL in the full layout.
+void compose_pair_colors(const uint8_t* row, const uint8_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out);
+
+void compose_pair_colors(const uint16_t* row, const uint16_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out);
+
+void compose_pair_colors(const uint32_t* row, const uint32_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out);
+
+/// @brief The instruction set of the selected variants: "x86-64-v4", "x86-64-v3", or "default" if no variant applies or none were built.
+std::string get_kernel_target();
+
+}
+
+#endif
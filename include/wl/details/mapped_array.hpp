@@ -0,0 +1,88 @@
+#ifndef WL_DETAILS_MAPPED_ARRAY_HPP_
+#define WL_DETAILS_MAPPED_ARRAY_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief Zero-initialized writable memory mapping of an anonymous temporary file.
+///
+/// The file is created in directory and unlinked right away, so it disappears when the mapping is destroyed or the process ends.
+/// Under memory pressure, the kernel writes dirty pages back to the file instead of swapping, so mappings may exceed the RAM.
+class FileMapping
+{
+private:
+    void* m_data;
+    size_t m_size;
+
+public:
+    /// @brief Map size bytes of a new file in directory, or in the temporary directory if it is empty. Throws std::runtime_error on failure.
+    FileMapping(size_t size, const std::string& directory);
+    ~FileMapping();
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    void* data() const;
+    size_t size() const;
+
+    /// @brief Hint that the pages are mostly accessed in increasing order, so the kernel reads ahead and drops pages behind.
+    void advise_sequential() const;
+
+    /// @brief Hint that the bytes in [offset, offset + length) are accessed soon, so the kernel starts reading them in the background.
+    void will_need(size_t offset, size_t length) const;
+};
+
+/// @brief Fixed-size array of trivially copyable values in heap memory or in a FileMapping.
+template<typename T>
+class MappedArray
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+private:
+    std::vector<T> m_memory;
+    std::unique_ptr<FileMapping> m_mapping;
+    size_t m_size;
+
+public:
+    MappedArray() : m_memory(), m_mapping(), m_size(0) {}
+
+    /// @brief Allocate size zero-initialized values in heap memory, or in a file in directory if mapped is set.
+    MappedArray(size_t size, bool mapped, const std::string& directory = "") :
+        m_memory(mapped ? 0 : size),
+        m_mapping(mapped && size > 0 ? std::make_unique<FileMapping>(size * sizeof(T), directory) : nullptr),
+        m_size(size)
+    {
+    }
+
+    T* data() { return m_mapping ? static_cast<T*>(m_mapping->data()) : m_memory.data(); }
+    const T* data() const { return m_mapping ? static_cast<const T*>(m_mapping->data()) : m_memory.data(); }
+    size_t size() const { return m_size; }
+    bool is_mapped() const { return m_mapping != nullptr; }
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+
+    /// @brief Hint that the values are mostly accessed in increasing order if the array is mapped.
+    void advise_sequential() const
+    {
+        if (m_mapping)
+            m_mapping->advise_sequential();
+    }
+
+    /// @brief Prefetch the values in [begin, begin + count) if the array is mapped.
+    void will_need(size_t begin, size_t count) const
+    {
+        if (m_mapping)
+            m_mapping->will_need(begin * sizeof(T), count * sizeof(T));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef WL_DETAILS_MIN_HASH_HPP_
+#define WL_DETAILS_MIN_HASH_HPP_
+
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief Fixed-size sketch of the multiset of (round, color) over all rounds of a run.
+struct MinHashSketch
+{
+    std::vector<uint64_t> values;
+
+    /// @brief Estimate the weighted Jaccard similarity of the two multisets, i.e., the sum of the minimum counts over the sum of the maximum counts.
+    double estimate_similarity(const MinHashSketch& other) const;
+
+    bool operator==(const MinHashSketch& other) const = default;
+};
+
+/// @brief Weighted MinHash of WL colorings by one permutation hashing with rotation densification.
+///
+/// The k-th occurrence of a color in a round is hashed as its own element, which turns the weighted Jaccard similarity of the
+/// multisets into the Jaccard similarity of sets. Every element is hashed once into one of num_hashes bins that keeps the minimum,
+/// so a round costs O(num_nodes) regardless of the sketch size. Sketches are only comparable if both graphs were colored with
+/// engines that share a color function, like the histograms of compute_coloring.
+class MinHashSketcher
+{
+private:
+    size_t m_num_hashes;
+    uint64_t m_seed;
+
+    void add_round(size_t round, const std::vector<int>& colors, std::unordered_map<int, int>& ref_occurrences, std::vector<uint64_t>& ref_bins) const;
+
+    MinHashSketch finish(std::vector<uint64_t>&& bins) const;
+
+public:
+    static constexpr uint64_t EMPTY_BIN = std::numeric_limits<uint64_t>::max();
+
+    explicit MinHashSketcher(size_t num_hashes = 128, uint64_t seed = 0);
+
+    size_t get_num_hashes() const;
+
+    uint64_t get_seed() const;
+
+    /// @brief Sketch the multisets of colors of the given rounds, e.g. a NodeColorHistory or colorings computed elsewhere.
+    MinHashSketch compute_sketch(const std::vector<GraphColoring>& rounds) const;
+
+    /// @brief Run the engine like compute_coloring and sketch every round including the initial coloring, without building histograms.
+    /// Returns whether the coloring is stable, the number of iterations, and the sketch.
+    std::tuple<bool, size_t, MinHashSketch>
+    compute_sketch(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations = std::numeric_limits<size_t>::max()) const;
+};
+
+/// @brief In-memory locality-sensitive hashing index of MinHash sketches split into bands.
+///
+/// Two sketches are candidates iff all values of at least one band are equal. With similarity s, this happens with probability
+/// 1 - (1 - s^rows_per_band)^num_bands, so the rows per band set the threshold and the bands the recall. Queries take time
+/// linear in the number of bands and candidates, not in the number of sketches.
+class MinHashIndex
+{
+private:
+    size_t m_num_bands;
+    size_t m_rows_per_band;
+    std::vector<std::unordered_map<uint64_t, std::vector<size_t>>> m_buckets;  // Indexed by band. Ids by the hash of the band
+    size_t m_size;
+
+    uint64_t get_band_hash(const MinHashSketch& sketch, size_t band) const;
+
+public:
+    MinHashIndex(size_t num_bands, size_t rows_per_band);
+
+    /// @brief Insert the sketch and return its id, which counts the inserted sketches from 0.
+    size_t insert(const MinHashSketch& sketch);
+
+    /// @brief Return the sorted ids of the sketches that share at least one band with the sketch.
+    std::vector<size_t> query(const MinHashSketch& sketch) const;
+
+    size_t size() const;
+
+    size_t get_num_bands() const;
+
+    size_t get_rows_per_band() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef WL_DETAILS_PAIR_COLOR_MATRIX_HPP_
+#define WL_DETAILS_PAIR_COLOR_MATRIX_HPP_
+
+#include "wl/details/color_function.hpp"
+#include "wl/details/mapped_array.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace wl
+{
+
+enum class PairColoringLayout
+{
+    FULL,           // All n^2 pairs
+    UPPER_TRIANGLE  // Pairs (i, j) with i <= j. The color of (j, i) is the transpose of the color of (i, j).
+};
+
+enum class PairColoringStorage
+{
+    MEMORY,      // Heap memory
+    MAPPED_FILE  // Memory mapped temporary files, for pair colorings larger than the RAM
+};
+
+struct PairColoringOptions
+{
+    PairColoringLayout layout = PairColoringLayout::FULL;
+    PairColoringStorage storage = PairColoringStorage::MEMORY;
+    std::string directory = "";  // Directory of the files of MAPPED_FILE. The temporary directory if empty
+};
+
+/// @brief Pair coloring of 2-FWL that stores dense local color ids in the narrowest integer type that fits.
+///
+/// The local ids of a round index into a palette of global colors. Storage starts as uint8_t and
+/// widens to uint16_t and uint32_t as soon as the palette outgrows the current type.
+///
+/// In the upper triangle layout, the color of (j, i) for i < j is obtained through the transpose table.
+/// 2-FWL colors are closed under transposition, i.e., the color of (i, j) determines the color of (j, i).
+/// A frozen color function that maps unseen contexts to one unknown color breaks this, so such colorings add local colors
+/// per pair of a color and its transpose. A global color may then have several local colors.
+///
+/// The local ids are kept in heap memory or in memory mapped files, as configured by the storage options. The palette stays in memory.
+class PairColorMatrix
+{
+private:
+    int m_num_nodes;
+    PairColoringLayout m_layout;
+    PairColoringStorage m_storage;
+    std::string m_directory;
+
+    std::variant<MappedArray<uint8_t>, MappedArray<uint16_t>, MappedArray<uint32_t>> m_local_colors;
+    std::vector<Color> m_palette;                                  // Indexed by local color. The global color
+    std::unordered_map<Color, uint32_t> m_local_ids;               // Inverse of the palette
+    std::map<std::pair<Color, Color>, uint32_t> m_pair_local_ids;  // Indexed by color and transposed color. Local colors of add_color_pair
+    std::vector<uint32_t> m_transpose;                             // Indexed by local color. The local color of the transposed pair
+
+    size_t get_max_num_colors() const;
+
+    void widen();
+
+    /// @brief Advise sequential access to mapped entries in the full layout, whose rows are streamed in order.
+    /// The upper triangle layout reads columns with a stride, so its pages keep the default advice.
+    void advise_access() const;
+
+public:
+    PairColorMatrix();
+
+    /// @brief Create an empty matrix that allocates its entries as configured by the storage and directory of options.
+    explicit PairColorMatrix(const PairColoringOptions& options);
+
+    /// @brief Clear the matrix and allocate storage wide enough for min_num_colors colors.
+    void reset(int num_nodes, PairColoringLayout layout, size_t min_num_colors);
+
+    /// @brief Return the local color of a global color, adding it to the palette if needed.
+    uint32_t add_color(Color color);
+
+    /// @brief Return the local color of a pair with the given color whose transpose has transposed_color,
+    /// adding it and its transpose to the palette if needed. Must not be mixed with add_color and add_transpose.
+    uint32_t add_color_pair(Color color, Color transposed_color);
+
+    /// @brief Record that the local colors are the colors of transposed pairs.
+    void add_transpose(uint32_t local_color, uint32_t transposed_local_color);
+
+    /// @brief Store the local colors of row i, i.e., the pairs (i, j) for j in [0, n) or [i, n) in the upper triangle layout.
+    void set_row(int i, const std::vector<uint32_t>& local_colors);
+
+    /// @brief Call f with a pointer to the raw storage to run a typed inner loop.
+    template<typename F>
+    decltype(auto) visit(F&& f) const
+    {
+        return std::visit([&](const auto& local_colors) -> decltype(auto) { return f(local_colors.data()); }, m_local_colors);
+    }
+
+    /**
+     * Getters
+     */
+
+    int get_num_nodes() const;
+    PairColoringLayout get_layout() const;
+    size_t get_num_colors() const;
+    size_t get_num_entries() const;
+    size_t get_bytes_per_entry() const;
+    PairColoringStorage get_storage() const;
+    const std::string& get_directory() const;
+    const std::vector<Color>& get_palette() const;
+    const std::vector<uint32_t>& get_transpose() const;
+
+    /// @brief Index of the stored entry (i, j), which requires i <= j in the upper triangle layout.
+    size_t index_of(int i, int j) const
+    {
+        if (m_layout == PairColoringLayout::FULL)
+            return static_cast<size_t>(i) * m_num_nodes + j;
+        return static_cast<size_t>(i) * m_num_nodes - static_cast<size_t>(i) * (i - 1) / 2 + (j - i);
+    }
+
+    /// @brief Local color of the pair (i, j) for any i and j.
+    uint32_t get_local_color(int i, int j) const;
+
+    /// @brief Prefetch the stored entries of row i if they are in a mapped file.
+    void will_need_row(int i) const;
+
+    /// @brief Global color of the pair (i, j) for any i and j.
+    Color get_color(int i, int j) const { return m_palette[get_local_color(i, j)]; }
+
+    /// @brief Global colors and their number of occurrences over all n^2 pairs.
+    std::pair<std::vector<int>, std::vector<int>> get_frequencies() const;
+
+    /// @brief Write the matrix in a compact binary form, with entries in their current width.
+    void write(std::ostream& out) const;
+
+    /// @brief Replace the matrix by one written by write.
+    void read(std::istream& in);
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * 1-WL on relational structures: objects with labels and typed tuples (atoms) over them, such as the states of a planning problem.
+ *
+ * Each round, an atom is colored by its predicate and the colors of its arguments in order, and an object by its color and the multiset
+ * of (atom color, argument position) over its occurrences. This refines the same partition of the objects as 1-WL on the encoding with
+ * one auxiliary node per atom, see RelationalStructure::to_graph, but in half the rounds and without auxiliary nodes. A round reads
+ * every argument twice instead of four times.
+ */
+
+#ifndef WL_DETAILS_RELATIONAL_WEISFEILER_LEMAN_HPP_
+#define WL_DETAILS_RELATIONAL_WEISFEILER_LEMAN_HPP_
+
+#include "wl/details/color_function.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief An occurrence of an object as the argument at a position of an atom.
+struct AtomOccurrence
+{
+    int atom;
+    int position;
+};
+
+class RelationalStructure
+{
+private:
+    std::vector<int> m_object_labels;                        // Indexed by object
+    std::vector<int> m_predicates;                           // Indexed by atom
+    std::vector<int> m_argument_offsets;                     // CSR offsets of the arguments of the atoms, one more than atoms
+    std::vector<int> m_arguments;                            //
+    std::vector<std::vector<AtomOccurrence>> m_occurrences;  // Indexed by object. Occurrences in the order the atoms were added
+
+public:
+    RelationalStructure();
+
+    int add_object(int label = 0);
+
+    /// @brief Add the atom predicate(arguments...). Predicates are non-negative and the arity may differ between atoms.
+    int add_atom(int predicate, const std::vector<int>& arguments);
+
+    int get_num_objects() const;
+
+    int get_num_atoms() const;
+
+    int get_object_label(int object) const;
+
+    const std::vector<int>& get_object_labels() const;
+
+    int get_predicate(int atom) const;
+
+    std::span<const int> get_arguments(int atom) const;
+
+    const std::vector<AtomOccurrence>& get_occurrences(int object) const;
+
+    /// @brief Encode the structure as an undirected graph with one auxiliary node per atom, joined to its arguments by edges labeled with the position.
+    /// Objects keep their label, atom nodes are labeled after all object labels by predicate. Nodes 0, ..., num_objects - 1 are the objects.
+    EdgeColoredGraph to_graph() const;
+};
+
+/// @brief Relational 1-WL. The colors are shared with the other engines through the color function.
+class RelationalWeisfeilerLeman
+{
+private:
+    std::shared_ptr<ColorFunction> m_color_function;
+    bool m_ignore_counting;
+
+    Color get_new_color(NodeColorContext&& node_color_context);
+
+public:
+    explicit RelationalWeisfeilerLeman(bool ignore_counting = false, std::shared_ptr<ColorFunction> color_function = nullptr);
+
+    /* Getters */
+
+    bool get_ignore_counting() const;
+
+    const std::shared_ptr<ColorFunction>& get_color_function() const;
+
+    size_t get_coloring_function_size() const;
+
+    /// @brief Run relational 1-WL for at most max_num_iterations or until the colors of the objects converge.
+    /// The histogram counts the colors of the objects and the atoms.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const RelationalStructure& structure,
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    /* Expert interface with more control over the execution */
+
+    /// @brief Compute the initial coloring of the objects based on their labels.
+    GraphColoring compute_initial_coloring(const RelationalStructure& structure);
+
+    /// @brief Compute the colors of the atoms from their predicates and the colors of their arguments.
+    GraphColoring compute_atom_coloring(const RelationalStructure& structure, const GraphColoring& object_coloring);
+
+    /// @brief One step of updating the coloring of the objects.
+    /// Return true iff the coloring has stabilized.
+    bool compute_next_coloring(const RelationalStructure& structure, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring);
+};
+
+}
+
+#endif
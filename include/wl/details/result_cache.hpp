@@ -0,0 +1,107 @@
+#ifndef WL_DETAILS_RESULT_CACHE_HPP_
+#define WL_DETAILS_RESULT_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace wl
+{
+
+struct CacheStatistics
+{
+    size_t num_hits = 0;
+    size_t num_misses = 0;
+    size_t num_evictions = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+/// @brief Thread-safe memo of results keyed by a 64-bit hash of their input, holding at most capacity results in LRU order.
+///
+/// Keys are trusted, i.e., two inputs with the same key share a result. For keys derived from EdgeColoredGraph::get_content_hash,
+/// a wrong hit among N distinct graphs has probability about N^2 / 2^65.
+template<typename Value>
+class ResultCache
+{
+private:
+    using Entry = std::pair<uint64_t, Value>;
+
+    size_t m_capacity;
+    std::list<Entry> m_entries;  // Most recently used first
+    std::unordered_map<uint64_t, typename std::list<Entry>::iterator> m_index;
+    CacheStatistics m_statistics;
+    mutable std::mutex m_mutex;
+
+public:
+    explicit ResultCache(size_t capacity) : m_capacity(capacity), m_entries(), m_index(), m_statistics(), m_mutex() { m_statistics.capacity = capacity; }
+
+    /// @brief Return a copy of the result of the key and mark it as most recently used, or nothing on a miss.
+    std::optional<Value> find(uint64_t key)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_index.find(key);
+        if (it == m_index.end())
+        {
+            ++m_statistics.num_misses;
+            return std::nullopt;
+        }
+
+        ++m_statistics.num_hits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->second;
+    }
+
+    /// @brief Insert or replace the result of the key, evicting the least recently used results beyond the capacity.
+    void insert(uint64_t key, Value value)
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (m_capacity == 0)
+            return;
+
+        const auto it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            it->second->second = std::move(value);
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            return;
+        }
+
+        m_entries.emplace_front(key, std::move(value));
+        m_index.emplace(key, m_entries.begin());
+
+        while (m_entries.size() > m_capacity)
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+            ++m_statistics.num_evictions;
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    CacheStatistics get_statistics() const
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto statistics = m_statistics;
+        statistics.size = m_entries.size();
+        return statistics;
+    }
+};
+
+}
+
+#endif
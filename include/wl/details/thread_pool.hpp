@@ -0,0 +1,98 @@
+#ifndef WL_DETAILS_THREAD_POOL_HPP_
+#define WL_DETAILS_THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief Work-stealing thread pool.
+///
+/// Every worker owns a deque of tasks. Tasks submitted by a worker go to the back of its own deque and are taken LIFO,
+/// which keeps sub-tasks of a large job on the thread that created them. Idle workers steal FIFO from the front of the
+/// other deques. Tasks submitted from outside the pool are distributed round-robin.
+///
+/// A task that waits for its sub-tasks must use wait(), which runs other tasks instead of blocking a worker.
+class ThreadPool
+{
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;  // Indexed by worker
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_next_queue;              // Round-robin index for tasks submitted from outside the pool
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<size_t> m_num_pending;  // Number of queued tasks. Increased while holding m_mutex so that sleeping workers are not missed
+    bool m_stop;
+
+    /// @brief Index of the calling worker of this pool, or -1 for threads outside the pool.
+    int get_worker_index() const;
+
+    void push(std::function<void()>&& task);
+
+    bool pop(int worker_index, std::function<void()>& ref_task);
+
+    void run_worker(int worker_index);
+
+public:
+    /// @brief Create a pool with num_threads workers, or one per hardware thread if num_threads is 0.
+    explicit ThreadPool(size_t num_threads = 0);
+
+    /// @brief Finish all queued tasks and join the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @brief The pool shared by all job queues that do not bring their own.
+    static const std::shared_ptr<ThreadPool>& get_default();
+
+    size_t get_num_threads() const;
+
+    template<typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& f)
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+
+        // std::function requires a copyable target, std::packaged_task is move-only
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        push([task]() { (*task)(); });
+        return future;
+    }
+
+    /// @brief Run one queued task on the calling thread. Return false if there was none.
+    bool run_pending_task();
+
+    /// @brief Wait until the future is ready, running queued tasks in the meantime.
+    template<typename T>
+    void wait(const std::future<T>& future)
+    {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            if (!run_pending_task())
+                std::this_thread::yield();
+        }
+    }
+};
+
+}
+
+#endif
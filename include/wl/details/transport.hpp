@@ -0,0 +1,110 @@
+#ifndef WL_DETAILS_TRANSPORT_HPP_
+#define WL_DETAILS_TRANSPORT_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wl
+{
+
+using Message = std::vector<int>;
+
+/// @brief Point-to-point message passing between the ranks of a distributed computation.
+///
+/// Messages between two ranks are delivered in order. send may block until the receiver has
+/// consumed earlier messages, so ranks must agree on the order of their exchanges.
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    virtual int get_rank() const = 0;
+
+    virtual int get_num_ranks() const = 0;
+
+    virtual void send(int destination, const Message& message) = 0;
+
+    virtual Message receive(int source) = 0;
+};
+
+/// @brief Mailboxes shared by the InProcessTransports of all ranks.
+class InProcessNetwork
+{
+private:
+    struct Mailbox
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Message> messages;
+    };
+
+    int m_num_ranks;
+    std::vector<std::unique_ptr<Mailbox>> m_mailboxes;  // Indexed by source * num_ranks + destination
+
+public:
+    explicit InProcessNetwork(int num_ranks);
+
+    int get_num_ranks() const;
+
+    void send(int source, int destination, const Message& message);
+
+    Message receive(int source, int destination);
+};
+
+/// @brief Transport between threads of one process.
+class InProcessTransport : public Transport
+{
+private:
+    std::shared_ptr<InProcessNetwork> m_network;
+    int m_rank;
+
+public:
+    InProcessTransport(std::shared_ptr<InProcessNetwork> network, int rank);
+
+    int get_rank() const override;
+
+    int get_num_ranks() const override;
+
+    void send(int destination, const Message& message) override;
+
+    Message receive(int source) override;
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/// @brief Transport over connected local stream sockets, usable across fork().
+class SocketTransport : public Transport
+{
+private:
+    int m_rank;
+    std::vector<int> m_sockets;  // Indexed by rank. Connected socket to that rank, or -1 for the own rank
+
+public:
+    SocketTransport(int rank, std::vector<int> sockets);
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    int get_rank() const override;
+
+    int get_num_ranks() const override;
+
+    void send(int destination, const Message& message) override;
+
+    Message receive(int source) override;
+
+    /// @brief Create connected socket pairs between all ranks.
+    /// The result is indexed by rank and can be passed to the constructor in the process that takes that rank.
+    /// After fork(), each process should close the sockets of the other ranks.
+    static std::vector<std::vector<int>> create_socket_mesh(int num_ranks);
+};
+
+#endif
+
+}
+
+#endif
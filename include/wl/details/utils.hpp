@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cassert>
 #include <climits>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
 
@@ -19,26 +20,28 @@ inline int safe_multiply(int x, int y)
     return x * y;
 }
 
-inline int pairing_function(int x, int y)
+/// @brief Szudzik's pairing function, a bijection between pairs of 32-bit naturals and 64-bit naturals.
+/// The largest pair maps to 2^64 - 1, so it never overflows. Pairs of non-negative ints map below 2^62.
+inline constexpr uint64_t pairing_function(uint32_t x, uint32_t y)
 {
-    int x_sq, y_sq;
-    if (x >= y)
-    {
-        x_sq = safe_multiply(x, x);  // Safe multiplication
-        int x_sq_plus_x = x_sq + x;  // Add x
-        if (x_sq_plus_x < x_sq)
-            throw std::overflow_error("Overflow in addition");
-        return x_sq_plus_x + y;  // Add y
-    }
-    else
-    {
-        y_sq = safe_multiply(y, y);  // Safe multiplication
-        if (y_sq < y)
-            throw std::overflow_error("Overflow in addition");
-        return y_sq + x;  // Add x
-    }
+    const auto x64 = static_cast<uint64_t>(x);
+    const auto y64 = static_cast<uint64_t>(y);
+    return x64 >= y64 ? x64 * x64 + x64 + y64 : y64 * y64 + x64;
 }
 
+/// @brief Finalizer of splitmix64. A bijective mixing function with good avalanche behavior.
+inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline void hash_combine(uint64_t& seed, uint64_t value) { seed = mix64(seed ^ (mix64(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2))); }
+
 inline void lexical_sort(std::vector<int>& items1, std::vector<int>& items2)
 {
     assert(items1.size() == items2.size());
@@ -0,0 +1,71 @@
+#ifndef WL_DETAILS_VERTEX_INVARIANTS_HPP_
+#define WL_DETAILS_VERTEX_INVARIANTS_HPP_
+
+#include "wl/details/color_function.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/graph_view.hpp"
+#include "wl/details/weisfeiler_leman_base.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace wl
+{
+
+/* Vertex invariants that seed the initial coloring of the engines.
+ *
+ * A seed that refines the node labels and is refined by the stable coloring leads to the same stable partition,
+ * since that is the coarsest equitable partition refining the node labels. Seeding only skips the first rounds. */
+
+/// @brief Append the degree per edge label of the neighbors as adjacent colors (degree, edge label), sorted by edge label.
+/// In set mode, the degree is 1 for every edge label that occurs.
+template<CountingMode Mode, LabeledNeighborRange R>
+void append_degree_profile(R&& neighbors, std::vector<int>& ref_labels, std::vector<AdjacentColor>& ref_profile)
+{
+    ref_labels.clear();
+    for (const LabeledNeighbor neighbor : neighbors)
+    {
+        ref_labels.push_back(neighbor.label);
+    }
+    std::sort(ref_labels.begin(), ref_labels.end());
+
+    for (size_t begin = 0; begin < ref_labels.size();)
+    {
+        auto end = begin + 1;
+        while (end < ref_labels.size() && ref_labels[end] == ref_labels[begin])
+        {
+            ++end;
+        }
+        ref_profile.emplace_back((Mode == CountingMode::SET) ? 1 : static_cast<Color>(end - begin), ref_labels[begin]);
+        begin = end;
+    }
+}
+
+/// @brief The seed context of 1-WL: the node label and the out- and in-degree per edge label, where undirected graphs only have out-degrees.
+/// The stable coloring determines it, since it determines the multiset (the set in set mode) of pairs of adjacent color and edge label.
+/// Self-loops are ordinary neighbors to 1-WL, so their count is not an invariant of its own.
+template<CountingMode Mode, GraphView G>
+NodeColorContext get_degree_context(const G& graph, int node)
+{
+    auto labels = std::vector<int>();
+    auto context = NodeColorContext { -static_cast<ContextColor>(graph.get_node_label(node)) - 1, {}, {} };
+
+    append_degree_profile<Mode>(graph.get_outbound_neighbors(node), labels, std::get<1>(context));
+    if (graph.is_directed())
+    {
+        append_degree_profile<Mode>(graph.get_inbound_neighbors(node), labels, std::get<2>(context));
+    }
+    return context;
+}
+
+/// @brief Count the triangles through each node of the underlying simple undirected graph, i.e., ignoring edge labels, directions,
+/// self-loops, and parallel edges. Takes O(m * d) time for the maximum degree d.
+std::vector<int64_t> count_triangles(const EdgeColoredGraph& graph);
+
+/// @brief The seed of CanonicalColorRefinement: the colors 1, ..., k ranking the pairs (alpha[v], out-degree of v) in increasing order.
+/// The ranks do not depend on the numbering of the vertices, so the seeded coloring stays canonical.
+std::vector<int> compute_degree_seeded_coloring(const EdgeColoredGraph& graph, const std::vector<int>& alpha);
+
+}
+
+#endif
@@ -1,51 +1,138 @@
 #ifndef WL_DETAILS_WEISFEILER_LEMAN_HPP_
 #define WL_DETAILS_WEISFEILER_LEMAN_HPP_
 
+#include "wl/details/color_function.hpp"
 #include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/graph_view.hpp"
+#include "wl/details/pair_color_matrix.hpp"
+#include "wl/details/result_cache.hpp"
 #include "wl/details/weisfeiler_leman_1d.hpp"
 #include "wl/details/weisfeiler_leman_2d.hpp"
+#include "wl/details/weisfeiler_leman_base.hpp"
 
+#include <cstdint>
 #include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
 namespace wl
 {
 
-using Color = int;
-using AdjacentColor = std::pair<Color, Color>;
-using NodeColorContext = std::tuple<Color, std::vector<AdjacentColor>, std::vector<AdjacentColor>>;
+/// @brief Create the engine instantiation for k and the counting mode.
+/// A null color function creates a fresh one. The pair coloring options only apply to k = 2.
+std::unique_ptr<WeisfeilerLemanBase> create_weisfeiler_leman(int k,
+                                                             bool ignore_counting,
+                                                             std::shared_ptr<ColorFunction> color_function,
+                                                             const PairColoringOptions& pair_coloring_options = PairColoringOptions());
+
+/// @brief Node colors of all rounds of a run. Round 0 is the initial coloring.
+///
+/// The colors are stored round-major, i.e., as a num_rounds x num_nodes matrix, so that rounds are appended without moving
+/// earlier ones. Viewed with strides, it is the num_nodes x num_rounds feature matrix. For 2-FWL, the color of a node is the color of the pair (v, v).
+struct NodeColorHistory
+{
+    int num_nodes = 0;
+    int num_rounds = 0;
+    std::vector<int32_t> colors;  // colors[round * num_nodes + node]
+
+    int32_t get_color(int node, int round) const { return colors[static_cast<size_t>(round) * num_nodes + node]; }
+};
 
+/// @brief Facade over the 1-WL and 2-FWL engines.
+///
+/// Thread safety: the engine holds its configuration, its optional result cache, which locks internally, and its color function,
+/// which is thread-safe. Several threads may therefore run the same instance, or separate instances that share one ColorFunction,
+/// concurrently. Colors are consistent among all engines that share a color function. The configuration setters
+/// set_invariant_seeding and set_cache_capacity are not synchronized and must not run concurrently with any other call.
 class WeisfeilerLeman
 {
 private:
-    int m_k;
-    WeisfeilerLeman1D m_1wl;
-    WeisfeilerLeman2D m_2wl;
+    std::unique_ptr<WeisfeilerLemanBase> m_engine;
+    std::unique_ptr<ResultCache<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>> m_cache;  // Null unless enabled
 
 public:
     explicit WeisfeilerLeman(int k);
 
     explicit WeisfeilerLeman(int k, bool ignore_counting);
 
+    WeisfeilerLeman(int k, bool ignore_counting, std::shared_ptr<ColorFunction> color_function);
+
+    WeisfeilerLeman(int k, bool ignore_counting, std::shared_ptr<ColorFunction> color_function, const PairColoringOptions& pair_coloring_options);
+
     /* Getters */
 
     int get_k() const;
 
     bool get_ignore_counting() const;
 
+    const std::shared_ptr<ColorFunction>& get_color_function() const;
+
     size_t get_coloring_function_size() const;
 
+    /// @brief Whether the initial coloring refines the node labels by vertex invariants, which gives the same stable partition in fewer rounds.
+    bool get_invariant_seeding() const;
+
+    /// @brief Enable or disable invariant seeding. Clears the cache, since the colors change. Must not run concurrently with colorings.
+    void set_invariant_seeding(bool invariant_seeding);
+
+    /* Memoization of compute_coloring and compute_coloring_parallel */
+
+    /// @brief Keep the results of up to capacity runs, keyed by the content hash of the graph and the iteration limit, and evict the least
+    /// recently used. A hit returns the histogram without any refinement. A capacity of 0 disables the cache. Must not run concurrently with colorings.
+    void set_cache_capacity(size_t capacity);
+
+    /// @brief Hits, misses, and evictions since the cache was enabled.
+    CacheStatistics get_cache_statistics() const;
+
     /* Simple interface to run k-WL for at most max_num_iterations or until convergence. */
 
     std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const EdgeColoredGraph& graph,
                                                                                   size_t max_num_iterations = std::numeric_limits<size_t>::max());
 
+    /// @brief Like compute_coloring, but split large graphs into sub-tasks on the pool.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    /// @brief Run like compute_coloring and record the node colors of every round.
+    /// If stream is not null, every round is also written to it as num_nodes native-endian int32 values as soon as it is computed.
+    std::tuple<bool, size_t, NodeColorHistory> compute_node_color_history(const EdgeColoredGraph& graph,
+                                                                          size_t max_num_iterations = std::numeric_limits<size_t>::max(),
+                                                                          std::ostream* stream = nullptr);
+
+    /// @brief Like compute_coloring, but write checkpoints as configured by options. Only supported for k = 2.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_with_checkpoints(const EdgeColoredGraph& graph,
+                                      const CheckpointOptions& options,
+                                      size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    /// @brief Continue a run of compute_coloring_with_checkpoints from the checkpoint at path, with an identical result.
+    /// Replaces the mapping of the color function by the one in the checkpoint.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> resume_coloring(const EdgeColoredGraph& graph,
+                                                                                 const std::string& path,
+                                                                                 const CheckpointOptions& options = CheckpointOptions(),
+                                                                                 size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
     /* Expert interface with more control over the execution */
 
     GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph);
 
     bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring);
+
+    /// @brief Run 1-WL on any model of GraphView without converting it to an EdgeColoredGraph. Only supported for k = 1.
+    template<GraphView G>
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const G& graph,
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max())
+    {
+        if (auto engine = dynamic_cast<WeisfeilerLeman1D<CountingMode::MULTISET>*>(m_engine.get()))
+            return engine->compute_coloring(graph, max_num_iterations);
+        if (auto engine = dynamic_cast<WeisfeilerLeman1D<CountingMode::SET>*>(m_engine.get()))
+            return engine->compute_coloring(graph, max_num_iterations);
+        throw std::logic_error("compute_coloring: graph views are only supported for k = 1");
+    }
 };
 
 }
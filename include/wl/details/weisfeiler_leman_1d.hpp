@@ -1,60 +1,241 @@
 #ifndef WL_DETAILS_WEISFEILER_LEMAN_1D_HPP_
 #define WL_DETAILS_WEISFEILER_LEMAN_1D_HPP_
 
+#include "wl/details/color_function.hpp"
 #include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/graph_view.hpp"
+#include "wl/details/utils.hpp"
+#include "wl/details/vertex_invariants.hpp"
+#include "wl/details/weisfeiler_leman_base.hpp"
 
 #include <limits>
-#include <map>
+#include <memory>
+#include <ranges>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace wl
 {
 
-using Color = int;
-using AdjacentColor = std::pair<Color, Color>;
-using NodeColorContext = std::tuple<Color, std::vector<AdjacentColor>, std::vector<AdjacentColor>>;
-
-class WeisfeilerLeman1D
+template<CountingMode Mode>
+class WeisfeilerLeman1D final : public WeisfeilerLemanBase
 {
 private:
-    std::map<NodeColorContext, Color> m_color_function;
-    bool m_ignore_counting;
+    std::shared_ptr<ColorFunction> m_color_function;
+    bool m_invariant_seeding;
 
-    std::vector<AdjacentColor> get_colors_pairs(const std::vector<Color>& node_colors,
-                                                const std::vector<int>& node_indices,
-                                                const std::vector<Color>& edge_colors,
-                                                const std::vector<int>& edge_indices);
+    template<LabeledNeighborRange R>
+    static std::vector<AdjacentColor> get_adjacent_colors(const std::vector<Color>& node_colors, R&& neighbors);
 
     Color get_new_color(NodeColorContext&& color_multiset);
 
+    /// @brief Dense numbering of the (color, edge label) pairs of a round, in the order of AdjacentColor.
+    /// In set mode, while the pairs fit a small bitset, the adjacent colors of a node are collected in a bitset instead of a sorted vector.
+    struct BitsetIndex
+    {
+        bool enabled = false;
+        size_t num_words = 0;         // Number of 64-bit words of a bitset
+        std::vector<Color> colors;    // Sorted distinct colors of the round
+        std::vector<int> labels;      // Sorted distinct edge labels
+        std::vector<int> node_ranks;  // Indexed by node. Rank of its color in colors
+        std::vector<int> edge_ranks;  // Indexed by edge. Rank of its label in labels
+    };
+
+    BitsetIndex get_bitset_index(const EdgeColoredGraph& graph, const GraphColoring& current_coloring) const;
+
+    /// @brief Compute the next colors of the nodes in [begin, end).
+    template<GraphView G, bool Directed>
+    void compute_next_coloring_impl(const G& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring, int begin, int end);
+
+    /// @brief Compute the next colors of the nodes in [begin, end) with bitsets of adjacent colors.
+    template<bool Directed>
+    void compute_next_coloring_bitset_impl(const EdgeColoredGraph& graph,
+                                           const GraphColoring& current_coloring,
+                                           GraphColoring& ref_next_coloring,
+                                           const BitsetIndex& index,
+                                           int begin,
+                                           int end);
+
+    void compute_next_coloring_range(const EdgeColoredGraph& graph,
+                                     const GraphColoring& current_coloring,
+                                     GraphColoring& ref_next_coloring,
+                                     const BitsetIndex& index,
+                                     int begin,
+                                     int end);
+
 public:
-    explicit WeisfeilerLeman1D();
+    WeisfeilerLeman1D();
 
-    explicit WeisfeilerLeman1D(bool ignore_counting);
+    /// @brief Create an engine that shares the color function with other engines, possibly running in other threads.
+    explicit WeisfeilerLeman1D(std::shared_ptr<ColorFunction> color_function);
 
     /* Getters */
 
-    size_t get_coloring_function_size() const;
+    int get_k() const override;
+
+    bool get_ignore_counting() const override;
+
+    const std::shared_ptr<ColorFunction>& get_color_function() const override;
+
+    size_t get_coloring_function_size() const override;
+
+    /// @brief Seeds with the degrees per edge label, see get_degree_context.
+    bool get_invariant_seeding() const override;
 
-    bool get_ignore_counting() const;
+    void set_invariant_seeding(bool invariant_seeding) override;
 
     /* Simple interface to run k-WL for at most max_num_iterations or until convergence. */
 
     std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const EdgeColoredGraph& graph,
-                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max());
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
+
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
 
     /* Expert interface with more control over the execution */
 
-    /// @brief Compute the initial coloring of the graph based on the node labels.
+    /// @brief Compute the initial coloring of the graph based on the node labels, and the degrees if invariant seeding is enabled.
     /// Returns a GraphColoring object.
-    GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph);
+    GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph) override;
 
     /// @brief One step of updating the 1-WL coloring.
     /// Return true iff the coloring has stabilized.
-    bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring);
+    bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring) override;
+
+    /* The same interface for any model of GraphView, which runs without converting the graph to an EdgeColoredGraph.
+     * The colors equal those of the EdgeColoredGraph overloads, but rounds always sort vectors and run on the calling thread. */
+
+    template<GraphView G>
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const G& graph,
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max());
+
+    template<GraphView G>
+    GraphColoring compute_initial_coloring(const G& graph);
+
+    template<GraphView G>
+    bool compute_next_coloring(const G& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring);
 };
 
+template<CountingMode Mode>
+template<LabeledNeighborRange R>
+std::vector<AdjacentColor> WeisfeilerLeman1D<Mode>::get_adjacent_colors(const std::vector<Color>& node_colors, R&& neighbors)
+{
+    std::vector<AdjacentColor> adjacent_colors;
+
+    if constexpr (std::ranges::sized_range<R>)
+    {
+        adjacent_colors.reserve(std::ranges::size(neighbors));
+    }
+
+    for (const LabeledNeighbor neighbor : neighbors)
+    {
+        adjacent_colors.emplace_back(node_colors[neighbor.node], neighbor.label);
+    }
+
+    return adjacent_colors;
+}
+
+template<CountingMode Mode>
+template<GraphView G, bool Directed>
+void WeisfeilerLeman1D<Mode>::compute_next_coloring_impl(const G& graph,
+                                                         const GraphColoring& current_coloring,
+                                                         GraphColoring& ref_next_coloring,
+                                                         int begin,
+                                                         int end)
+{
+    for (int node = begin; node < end; ++node)
+    {
+        auto outgoing_colors = get_adjacent_colors(current_coloring.colorings, graph.get_outbound_neighbors(node));
+
+        if constexpr (Directed)
+        {
+            auto ingoing_colors = get_adjacent_colors(current_coloring.colorings, graph.get_inbound_neighbors(node));
+
+            ref_next_coloring.colorings[node] = get_new_color({ current_coloring.colorings[node], std::move(outgoing_colors), std::move(ingoing_colors) });
+        }
+        else
+        {
+            ref_next_coloring.colorings[node] = get_new_color({ current_coloring.colorings[node], std::move(outgoing_colors), {} });
+        }
+    }
+}
+
+template<CountingMode Mode>
+template<GraphView G>
+GraphColoring WeisfeilerLeman1D<Mode>::compute_initial_coloring(const G& graph)
+{
+    const int num_nodes = graph.get_num_nodes();
+    auto current_coloring = std::vector<int>(num_nodes);
+
+    for (int node = 0; node < num_nodes; ++node)
+    {
+        if (m_invariant_seeding)
+        {
+            current_coloring[node] = get_new_color(get_degree_context<Mode>(graph, node));
+            continue;
+        }
+
+        // Both graph labels and colors are natural numbers.
+        // We make the graph labels negative so that they are not confused with colors.
+
+        auto node_label = -static_cast<int>(graph.get_node_label(node)) - 1;
+        current_coloring[node] = get_new_color({ node_label, {}, {} });
+    }
+
+    return GraphColoring { std::move(current_coloring) };
+}
+
+template<CountingMode Mode>
+template<GraphView G>
+bool WeisfeilerLeman1D<Mode>::compute_next_coloring(const G& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+{
+    if (graph.is_directed())
+        compute_next_coloring_impl<G, true>(graph, current_coloring, ref_next_coloring, 0, graph.get_num_nodes());
+    else
+        compute_next_coloring_impl<G, false>(graph, current_coloring, ref_next_coloring, 0, graph.get_num_nodes());
+
+    return current_coloring.is_identical_to(ref_next_coloring);
+}
+
+template<CountingMode Mode>
+template<GraphView G>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman1D<Mode>::compute_coloring(const G& graph, size_t max_num_iterations)
+{
+    auto current_coloring = compute_initial_coloring(graph);
+    auto next_coloring = GraphColoring { std::vector<int>(current_coloring.colorings.size()) };
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
+    {
+        ++num_iterations;
+
+        bool is_stable_i = compute_next_coloring(graph, current_coloring, next_coloring);
+
+        std::swap(current_coloring, next_coloring);
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
+    }
+
+    auto [unique, counts] = current_coloring.get_frequencies();
+    lexical_sort(unique, counts);
+    return { is_stable, num_iterations, std::move(unique), std::move(counts) };
+}
+
+extern template class WeisfeilerLeman1D<CountingMode::MULTISET>;
+extern template class WeisfeilerLeman1D<CountingMode::SET>;
+
 }
 
 #endif
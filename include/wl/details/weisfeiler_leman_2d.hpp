@@ -1,59 +1,126 @@
 #ifndef WL_DETAILS_WEISFEILER_LEMAN_2D_HPP_
 #define WL_DETAILS_WEISFEILER_LEMAN_2D_HPP_
 
+#include "wl/details/color_function.hpp"
 #include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/pair_color_matrix.hpp"
+#include "wl/details/weisfeiler_leman_base.hpp"
 
 #include <limits>
-#include <map>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
 namespace wl
 {
 
-using Color = int;
-using AdjacentColor = std::pair<Color, Color>;
-using NodeColorContext = std::tuple<Color, std::vector<AdjacentColor>, std::vector<AdjacentColor>>;
-
-class WeisfeilerLeman2D
+template<CountingMode Mode>
+class WeisfeilerLeman2D final : public WeisfeilerLemanBase
 {
 private:
-    std::map<NodeColorContext, Color> m_color_function;
-    bool m_ignore_counting;
-
-    std::vector<Color> get_colors(const std::vector<Color>& colors, const std::vector<int>& indices);
+    std::shared_ptr<ColorFunction> m_color_function;
+    PairColoringOptions m_options;
+    bool m_invariant_seeding;
 
     Color get_new_color(NodeColorContext&& color_multiset);
 
-    Color get_subgraph_color(int src_node, int dst_node, const EdgeColoredGraph& graph);
+    /// @brief True iff the color function is frozen and maps unseen contexts to the unknown color. Rounds may then merge
+    /// colors, and pairs of the unknown color may have transposes of different colors.
+    bool may_merge_colors() const;
+
+    /// @brief The labels of the atomic types: the node labels, or the colors of their seed contexts if invariant seeding is enabled.
+    std::vector<int> compute_seed_labels(const EdgeColoredGraph& graph);
+
+    /* Compact pair colorings used by the simple interface */
+
+    /// @brief Color of the pair (i, j) in the next round. In the full layout, columns may hold the transpose of data to read column j sequentially.
+    template<typename T, bool Triangle>
+    Color get_pair_color(const T* data, const T* columns, const PairColorMatrix& current, int i, int j);
+
+    template<typename T, bool Triangle>
+    void compute_next_matrix_impl(const T* data, const PairColorMatrix& current, PairColorMatrix& ref_next);
+
+    bool compute_next_matrix(const PairColorMatrix& current, PairColorMatrix& ref_next);
+
+    /// @brief Store the atomic types in ref_matrix, building their contexts on the pool.
+    void compute_initial_matrix(const EdgeColoredGraph& graph, ThreadPool& pool, PairColorMatrix& ref_matrix);
+
+    /// @brief Refine a coloring after num_iterations rounds until it is stable or max_num_iterations rounds are done.
+    /// Writes checkpoints if options is not null.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> refine_matrix(PairColorMatrix&& current_coloring,
+                                                                               size_t num_iterations,
+                                                                               const EdgeColoredGraph& graph,
+                                                                               const CheckpointOptions* options,
+                                                                               size_t max_num_iterations);
+
+    void write_checkpoint(const EdgeColoredGraph& graph, const PairColorMatrix& coloring, size_t num_iterations, const std::string& path) const;
 
 public:
-    explicit WeisfeilerLeman2D();
+    WeisfeilerLeman2D();
+
+    /// @brief Create an engine that shares the color function with other engines, possibly running in other threads.
+    explicit WeisfeilerLeman2D(std::shared_ptr<ColorFunction> color_function);
 
-    explicit WeisfeilerLeman2D(bool ignore_counting);
+    /// @brief Create an engine whose simple interface stores pair colorings as configured by options.
+    WeisfeilerLeman2D(std::shared_ptr<ColorFunction> color_function, const PairColoringOptions& options);
 
     /* Getters */
 
-    size_t get_coloring_function_size() const;
+    int get_k() const override;
 
-    bool get_ignore_counting() const;
+    bool get_ignore_counting() const override;
 
-    /* Simple interface to run k-WL for at most max_num_iterations or until convergence. */
+    const std::shared_ptr<ColorFunction>& get_color_function() const override;
+
+    size_t get_coloring_function_size() const override;
+
+    const PairColoringOptions& get_pair_coloring_options() const;
+
+    /// @brief Seeds with the degrees per edge label and, when counting, the number of triangles through each node.
+    /// Seeded labels are colors of the color function, so a seeding engine must not share it with one that does not seed.
+    bool get_invariant_seeding() const override;
+
+    void set_invariant_seeding(bool invariant_seeding) override;
+
+    /* Simple interface to run k-WL for at most max_num_iterations or until convergence.
+     * Pair colorings are stored compactly in a PairColorMatrix, see PairColoringOptions.
+     * The atomic types are built on ThreadPool::get_default() unless a pool is passed to compute_coloring_parallel. */
 
     std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const EdgeColoredGraph& graph,
-                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max());
+                                                                                  size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
+
+    /// @brief Like compute_coloring, but build the atomic types on the given pool instead of the default one.
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
+
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_with_checkpoints(const EdgeColoredGraph& graph,
+                                      const CheckpointOptions& options,
+                                      size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
+
+    std::tuple<bool, size_t, std::vector<int>, std::vector<int>> resume_coloring(const EdgeColoredGraph& graph,
+                                                                                 const std::string& path,
+                                                                                 const CheckpointOptions& options,
+                                                                                 size_t max_num_iterations = std::numeric_limits<size_t>::max()) override;
 
     /* Expert interface with more control over the execution */
 
     /// @brief Compute the initial coloring of the graph based on the node labels.
     /// Returns a GraphColoring object.
-    GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph);
+    GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph) override;
+
+    /// @brief Like compute_initial_coloring, but build the atomic types on the given pool instead of the default one.
+    GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph, ThreadPool& pool);
 
     /// @brief One step of updating the 1-WL coloring.
     /// Return true iff the coloring has stabilized.
-    bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring);
+    bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring) override;
 };
 
+extern template class WeisfeilerLeman2D<CountingMode::MULTISET>;
+extern template class WeisfeilerLeman2D<CountingMode::SET>;
+
 }
 
 #endif
@@ -0,0 +1,97 @@
+#ifndef WL_DETAILS_WEISFEILER_LEMAN_BASE_HPP_
+#define WL_DETAILS_WEISFEILER_LEMAN_BASE_HPP_
+
+#include "wl/details/checkpoint.hpp"
+#include "wl/details/color_function.hpp"
+#include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/thread_pool.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace wl
+{
+
+/// @brief Whether adjacent colors are treated as a multiset (counting) or as a set (ignore counting).
+enum class CountingMode
+{
+    MULTISET,
+    SET
+};
+
+/// @brief Runtime interface of the k-WL engines.
+///
+/// The concrete engines are class templates over the counting mode, so their inner loops carry no mode branches.
+/// Use create_weisfeiler_leman to pick the instantiation once at runtime.
+class WeisfeilerLemanBase
+{
+public:
+    virtual ~WeisfeilerLemanBase() = default;
+
+    /* Getters */
+
+    virtual int get_k() const = 0;
+
+    virtual bool get_ignore_counting() const = 0;
+
+    virtual const std::shared_ptr<ColorFunction>& get_color_function() const = 0;
+
+    virtual size_t get_coloring_function_size() const = 0;
+
+    /// @brief Whether the initial coloring refines the node labels by vertex invariants of the stable coloring, see vertex_invariants.hpp.
+    /// The stable partition stays the same, but it takes fewer rounds and the colors differ from those of unseeded engines.
+    virtual bool get_invariant_seeding() const = 0;
+
+    /// @brief Not synchronized, so it must not run concurrently with colorings.
+    virtual void set_invariant_seeding(bool invariant_seeding) = 0;
+
+    /* Simple interface to run k-WL for at most max_num_iterations or until convergence. */
+
+    virtual std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_coloring(const EdgeColoredGraph& graph,
+                                                                                          size_t max_num_iterations = std::numeric_limits<size_t>::max()) = 0;
+
+    /// @brief Like compute_coloring, but split each iteration into sub-tasks on the pool. Must be called from a task of the pool or from outside it.
+    /// The colors of concurrently colored nodes are assigned in scheduling order, which only changes their names, as with engines that share a color function.
+    /// Engines without a parallel implementation run compute_coloring.
+    virtual std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations = std::numeric_limits<size_t>::max())
+    {
+        return compute_coloring(graph, max_num_iterations);
+    }
+
+    /// @brief Like compute_coloring, but write checkpoints of the coloring and the color function as configured by options.
+    /// Only 2-FWL supports checkpoints, the other engines throw std::logic_error.
+    virtual std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+    compute_coloring_with_checkpoints(const EdgeColoredGraph& graph,
+                                      const CheckpointOptions& options,
+                                      size_t max_num_iterations = std::numeric_limits<size_t>::max())
+    {
+        throw std::logic_error("compute_coloring_with_checkpoints: checkpoints are not supported for k = " + std::to_string(get_k()));
+    }
+
+    /// @brief Continue a run of compute_coloring_with_checkpoints on the same graph from the checkpoint at path, with an identical result.
+    /// Replaces the mapping of the color function by the one in the checkpoint, and keeps writing checkpoints as configured by options.
+    /// max_num_iterations includes the rounds before the checkpoint.
+    virtual std::tuple<bool, size_t, std::vector<int>, std::vector<int>> resume_coloring(const EdgeColoredGraph& graph,
+                                                                                         const std::string& path,
+                                                                                         const CheckpointOptions& options,
+                                                                                         size_t max_num_iterations = std::numeric_limits<size_t>::max())
+    {
+        throw std::logic_error("resume_coloring: checkpoints are not supported for k = " + std::to_string(get_k()));
+    }
+
+    /* Expert interface with more control over the execution */
+
+    virtual GraphColoring compute_initial_coloring(const EdgeColoredGraph& graph) = 0;
+
+    virtual bool compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring) = 0;
+};
+
+}
+
+#endif
@@ -6,6 +6,13 @@
  */
 
 #include "wl/details/edge_colored_graph.hpp"
+#include "wl/details/graph_view.hpp"
+
+/**
+ * Readers of standard graph formats
+ */
+
+#include "wl/details/graph_io.hpp"
 
 /**
  * A fast implementation of 1-WL
@@ -13,12 +20,58 @@
 
 #include "wl/details/canonical_color_refinement.hpp"
 
+/**
+ * Exact canonical labeling by individualization-refinement
+ */
+
+#include "wl/details/canonical_labeling.hpp"
+
 /**
  * A alternative implementation of 1-WL and 2-FWL
  */
 
+#include "wl/details/checkpoint.hpp"
+#include "wl/details/color_function.hpp"
+#include "wl/details/kernels.hpp"
+#include "wl/details/mapped_array.hpp"
+#include "wl/details/pair_color_matrix.hpp"
+#include "wl/details/result_cache.hpp"
+#include "wl/details/vertex_invariants.hpp"
 #include "wl/details/weisfeiler_leman.hpp"
 #include "wl/details/weisfeiler_leman_1d.hpp"
 #include "wl/details/weisfeiler_leman_2d.hpp"
+#include "wl/details/weisfeiler_leman_base.hpp"
+
+/**
+ * 1-WL on relational structures without auxiliary nodes
+ */
+
+#include "wl/details/relational_weisfeiler_leman.hpp"
+
+/**
+ * Asynchronous jobs on a work-stealing thread pool
+ */
+
+#include "wl/details/job_queue.hpp"
+#include "wl/details/thread_pool.hpp"
+
+/**
+ * Deduplication of graphs by WL certificates
+ */
+
+#include "wl/details/certificate_store.hpp"
+
+/**
+ * MinHash sketches of WL colorings for near-duplicate detection
+ */
+
+#include "wl/details/min_hash.hpp"
+
+/**
+ * A graph-partitioned distributed implementation of 1-WL
+ */
+
+#include "wl/details/distributed_weisfeiler_leman_1d.hpp"
+#include "wl/details/transport.hpp"
 
 #endif
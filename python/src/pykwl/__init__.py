@@ -1 +1 @@
-from _pykwl import EdgeColoredGraph, GraphColoring, WeisfeilerLeman, CanonicalColorRefinement
+from _pykwl import read_graphs, parse_graph6, get_kernel_target, EdgeColoredGraph, GraphColoring, WeisfeilerLeman, RelationalStructure, RelationalWeisfeilerLeman, CanonicalColorRefinement, EquivalenceClasses, CacheStatistics, ColorFunction, UnseenContextPolicy, UnseenContextError, UNKNOWN_COLOR, CanonicalForm, CanonicalLabeling, PairColoringLayout, PairColoringStorage, PairColoringOptions, CheckpointOptions, CertificateStore, CertificateStoreOptions, MinHashSketch, MinHashSketcher, MinHashIndex, ThreadPool, JobQueue, ColoringFuture, RefinementFuture, RefinementResult
@@ -1,27 +1,193 @@
-from typing import Tuple, List, MutableSet
+from enum import Enum
+from typing import Tuple, List, MutableSet, Optional
+import numpy as np
 
 class EdgeColoredGraph:
     def __init__(self, directed : bool) -> None: ...
     def add_node(self, label: int = 0) -> int: ...
     def add_edge(self, src_node: int, dst_node: int, label: int = 0) -> None: ...
 
+def read_graphs(path: str, directed: bool = False, num_threads: int = 0) -> List[EdgeColoredGraph]: ...
+def parse_graph6(line: str) -> EdgeColoredGraph: ...
+def get_kernel_target() -> str: ...
+
+UNKNOWN_COLOR: int
+
+class UnseenContextPolicy(Enum):
+    UNKNOWN_COLOR = ...
+    THROW = ...
+
+class UnseenContextError(Exception): ...
+
+class ColorFunction:
+    def __init__(self) -> None: ...
+    def freeze(self, policy: UnseenContextPolicy = UnseenContextPolicy.UNKNOWN_COLOR, unknown_color: int = ...) -> None: ...
+    def is_frozen(self) -> bool: ...
+    def get_unseen_context_policy(self) -> UnseenContextPolicy: ...
+    def get_unknown_color(self) -> int: ...
+    def __len__(self) -> int: ...
+
+class EquivalenceClasses:
+    class_ids: List[int]
+    quotient_matrices: List[List[List[int]]]
+
+class CacheStatistics:
+    num_hits: int
+    num_misses: int
+    num_evictions: int
+    size: int
+    capacity: int
+
 class CanonicalColorRefinement:
     def __init__(self, debug : int = 0, use_stack : bool = False) -> None: ...
     def calculate(self, graph: EdgeColoredGraph, factor_matrix = False) -> None: ...
+    def calculate_parallel(self, graph: EdgeColoredGraph, pool: ThreadPool, factor_matrix = False) -> None: ...
+    def calculate_equivalence_classes(self, graphs: List[EdgeColoredGraph]) -> EquivalenceClasses: ...
     def get_coloring(self) -> List[int]: ...
+    def get_node_colors(self) -> np.ndarray: ...
+    def get_partition(self) -> Tuple[np.ndarray, np.ndarray]: ...
     def get_quotient_matrix(self) -> List[List[int]]: ...
     def get_quotient_matrix_string(self) -> str: ...
+    def set_invariant_seeding(self, invariant_seeding: bool) -> None: ...
+    def set_cache_capacity(self, capacity: int) -> None: ...
+    def get_cache_statistics(self) -> CacheStatistics: ...
     @staticmethod
     def coloring_to_histogram(self, coloring: List[MutableSet[int]]) -> List[int]: ...
 
+class CanonicalForm:
+    labeling: List[int]
+    node_labels: List[int]
+    edges: List[Tuple[int, int]]
+    hash: int
+
+class CanonicalLabeling:
+    def __init__(self) -> None: ...
+    def calculate(self, graph: EdgeColoredGraph) -> CanonicalForm: ...
+    def get_canonical_form(self) -> CanonicalForm: ...
+    def get_hash(self) -> int: ...
+    def get_automorphism_generators(self) -> List[List[int]]: ...
+    def get_num_search_nodes(self) -> int: ...
+    def get_num_leaves(self) -> int: ...
+
 class GraphColoring:
+    # Read-only view of the colors that compute_next_coloring refills in place. Copy it to keep a round.
+    colorings: np.ndarray
     def get_frequencies(self) -> Tuple[List[int], List[int]]: ...
 
+class PairColoringLayout(Enum):
+    FULL = ...
+    UPPER_TRIANGLE = ...
+
+class PairColoringStorage(Enum):
+    MEMORY = ...
+    MAPPED_FILE = ...
+
+class PairColoringOptions:
+    layout: PairColoringLayout
+    storage: PairColoringStorage
+    directory: str
+    def __init__(self, layout: PairColoringLayout = PairColoringLayout.FULL, storage: PairColoringStorage = PairColoringStorage.MEMORY, directory: str = "") -> None: ...
+
+class CheckpointOptions:
+    path: str
+    every_num_rounds: int
+    every_num_seconds: float
+    def __init__(self, path: str = ..., every_num_rounds: int = 0, every_num_seconds: float = 0.0) -> None: ...
+
 class WeisfeilerLeman:
-    def __init__(self, k: int, ignore_counting: bool = False) -> None: ...
+    def __init__(self, k: int, ignore_counting: bool = False, color_function: Optional[ColorFunction] = None, pair_coloring_options: PairColoringOptions = ...) -> None: ...
     def get_k(self) -> int: ...
     def get_ignore_counting(self) -> bool: ...
+    def get_color_function(self) -> ColorFunction: ...
     def compute_coloring(self, graph: EdgeColoredGraph) -> Tuple[bool, int, List[int], List[int]]: ...
+    def compute_coloring_with_checkpoints(self, graph: EdgeColoredGraph, options: CheckpointOptions, max_num_iterations: int = ...) -> Tuple[bool, int, List[int], List[int]]: ...
+    def resume_coloring(self, graph: EdgeColoredGraph, path: str, options: CheckpointOptions = ..., max_num_iterations: int = ...) -> Tuple[bool, int, List[int], List[int]]: ...
+    def compute_node_color_history(self, graph: EdgeColoredGraph, max_num_iterations: int = ..., path: Optional[str] = None) -> Tuple[bool, int, np.ndarray]: ...
+    def compute_coloring_arrays(self, graph: EdgeColoredGraph, max_num_iterations: int = ...) -> Tuple[bool, int, np.ndarray, np.ndarray]: ...
     def compute_initial_coloring(self, graph: EdgeColoredGraph) -> GraphColoring: ...
     def compute_next_coloring(self, graph: EdgeColoredGraph, current_coloring: GraphColoring, next_coloring: GraphColoring) -> bool: ...
     def get_coloring_function_size(self) -> int: ...
+    def get_invariant_seeding(self) -> bool: ...
+    def set_invariant_seeding(self, invariant_seeding: bool) -> None: ...
+    def set_cache_capacity(self, capacity: int) -> None: ...
+    def get_cache_statistics(self) -> CacheStatistics: ...
+
+class RelationalStructure:
+    def __init__(self) -> None: ...
+    def add_object(self, label: int = 0) -> int: ...
+    def add_atom(self, predicate: int, arguments: List[int]) -> int: ...
+    def get_num_objects(self) -> int: ...
+    def get_num_atoms(self) -> int: ...
+    def get_arguments(self, atom: int) -> List[int]: ...
+    def to_graph(self) -> EdgeColoredGraph: ...
+
+class RelationalWeisfeilerLeman:
+    def __init__(self, ignore_counting: bool = False, color_function: Optional[ColorFunction] = None) -> None: ...
+    def get_ignore_counting(self) -> bool: ...
+    def get_color_function(self) -> ColorFunction: ...
+    def get_coloring_function_size(self) -> int: ...
+    def compute_coloring(self, structure: RelationalStructure, max_num_iterations: int = ...) -> Tuple[bool, int, List[int], List[int]]: ...
+    def compute_initial_coloring(self, structure: RelationalStructure) -> GraphColoring: ...
+    def compute_atom_coloring(self, structure: RelationalStructure, object_coloring: GraphColoring) -> GraphColoring: ...
+    def compute_next_coloring(self, structure: RelationalStructure, current_coloring: GraphColoring, next_coloring: GraphColoring) -> bool: ...
+
+class CertificateStoreOptions:
+    num_bloom_filter_bits: int
+    num_bloom_filter_hashes: int
+    verify: bool
+    def __init__(self) -> None: ...
+
+class CertificateStore:
+    def __init__(self, options: CertificateStoreOptions = ...) -> None: ...
+    @staticmethod
+    def make_certificate(unique: List[int], counts: List[int]) -> List[int]: ...
+    @staticmethod
+    def make_quotient_certificate(quotient_matrix: List[List[int]]) -> List[int]: ...
+    def insert(self, certificate: List[int]) -> Tuple[int, bool]: ...
+    def contains(self, certificate: List[int]) -> bool: ...
+    def insert_coloring(self, wl: WeisfeilerLeman, graph: EdgeColoredGraph, max_num_iterations: int = ...) -> Tuple[int, bool]: ...
+    def __len__(self) -> int: ...
+
+class MinHashSketch:
+    values: List[int]
+    def __init__(self) -> None: ...
+    def estimate_similarity(self, other: MinHashSketch) -> float: ...
+
+class MinHashSketcher:
+    def __init__(self, num_hashes: int = 128, seed: int = 0) -> None: ...
+    def get_num_hashes(self) -> int: ...
+    def get_seed(self) -> int: ...
+    def compute_sketch(self, wl: WeisfeilerLeman, graph: EdgeColoredGraph, max_num_iterations: int = ...) -> Tuple[bool, int, MinHashSketch]: ...
+    def compute_sketch_of_rounds(self, rounds: List[GraphColoring]) -> MinHashSketch: ...
+
+class MinHashIndex:
+    def __init__(self, num_bands: int, rows_per_band: int) -> None: ...
+    def insert(self, sketch: MinHashSketch) -> int: ...
+    def query(self, sketch: MinHashSketch) -> List[int]: ...
+    def get_num_bands(self) -> int: ...
+    def get_rows_per_band(self) -> int: ...
+    def __len__(self) -> int: ...
+
+class ThreadPool:
+    def __init__(self, num_threads: int = 0) -> None: ...
+    @staticmethod
+    def get_default() -> ThreadPool: ...
+    def get_num_threads(self) -> int: ...
+
+class RefinementResult:
+    coloring: List[MutableSet[int]]
+    quotient_matrix: List[List[int]]
+
+class ColoringFuture:
+    def result(self) -> Tuple[bool, int, List[int], List[int]]: ...
+    def done(self) -> bool: ...
+
+class RefinementFuture:
+    def result(self) -> RefinementResult: ...
+    def done(self) -> bool: ...
+
+class JobQueue:
+    def __init__(self, pool: ThreadPool = ..., min_num_nodes_to_split: int = 4096) -> None: ...
+    def get_pool(self) -> ThreadPool: ...
+    def submit_coloring(self, wl: WeisfeilerLeman, graph: EdgeColoredGraph, max_num_iterations: int = ...) -> ColoringFuture: ...
+    def submit_refinement(self, graph: EdgeColoredGraph) -> RefinementFuture: ...
@@ -1,6 +1,12 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>  // Necessary for automatic conversion of e.g. std::vectors
 
+#include <array>
+#include <fstream>
+#include <optional>
+#include <string>
+
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 
@@ -9,6 +15,72 @@
 using namespace wl;
 namespace py = pybind11;
 
+namespace pybind11::detail
+{
+/// @brief Quotient matrix entries are [row, column, count] lists in Python.
+template<>
+struct type_caster<QuotientEntry>
+{
+    PYBIND11_TYPE_CASTER(QuotientEntry, const_name("List[int]"));
+
+    bool load(handle source, bool convert)
+    {
+        auto caster = make_caster<std::array<int, 3>>();
+        if (!caster.load(source, convert))
+            return false;
+        const auto& entry = cast_op<const std::array<int, 3>&>(caster);
+        value = QuotientEntry { entry[0], entry[1], entry[2] };
+        return true;
+    }
+
+    static handle cast(const QuotientEntry& entry, return_value_policy /* policy */, handle /* parent */)
+    {
+        auto list = py::list();
+        list.append(entry.row);
+        list.append(entry.column);
+        list.append(entry.count);
+        return list.release();
+    }
+};
+}
+
+/// @brief Read-only NumPy view of values inside an immutable object, which the view keeps alive through a capsule.
+/// Buffers that C++ may reallocate must be copied with as_array instead.
+template<typename T>
+static py::array_t<int> as_view(const std::vector<int>& values, std::shared_ptr<const T> owner)
+{
+    auto* holder = new std::shared_ptr<const T>(std::move(owner));
+    auto capsule = py::capsule(holder, [](void* pointer) { delete static_cast<std::shared_ptr<const T>*>(pointer); });
+    auto array = py::array_t<int>(values.size(), values.data(), capsule);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+/// @brief NumPy array that takes ownership of the vector without copying it.
+static py::array_t<int> as_array(std::vector<int>&& values)
+{
+    auto* owned = new std::vector<int>(std::move(values));
+    auto capsule = py::capsule(owned, [](void* pointer) { delete static_cast<std::vector<int>*>(pointer); });
+    return py::array_t<int>(owned->size(), owned->data(), capsule);
+}
+
+/// @brief Bind a shared future whose result() waits without holding the GIL.
+template<typename T>
+static void bind_future(py::module_& m, const char* name)
+{
+    py::class_<std::shared_future<T>>(m, name)  //
+        .def("result",
+             [](const std::shared_future<T>& future)
+             {
+                 {
+                     py::gil_scoped_release release;
+                     future.wait();
+                 }
+                 return future.get();
+             })
+        .def("done", [](const std::shared_future<T>& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+}
+
 /**
  * Bindings
  */
@@ -20,25 +92,328 @@ void init_kwl(py::module_& m)
         .def("add_node", &EdgeColoredGraph::add_node, py::arg("label") = 0)
         .def("add_edge", &EdgeColoredGraph::add_edge, py::arg("src_node"), py::arg("dst_node"), py::arg("label") = 0);
 
+    m.def("read_graphs", &read_graphs, py::arg("path"), py::arg("directed") = false, py::arg("num_threads") = 0, py::call_guard<py::gil_scoped_release>());
+    m.def("parse_graph6", &parse_graph6, py::arg("line"));
+    m.def("get_kernel_target", &get_kernel_target);
+
     py::class_<GraphColoring>(m, "GraphColoring")  //
+        // A read-only view without a copy, whose base keeps the GraphColoring alive. compute_next_coloring refills the buffer in place,
+        // so a view of the next coloring shows the new colors after the call.
+        .def_property_readonly("colorings",
+                               [](py::object self)
+                               {
+                                   const auto& coloring = self.cast<const GraphColoring&>();
+                                   auto array = py::array_t<int>(coloring.colorings.size(), coloring.colorings.data(), self);
+                                   array.attr("setflags")(py::arg("write") = false);
+                                   return array;
+                               })
         .def("get_frequencies", &GraphColoring::get_frequencies)
         .def("is_identical_to", &GraphColoring::is_identical_to);
 
+    py::enum_<UnseenContextPolicy>(m, "UnseenContextPolicy")  //
+        .value("UNKNOWN_COLOR", UnseenContextPolicy::UNKNOWN_COLOR)
+        .value("THROW", UnseenContextPolicy::THROW);
+
+    py::register_exception<UnseenContextError>(m, "UnseenContextError");
+
+    m.attr("UNKNOWN_COLOR") = UNKNOWN_COLOR;
+
+    py::class_<ColorFunction, std::shared_ptr<ColorFunction>>(m, "ColorFunction")  //
+        .def(py::init<>())
+        .def("freeze", &ColorFunction::freeze, py::arg("policy") = UnseenContextPolicy::UNKNOWN_COLOR, py::arg("unknown_color") = UNKNOWN_COLOR)
+        .def("is_frozen", &ColorFunction::is_frozen)
+        .def("get_unseen_context_policy", &ColorFunction::get_unseen_context_policy)
+        .def("get_unknown_color", &ColorFunction::get_unknown_color)
+        .def("__len__", &ColorFunction::size);
+
+    // The long running calls below release the GIL. They do not touch Python objects while running.
+    py::class_<EquivalenceClasses>(m, "EquivalenceClasses")  //
+        .def_readonly("class_ids", &EquivalenceClasses::class_ids)
+        .def_readonly("quotient_matrices", &EquivalenceClasses::quotient_matrices);
+
+    py::class_<CacheStatistics>(m, "CacheStatistics")  //
+        .def_readonly("num_hits", &CacheStatistics::num_hits)
+        .def_readonly("num_misses", &CacheStatistics::num_misses)
+        .def_readonly("num_evictions", &CacheStatistics::num_evictions)
+        .def_readonly("size", &CacheStatistics::size)
+        .def_readonly("capacity", &CacheStatistics::capacity);
+
     py::class_<CanonicalColorRefinement>(m, "CanonicalColorRefinement")  //
         .def(py::init<int, bool>(), py::arg("debug") = 0, py::arg("use_stack") = false)
-        .def("calculate", &CanonicalColorRefinement::calculate, py::arg("graph"), py::arg("factor_matrix") = false)
+        .def("calculate",
+             py::overload_cast<const EdgeColoredGraph&, bool>(&CanonicalColorRefinement::calculate),
+             py::arg("graph"),
+             py::arg("factor_matrix") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def("calculate_parallel",
+             py::overload_cast<const EdgeColoredGraph&, ThreadPool&, bool>(&CanonicalColorRefinement::calculate_parallel),
+             py::arg("graph"),
+             py::arg("pool"),
+             py::arg("factor_matrix") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def("calculate_equivalence_classes",
+             &CanonicalColorRefinement::calculate_equivalence_classes,
+             py::arg("graphs"),
+             py::call_guard<py::gil_scoped_release>())
         .def("get_coloring", &CanonicalColorRefinement::get_coloring)
+        // Every call of calculate creates a new FlatPartition, so the views below keep the results of the call before them.
+        .def("get_node_colors",
+             [](const CanonicalColorRefinement& color_refinement)
+             {
+                 const auto partition = color_refinement.get_partition();
+                 return as_view(partition->node_colors, partition);
+             })
+        .def("get_partition",
+             [](const CanonicalColorRefinement& color_refinement)
+             {
+                 const auto partition = color_refinement.get_partition();
+                 return py::make_tuple(as_view(partition->partition_nodes, partition), as_view(partition->partition_offsets, partition));
+             })
         .def("get_quotient_matrix", &CanonicalColorRefinement::get_quotient_matrix)
         .def("get_quotient_matrix_string", &CanonicalColorRefinement::get_quotient_matrix_string)
+        .def("set_invariant_seeding", &CanonicalColorRefinement::set_invariant_seeding, py::arg("invariant_seeding"))
+        .def("set_cache_capacity", &CanonicalColorRefinement::set_cache_capacity, py::arg("capacity"))
+        .def("get_cache_statistics", &CanonicalColorRefinement::get_cache_statistics)
         .def_static("coloring_to_histogram", &CanonicalColorRefinement::coloring_to_histogram);
 
+    py::class_<CanonicalForm>(m, "CanonicalForm")  //
+        .def_readonly("labeling", &CanonicalForm::labeling)
+        .def_readonly("node_labels", &CanonicalForm::node_labels)
+        .def_readonly("edges", &CanonicalForm::edges)
+        .def_readonly("hash", &CanonicalForm::hash)
+        .def("__eq__", &CanonicalForm::operator==)
+        .def("__hash__", [](const CanonicalForm& form) { return form.hash; });
+
+    py::class_<CanonicalLabeling>(m, "CanonicalLabeling")  //
+        .def(py::init<>())
+        .def("calculate", &CanonicalLabeling::calculate, py::arg("graph"), py::return_value_policy::copy, py::call_guard<py::gil_scoped_release>())
+        .def("get_canonical_form", &CanonicalLabeling::get_canonical_form, py::return_value_policy::copy)
+        .def("get_hash", &CanonicalLabeling::get_hash)
+        .def("get_automorphism_generators", &CanonicalLabeling::get_automorphism_generators)
+        .def("get_num_search_nodes", &CanonicalLabeling::get_num_search_nodes)
+        .def("get_num_leaves", &CanonicalLabeling::get_num_leaves);
+
+    py::enum_<PairColoringLayout>(m, "PairColoringLayout")  //
+        .value("FULL", PairColoringLayout::FULL)
+        .value("UPPER_TRIANGLE", PairColoringLayout::UPPER_TRIANGLE);
+
+    py::enum_<PairColoringStorage>(m, "PairColoringStorage")  //
+        .value("MEMORY", PairColoringStorage::MEMORY)
+        .value("MAPPED_FILE", PairColoringStorage::MAPPED_FILE);
+
+    py::class_<PairColoringOptions>(m, "PairColoringOptions")  //
+        .def(py::init<>())
+        .def(py::init([](PairColoringLayout layout, PairColoringStorage storage, std::string directory)
+                      { return PairColoringOptions { layout, storage, std::move(directory) }; }),
+             py::arg("layout"),
+             py::arg("storage") = PairColoringStorage::MEMORY,
+             py::arg("directory") = "")
+        .def_readwrite("layout", &PairColoringOptions::layout)
+        .def_readwrite("storage", &PairColoringOptions::storage)
+        .def_readwrite("directory", &PairColoringOptions::directory);
+
+    py::class_<CheckpointOptions>(m, "CheckpointOptions")  //
+        .def(py::init<>())
+        .def(py::init([](std::string path, size_t every_num_rounds, double every_num_seconds)
+                      { return CheckpointOptions { std::move(path), every_num_rounds, every_num_seconds }; }),
+             py::arg("path"),
+             py::arg("every_num_rounds") = 0,
+             py::arg("every_num_seconds") = 0.0)
+        .def_readwrite("path", &CheckpointOptions::path)
+        .def_readwrite("every_num_rounds", &CheckpointOptions::every_num_rounds)
+        .def_readwrite("every_num_seconds", &CheckpointOptions::every_num_seconds);
+
     py::class_<WeisfeilerLeman>(m, "WeisfeilerLeman")  //
         .def(py::init<int>())
         .def(py::init<int, bool>())
+        .def(py::init<int, bool, std::shared_ptr<ColorFunction>, const PairColoringOptions&>(),
+             py::arg("k"),
+             py::arg("ignore_counting") = false,
+             py::arg("color_function") = nullptr,
+             py::arg("pair_coloring_options") = PairColoringOptions())
         .def("get_k", &WeisfeilerLeman::get_k)
         .def("get_ignore_counting", &WeisfeilerLeman::get_ignore_counting)
-        .def("compute_coloring", &WeisfeilerLeman::compute_coloring, py::arg("graph"), py::arg("max_num_iterations") = std::numeric_limits<size_t>::max())
-        .def("compute_initial_coloring", &WeisfeilerLeman::compute_initial_coloring)
-        .def("compute_next_coloring", &WeisfeilerLeman::compute_next_coloring)
-        .def("get_coloring_function_size", &WeisfeilerLeman::get_coloring_function_size);
+        .def("get_color_function", &WeisfeilerLeman::get_color_function)
+        .def("compute_coloring",
+             &WeisfeilerLeman::compute_coloring,
+             py::arg("graph"),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("compute_coloring_with_checkpoints",
+             &WeisfeilerLeman::compute_coloring_with_checkpoints,
+             py::arg("graph"),
+             py::arg("options"),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("resume_coloring",
+             &WeisfeilerLeman::resume_coloring,
+             py::arg("graph"),
+             py::arg("path"),
+             py::arg("options") = CheckpointOptions(),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def(
+            "compute_coloring_arrays",
+            [](WeisfeilerLeman& wl, const EdgeColoredGraph& graph, size_t max_num_iterations)
+            {
+                auto result = std::tuple<bool, size_t, std::vector<int>, std::vector<int>>();
+                {
+                    py::gil_scoped_release release;
+                    result = wl.compute_coloring(graph, max_num_iterations);
+                }
+                auto& [is_stable, num_iterations, unique, counts] = result;
+                return py::make_tuple(is_stable, num_iterations, as_array(std::move(unique)), as_array(std::move(counts)));
+            },
+            py::arg("graph"),
+            py::arg("max_num_iterations") = std::numeric_limits<size_t>::max())
+        .def(
+            "compute_node_color_history",
+            [](WeisfeilerLeman& wl, const EdgeColoredGraph& graph, size_t max_num_iterations, std::optional<std::string> path)
+            {
+                auto result = std::tuple<bool, size_t, NodeColorHistory>();
+                {
+                    py::gil_scoped_release release;
+                    auto stream = std::ofstream();
+                    if (path)
+                    {
+                        stream.open(*path, std::ios::binary);
+                        if (!stream)
+                            throw std::runtime_error("cannot open " + *path);
+                    }
+                    result = wl.compute_node_color_history(graph, max_num_iterations, path ? &stream : nullptr);
+                }
+                auto& [is_stable, num_iterations, history] = result;
+
+                // The round-major buffer viewed as a num_nodes x num_rounds matrix
+                auto* colors = new std::vector<int32_t>(std::move(history.colors));
+                auto capsule = py::capsule(colors, [](void* pointer) { delete static_cast<std::vector<int32_t>*>(pointer); });
+                auto features = py::array_t<int32_t>({ static_cast<py::ssize_t>(history.num_nodes), static_cast<py::ssize_t>(history.num_rounds) },
+                                                     { static_cast<py::ssize_t>(sizeof(int32_t)), static_cast<py::ssize_t>(sizeof(int32_t) * history.num_nodes) },
+                                                     colors->data(),
+                                                     capsule);
+                return py::make_tuple(is_stable, num_iterations, features);
+            },
+            py::arg("graph"),
+            py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+            py::arg("path") = std::nullopt)
+        .def("compute_initial_coloring", &WeisfeilerLeman::compute_initial_coloring, py::call_guard<py::gil_scoped_release>())
+        .def("compute_next_coloring", &WeisfeilerLeman::compute_next_coloring, py::call_guard<py::gil_scoped_release>())
+        .def("get_coloring_function_size", &WeisfeilerLeman::get_coloring_function_size)
+        .def("get_invariant_seeding", &WeisfeilerLeman::get_invariant_seeding)
+        .def("set_invariant_seeding", &WeisfeilerLeman::set_invariant_seeding, py::arg("invariant_seeding"))
+        .def("set_cache_capacity", &WeisfeilerLeman::set_cache_capacity, py::arg("capacity"))
+        .def("get_cache_statistics", &WeisfeilerLeman::get_cache_statistics);
+
+    py::class_<RelationalStructure>(m, "RelationalStructure")  //
+        .def(py::init<>())
+        .def("add_object", &RelationalStructure::add_object, py::arg("label") = 0)
+        .def("add_atom", &RelationalStructure::add_atom, py::arg("predicate"), py::arg("arguments"))
+        .def("get_num_objects", &RelationalStructure::get_num_objects)
+        .def("get_num_atoms", &RelationalStructure::get_num_atoms)
+        .def("get_arguments",
+             [](const RelationalStructure& structure, int atom)
+             {
+                 const auto arguments = structure.get_arguments(atom);
+                 return std::vector<int>(arguments.begin(), arguments.end());
+             })
+        .def("to_graph", &RelationalStructure::to_graph);
+
+    py::class_<RelationalWeisfeilerLeman>(m, "RelationalWeisfeilerLeman")  //
+        .def(py::init<bool, std::shared_ptr<ColorFunction>>(), py::arg("ignore_counting") = false, py::arg("color_function") = nullptr)
+        .def("get_ignore_counting", &RelationalWeisfeilerLeman::get_ignore_counting)
+        .def("get_color_function", &RelationalWeisfeilerLeman::get_color_function)
+        .def("get_coloring_function_size", &RelationalWeisfeilerLeman::get_coloring_function_size)
+        .def("compute_coloring",
+             &RelationalWeisfeilerLeman::compute_coloring,
+             py::arg("structure"),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("compute_initial_coloring", &RelationalWeisfeilerLeman::compute_initial_coloring, py::call_guard<py::gil_scoped_release>())
+        .def("compute_atom_coloring", &RelationalWeisfeilerLeman::compute_atom_coloring, py::call_guard<py::gil_scoped_release>())
+        .def("compute_next_coloring", &RelationalWeisfeilerLeman::compute_next_coloring, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<CertificateStoreOptions>(m, "CertificateStoreOptions")  //
+        .def(py::init<>())
+        .def_readwrite("num_bloom_filter_bits", &CertificateStoreOptions::num_bloom_filter_bits)
+        .def_readwrite("num_bloom_filter_hashes", &CertificateStoreOptions::num_bloom_filter_hashes)
+        .def_readwrite("verify", &CertificateStoreOptions::verify);
+
+    py::class_<CertificateStore>(m, "CertificateStore")  //
+        .def(py::init<const CertificateStoreOptions&>(), py::arg("options") = CertificateStoreOptions())
+        .def_static("make_certificate",
+                    py::overload_cast<const std::vector<int>&, const std::vector<int>&>(&CertificateStore::make_certificate),
+                    py::arg("unique"),
+                    py::arg("counts"))
+        .def_static("make_quotient_certificate",
+                    py::overload_cast<const std::vector<QuotientEntry>&>(&CertificateStore::make_certificate),
+                    py::arg("quotient_matrix"))
+        .def("insert", &CertificateStore::insert, py::arg("certificate"), py::call_guard<py::gil_scoped_release>())
+        .def("contains", &CertificateStore::contains, py::arg("certificate"), py::call_guard<py::gil_scoped_release>())
+        .def("insert_coloring",
+             &CertificateStore::insert_coloring,
+             py::arg("wl"),
+             py::arg("graph"),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("__len__", &CertificateStore::size);
+
+    py::class_<MinHashSketch>(m, "MinHashSketch")  //
+        .def(py::init<>())
+        .def_readwrite("values", &MinHashSketch::values)
+        .def("estimate_similarity", &MinHashSketch::estimate_similarity, py::arg("other"))
+        .def("__eq__", &MinHashSketch::operator==);
+
+    py::class_<MinHashSketcher>(m, "MinHashSketcher")  //
+        .def(py::init<size_t, uint64_t>(), py::arg("num_hashes") = 128, py::arg("seed") = 0)
+        .def("get_num_hashes", &MinHashSketcher::get_num_hashes)
+        .def("get_seed", &MinHashSketcher::get_seed)
+        .def("compute_sketch",
+             py::overload_cast<WeisfeilerLeman&, const EdgeColoredGraph&, size_t>(&MinHashSketcher::compute_sketch, py::const_),
+             py::arg("wl"),
+             py::arg("graph"),
+             py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+             py::call_guard<py::gil_scoped_release>())
+        .def("compute_sketch_of_rounds",
+             py::overload_cast<const std::vector<GraphColoring>&>(&MinHashSketcher::compute_sketch, py::const_),
+             py::arg("rounds"),
+             py::call_guard<py::gil_scoped_release>());
+
+    py::class_<MinHashIndex>(m, "MinHashIndex")  //
+        .def(py::init<size_t, size_t>(), py::arg("num_bands"), py::arg("rows_per_band"))
+        .def("insert", &MinHashIndex::insert, py::arg("sketch"))
+        .def("query", &MinHashIndex::query, py::arg("sketch"))
+        .def("get_num_bands", &MinHashIndex::get_num_bands)
+        .def("get_rows_per_band", &MinHashIndex::get_rows_per_band)
+        .def("__len__", &MinHashIndex::size);
+
+    py::class_<ThreadPool, std::shared_ptr<ThreadPool>>(m, "ThreadPool")  //
+        .def(py::init<size_t>(), py::arg("num_threads") = 0)
+        .def_static("get_default", &ThreadPool::get_default)
+        .def("get_num_threads", &ThreadPool::get_num_threads);
+
+    py::class_<RefinementResult>(m, "RefinementResult")  //
+        .def_readonly("coloring", &RefinementResult::coloring)
+        .def_readonly("quotient_matrix", &RefinementResult::quotient_matrix);
+
+    bind_future<ColoringResult>(m, "ColoringFuture");
+    bind_future<RefinementResult>(m, "RefinementFuture");
+
+    // The futures keep the engine and the graph alive until they are destroyed
+    py::class_<JobQueue>(m, "JobQueue")  //
+        .def(py::init<std::shared_ptr<ThreadPool>, int>(), py::arg("pool") = ThreadPool::get_default(), py::arg("min_num_nodes_to_split") = 4096)
+        .def("get_pool", &JobQueue::get_pool)
+        .def(
+            "submit_coloring",
+            [](JobQueue& queue, WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations)
+            { return queue.submit_coloring(engine, graph, max_num_iterations).share(); },
+            py::arg("wl"),
+            py::arg("graph"),
+            py::arg("max_num_iterations") = std::numeric_limits<size_t>::max(),
+            py::keep_alive<0, 2>(),
+            py::keep_alive<0, 3>())
+        .def(
+            "submit_refinement",
+            [](JobQueue& queue, const EdgeColoredGraph& graph) { return queue.submit_refinement(graph).share(); },
+            py::arg("graph"),
+            py::keep_alive<0, 2>());
 }
@@ -0,0 +1,51 @@
+import numpy as np
+
+from pykwl import CanonicalColorRefinement, EdgeColoredGraph, WeisfeilerLeman
+
+
+def create_path(num_nodes):
+    graph = EdgeColoredGraph(False)
+    for _ in range(num_nodes):
+        graph.add_node()
+    for node in range(num_nodes - 1):
+        graph.add_edge(node, node + 1)
+    return graph
+
+
+def test_partition_views_outlive_later_calculate():
+    color_refinement = CanonicalColorRefinement()
+
+    color_refinement.calculate(create_path(5))
+    node_colors = color_refinement.get_node_colors()
+    nodes, offsets = color_refinement.get_partition()
+    expected = (node_colors.copy(), nodes.copy(), offsets.copy())
+
+    # A larger graph makes the new results larger than the old buffers.
+    color_refinement.calculate(create_path(1000))
+
+    assert not node_colors.flags.writeable
+    np.testing.assert_array_equal(node_colors, expected[0])
+    np.testing.assert_array_equal(nodes, expected[1])
+    np.testing.assert_array_equal(offsets, expected[2])
+    assert len(color_refinement.get_node_colors()) == 1000
+
+
+def test_colorings_are_views_refilled_by_compute_next_coloring():
+    wl = WeisfeilerLeman(1)
+    graph = create_path(7)
+
+    current_coloring = wl.compute_initial_coloring(graph)
+    next_coloring = wl.compute_initial_coloring(graph)
+    colorings = next_coloring.colorings
+    initial = colorings.copy()
+
+    wl.compute_next_coloring(graph, current_coloring, next_coloring)
+
+    assert not colorings.flags.writeable
+    assert not colorings.flags.owndata
+    np.testing.assert_array_equal(colorings, next_coloring.colorings)
+    assert not np.array_equal(colorings, initial)
+
+    # The view keeps the coloring alive.
+    del next_coloring
+    assert len(colorings) == 7
@@ -76,7 +76,7 @@ setup(
     url="https://github.com/drexlerd/Weisfeiler-Leman",
     description="Weisfeiler-Leman library",
     long_description="",
-    install_requires=["cmake>=3.21"],
+    install_requires=["cmake>=3.21", "numpy"],
     packages=find_packages(where="python/src"),
     package_dir={"": "python/src"},
     package_data={
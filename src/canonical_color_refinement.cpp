@@ -1,11 +1,17 @@
 #include "wl/details/canonical_color_refinement.hpp"
 
 #include "wl/details/utils.hpp"
+#include "wl/details/vertex_invariants.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <future>
+#include <map>
+#include <memory>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -18,10 +24,35 @@ std::ostream& operator<<(std::ostream& os, const std::deque<T>& deque)
     return os << std::vector<T>(deque.begin(), deque.end());
 }
 
-void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool calculate_qm)
+// Refining colors with at least that many vertices compute their color degrees in parallel
+static constexpr int MIN_PARALLEL_CELL_SIZE = 4096;
+
+// Steps whose split colors have at least that many adjacent vertices in total split them in parallel
+static constexpr size_t MIN_PARALLEL_SPLIT_SIZE = 4096;
+
+void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool calculate_qm) { calculate(graph, graph.get_node_labels(), calculate_qm); }
+
+void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, const std::vector<int>& alpha, bool calculate_qm)
+{
+    calculate_impl(graph, alpha, nullptr, calculate_qm);
+}
+
+void CanonicalColorRefinement::calculate_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, bool calculate_qm)
 {
-    const auto& alpha = graph.get_node_labels();
+    calculate_parallel(graph, graph.get_node_labels(), pool, calculate_qm);
+}
+
+void CanonicalColorRefinement::calculate_parallel(const EdgeColoredGraph& graph, const std::vector<int>& alpha, ThreadPool& pool, bool calculate_qm)
+{
+    calculate_impl(graph, alpha, &pool, calculate_qm);
+}
 
+void CanonicalColorRefinement::calculate_impl(const EdgeColoredGraph& graph, const std::vector<int>& alpha, ThreadPool* pool, bool calculate_qm)
+{
+    if (static_cast<int>(alpha.size()) != graph.get_num_nodes())
+    {
+        throw std::runtime_error("initial coloring must have one color per vertex");
+    }
     if (CanonicalColorRefinement::check_coloring(alpha, true) != 0)
     {
         throw std::runtime_error("invalid initial coloring");
@@ -31,14 +62,273 @@ void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool cal
         throw std::runtime_error("Only vertex colored graphs are supported");
     }
 
-    // Create data structures
-    int n = graph.get_num_nodes();
-    colour_ = std::vector<int>(n + 1, 0);
-    C_ = std::vector<std::set<int>>(n + 1);
-    A_ = std::vector<std::vector<int>>(n + 1);
-    mincdeg_ = std::vector<int>(n + 1, -1);
-    maxcdeg_ = std::vector<int>(n + 1, 0);
-    cdeg_ = std::vector<int>(n + 1, 0);
+    const auto seeded_alpha = invariant_seeding_ ? compute_degree_seeded_coloring(graph, alpha) : std::vector<int>();
+    const auto& initial_coloring = invariant_seeding_ ? seeded_alpha : alpha;
+
+    if (!cache_)
+    {
+        refine(graph.get_num_nodes(), initial_coloring, [&](int v) -> const std::vector<int>& { return graph.get_inbound_adjacent(v); }, pool);
+
+        if (calculate_qm)
+            calculate_quotient_matrix(graph);
+        return;
+    }
+
+    auto key = graph.get_content_hash();
+    for (const auto color : initial_coloring)
+        hash_combine(key, static_cast<uint32_t>(color));
+
+    if (const auto partition = cache_->find(key))
+    {
+        if (debug_ > 0)
+            std::cout << "  ** Restore cached partition" << std::endl;
+        restore_partition(graph.get_num_nodes(), *partition);
+
+        // A hit without the quotient matrix computes it once and stores it for later hits
+        if (calculate_qm && !valid_QM_)
+        {
+            calculate_quotient_matrix(graph);
+            cache_->insert(key, CachedPartition { partition_, true, QM_ });
+        }
+        return;
+    }
+
+    refine(graph.get_num_nodes(), initial_coloring, [&](int v) -> const std::vector<int>& { return graph.get_inbound_adjacent(v); }, pool);
+
+    if (calculate_qm)
+        calculate_quotient_matrix(graph);
+
+    cache_->insert(key, CachedPartition { partition_, valid_QM_, valid_QM_ ? QM_ : std::vector<QuotientEntry>() });
+}
+
+void CanonicalColorRefinement::restore_partition(int n, const CachedPartition& partition)
+{
+    // Cached partitions are immutable, so the entry and this object share one.
+    partition_ = partition.partition;
+    const auto& [node_colors, partition_nodes, partition_offsets] = *partition_;
+    k_ = static_cast<int>(partition_offsets.size()) - 1;
+
+    colour_.assign(n + 1, 0);
+    colour_.at(0) = -1;
+    for (int v = 0; v < n; ++v)
+        colour_.at(v + 1) = node_colors.at(v);
+
+    C_.resize(k_);
+    for (int i = 0; i < k_; ++i)
+    {
+        C_[i].clear();
+        for (int j = partition_offsets[i]; j < partition_offsets[i + 1]; ++j)
+            C_[i].insert(C_[i].end(), partition_nodes[j] + 1);
+    }
+
+    valid_QM_ = partition.has_quotient_matrix;
+    QM_ = partition.quotient_matrix;
+}
+
+namespace
+{
+/// @brief Range of a CSR adjacency list.
+struct AdjacentRange
+{
+    const int* first;
+    const int* last;
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+};
+
+/// @brief Run body(chunk, begin, end) on a few consecutive chunks of [0, num_items) per thread of the pool and wait for all of them.
+template<typename Body>
+void run_chunks(ThreadPool& pool, size_t num_items, size_t num_chunks, Body&& body)
+{
+    auto futures = std::vector<std::future<void>>();
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        const auto begin = num_items * chunk / num_chunks;
+        const auto end = num_items * (chunk + 1) / num_chunks;
+        futures.push_back(pool.submit([&body, chunk, begin, end]() { body(chunk, begin, end); }));
+    }
+    // Wait for all chunks before rethrowing, since they reference the workspaces of the refinement.
+    for (auto& future : futures)
+    {
+        pool.wait(future);
+    }
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+}
+
+size_t get_num_chunks(const ThreadPool& pool, size_t num_items) { return std::max<size_t>(1, std::min(num_items, 4 * pool.get_num_threads())); }
+}
+
+EquivalenceClasses CanonicalColorRefinement::calculate_equivalence_classes(const std::vector<const EdgeColoredGraph*>& graphs)
+{
+    auto result = EquivalenceClasses();
+    if (graphs.empty())
+        return result;
+
+    // Offsets of the graphs in the disjoint union
+    auto offsets = std::vector<int>(graphs.size() + 1, 0);
+    for (size_t i = 0; i < graphs.size(); ++i)
+    {
+        const auto& graph = *graphs[i];
+        if (graph.is_directed() != graphs.front()->is_directed())
+        {
+            throw std::runtime_error("graphs must be all directed or all undirected");
+        }
+        if (!std::all_of(graph.get_edge_labels().begin(), graph.get_edge_labels().end(), [](const auto& edge_label) { return edge_label == 0; }))
+        {
+            throw std::runtime_error("Only vertex colored graphs are supported");
+        }
+        offsets[i + 1] = offsets[i] + graph.get_num_nodes();
+    }
+    const int n = offsets.back();
+
+    // Initial coloring: the rank of the node label among all labels of the batch
+    auto labels = std::vector<int>();
+    labels.reserve(n);
+    for (const auto& graph : graphs)
+        labels.insert(labels.end(), graph->get_node_labels().begin(), graph->get_node_labels().end());
+    auto sorted_labels = labels;
+    std::sort(sorted_labels.begin(), sorted_labels.end());
+    sorted_labels.erase(std::unique(sorted_labels.begin(), sorted_labels.end()), sorted_labels.end());
+    auto alpha = std::vector<int>(n);
+    for (int v = 0; v < n; ++v)
+        alpha[v] = static_cast<int>(std::lower_bound(sorted_labels.begin(), sorted_labels.end(), labels[v]) - sorted_labels.begin()) + 1;
+
+    // Inbound adjacency of the union in CSR format
+    auto inbound_offsets = std::vector<EdgeId>(n + 1, 0);
+    auto inbound_nodes = std::vector<int>();
+    for (size_t i = 0; i < graphs.size(); ++i)
+    {
+        for (int v = 0; v < graphs[i]->get_num_nodes(); ++v)
+        {
+            for (const auto& w : graphs[i]->get_inbound_adjacent(v))
+                inbound_nodes.push_back(offsets[i] + w);
+            inbound_offsets[offsets[i] + v + 1] = static_cast<EdgeId>(inbound_nodes.size());
+        }
+    }
+
+    refine(n, alpha, [&](int v) { return AdjacentRange { inbound_nodes.data() + inbound_offsets[v], inbound_nodes.data() + inbound_offsets[v + 1] }; });
+
+    // Two graphs are equivalent iff every color of the union has the same number of vertices in both
+    auto classes = std::map<std::vector<std::pair<int, int>>, int>();
+    auto representatives = std::vector<size_t>();
+    auto colors = std::vector<int>();
+    for (size_t i = 0; i < graphs.size(); ++i)
+    {
+        colors.assign(colour_.begin() + offsets[i] + 1, colour_.begin() + offsets[i + 1] + 1);
+        std::sort(colors.begin(), colors.end());
+        auto histogram = std::vector<std::pair<int, int>>();
+        for (const auto& color : colors)
+        {
+            if (histogram.empty() || histogram.back().first != color)
+                histogram.emplace_back(color, 0);
+            ++histogram.back().second;
+        }
+
+        auto [it, inserted] = classes.emplace(std::move(histogram), static_cast<int>(representatives.size()));
+        if (inserted)
+            representatives.push_back(i);
+        result.class_ids.push_back(it->second);
+    }
+
+    // Quotient matrix of each class, computed on its first graph
+    auto local_colors = std::vector<int>(k_ + 1, -1);
+    QM_counts_.assign(k_ + 1, 0);
+    for (const auto& i : representatives)
+    {
+        const auto& graph = *graphs[i];
+        auto cells = std::vector<int>();  // Indexed by local color. A vertex of that color
+        for (int v = 0; v < graph.get_num_nodes(); ++v)
+        {
+            if (local_colors[colour_[offsets[i] + v + 1]] == -1)
+            {
+                local_colors[colour_[offsets[i] + v + 1]] = 0;
+                cells.push_back(v);
+            }
+        }
+        std::sort(cells.begin(), cells.end(), [&](int u, int v) { return colour_[offsets[i] + u + 1] < colour_[offsets[i] + v + 1]; });
+        const auto k = static_cast<int>(cells.size());
+        for (int c = 0; c < k; ++c)
+            local_colors[colour_[offsets[i] + cells[c] + 1]] = c;
+
+        auto quotient_matrix = std::vector<QuotientEntry>();
+        for (int c = 0; c < k; ++c)
+        {
+            append_quotient_row(
+                c + 1,
+                graph.get_outbound_adjacent(cells[c]),
+                [&](int v) { return local_colors[colour_[offsets[i] + v + 1]] + 1; },
+                quotient_matrix);
+        }
+        result.quotient_matrices.push_back(std::move(quotient_matrix));
+
+        for (const auto& v : cells)
+            local_colors[colour_[offsets[i] + v + 1]] = -1;
+    }
+
+    return result;
+}
+
+template<typename InboundAdjacent>
+void CanonicalColorRefinement::compute_color_degrees_parallel(int r, const InboundAdjacent& inbound_adjacent, ThreadPool& pool)
+{
+    refining_nodes_.assign(C_.at(r).begin(), C_.at(r).end());
+
+    const auto num_chunks = get_num_chunks(pool, refining_nodes_.size());
+    touched_nodes_.resize(num_chunks);
+
+    // Exactly one chunk raises the color degree of a vertex from 0, and only that chunk appends it to A, so A has no duplicates.
+    run_chunks(pool,
+               refining_nodes_.size(),
+               num_chunks,
+               [&](size_t chunk, size_t begin, size_t end)
+               {
+                   auto& touched_nodes = touched_nodes_[chunk];
+                   touched_nodes.clear();
+                   for (size_t i = begin; i < end; ++i)
+                   {
+                       for (auto const& w : inbound_adjacent(refining_nodes_[i] - 1))
+                       {
+                           if (std::atomic_ref<int>(cdeg_[w + 1]).fetch_add(1, std::memory_order_relaxed) == 0)
+                               touched_nodes.push_back(w + 1);
+                       }
+                   }
+               });
+
+    // The order of A[c] and colors_adj differs from the serial loop, but nothing below depends on it.
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        for (auto const& w : touched_nodes_[chunk])
+        {
+            const auto c = colour_[w];
+            A_[c].push_back(w);
+            if (!in_colors_adj_[c])
+            {
+                in_colors_adj_[c] = true;
+                colors_adj_.push_back(c);
+            }
+            maxcdeg_[c] = std::max(maxcdeg_[c], cdeg_[w]);
+        }
+    }
+}
+
+template<typename InboundAdjacent>
+void CanonicalColorRefinement::refine(int n, const std::vector<int>& alpha, const InboundAdjacent& inbound_adjacent, ThreadPool* pool)
+{
+    // Create data structures, reusing the allocations of previous calls
+    colour_.assign(n + 1, 0);
+    C_.resize(n + 1);
+    for (auto& cell : C_)
+        cell.clear();
+    A_.resize(n + 1);
+    for (auto& adjacent : A_)
+        adjacent.clear();
+    mincdeg_.assign(n + 1, -1);
+    maxcdeg_.assign(n + 1, 0);
+    cdeg_.assign(n + 1, 0);
     maxcdeg_.at(0) = -1;
     valid_QM_ = false;
 
@@ -59,11 +349,15 @@ void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool cal
         std::cout << "             k: " << k_ << std::endl;
     }
 
-    std::vector<int> colors_adj;    // Colors adjacent to color r
-    std::vector<int> colors_split;  // Colors in colors_adj that generate non-trivial splits
+    auto& colors_adj = colors_adj_;
+    auto& colors_split = colors_split_;
+    auto& in_colors_adj = in_colors_adj_;
 
-    in_s_refine_ = std::vector<bool>(n + 1, false);
-    std::vector<bool> in_colors_adj(n + 1, false);
+    s_refine_.clear();
+    in_s_refine_.assign(n + 1, false);
+    in_colors_adj.assign(n + 1, false);
+    colors_adj.clear();
+    colors_split.clear();
     colors_adj.reserve(n + 1);
     colors_split.reserve(n + 1);
 
@@ -101,25 +395,32 @@ void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool cal
         }
 
         // Compute color degrees, max color degrees, A[i], and color_adj
-        for (auto const& v : C_.at(r))
+        if (pool && debug_ == 0 && static_cast<int>(C_.at(r).size()) >= MIN_PARALLEL_CELL_SIZE)
+        {
+            compute_color_degrees_parallel(r, inbound_adjacent, *pool);
+        }
+        else
         {
-            for (auto const& w : graph.get_inbound_adjacent(v - 1))
+            for (auto const& v : C_.at(r))
             {
-                cdeg_.at(w + 1) = cdeg_.at(w + 1) + 1;
-                if (cdeg_.at(w + 1) == 1)
+                for (auto const& w : inbound_adjacent(v - 1))
                 {
-                    // Conditional is to avoid inserting same vertex twice in array A
-                    A_.at(colour_.at(w + 1)).push_back(w + 1);
+                    cdeg_.at(w + 1) = cdeg_.at(w + 1) + 1;
+                    if (cdeg_.at(w + 1) == 1)
+                    {
+                        // Conditional is to avoid inserting same vertex twice in array A
+                        A_.at(colour_.at(w + 1)).push_back(w + 1);
+                    }
+
+                    if (!in_colors_adj.at(colour_.at(w + 1)))
+                    {
+                        in_colors_adj.at(colour_.at(w + 1)) = true;
+                        colors_adj.push_back(colour_.at(w + 1));
+                    }
+
+                    if (cdeg_.at(w + 1) > maxcdeg_.at(colour_.at(w + 1)))
+                        maxcdeg_.at(colour_.at(w + 1)) = cdeg_.at(w + 1);
                 }
-
-                if (!in_colors_adj.at(colour_.at(w + 1)))
-                {
-                    in_colors_adj.at(colour_.at(w + 1)) = true;
-                    colors_adj.push_back(colour_.at(w + 1));
-                }
-
-                if (cdeg_.at(w + 1) > maxcdeg_.at(colour_.at(w + 1)))
-                    maxcdeg_.at(colour_.at(w + 1)) = cdeg_.at(w + 1);
             }
         }
 
@@ -166,8 +467,19 @@ void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool cal
             std::cout << "  colors_split: " << colors_split << " (ordered)" << std::endl;
 
         // Calculate refinement
+        size_t split_size = 0;
         for (auto const& s : colors_split)
-            split_up_color(s);
+            split_size += A_.at(s).size();
+
+        if (pool && debug_ == 0 && colors_split.size() > 1 && split_size >= MIN_PARALLEL_SPLIT_SIZE)
+        {
+            split_up_colors_parallel(*pool);
+        }
+        else
+        {
+            for (auto const& s : colors_split)
+                split_up_color(s);
+        }
 
         // Reset data structures
         if (debug_ > 0)
@@ -195,20 +507,35 @@ void CanonicalColorRefinement::calculate(const EdgeColoredGraph& graph, bool cal
         C_[i] = std::move(C_[i + 1]);
     while (static_cast<int>(C_.size()) > k_)
         C_.pop_back();
-    if (calculate_qm)
-        calculate_quotient_matrix(graph);
+
+    // Flat representation of the coloring, in new arrays so that readers of the previous one are not affected
+    auto partition = std::make_shared<FlatPartition>();
+    partition->node_colors.assign(colour_.begin() + 1, colour_.end());
+    partition->partition_nodes.reserve(n);
+    partition->partition_offsets.assign(1, 0);
+    for (const auto& cell : C_)
+    {
+        for (const auto& v : cell)
+            partition->partition_nodes.push_back(v - 1);
+        partition->partition_offsets.push_back(static_cast<int>(partition->partition_nodes.size()));
+    }
+    partition_ = std::move(partition);
 }
 
-void CanonicalColorRefinement::split_up_color(int s)
+void CanonicalColorRefinement::count_color_degrees(int s, std::vector<int>& ref_numcdeg) const
 {
-    int maxcdeg = maxcdeg_.at(s);
-    std::vector<int> numcdeg(1 + maxcdeg, 0);
+    ref_numcdeg.assign(1 + maxcdeg_.at(s), 0);
     for (auto const& v : A_.at(s))
     {
         assert(cdeg_.at(v) > 0);
-        numcdeg.at(cdeg_.at(v)) = numcdeg.at(cdeg_.at(v)) + 1;
+        ref_numcdeg.at(cdeg_.at(v)) = ref_numcdeg.at(cdeg_.at(v)) + 1;
     }
-    numcdeg.at(0) = C_.at(s).size() - A_.at(s).size();
+    ref_numcdeg.at(0) = C_.at(s).size() - A_.at(s).size();
+}
+
+void CanonicalColorRefinement::assign_split_colors(int s, const std::vector<int>& numcdeg, std::vector<int>& ref_new_colors)
+{
+    int maxcdeg = maxcdeg_.at(s);
 
     if (debug_ > 1)
     {
@@ -236,7 +563,8 @@ void CanonicalColorRefinement::split_up_color(int s)
         std::cout << " Is s in s_refine? " << color_s_is_in_s_refine << std::endl;
     }
 
-    std::vector<int> f(1 + maxcdeg, -1);
+    auto& f = ref_new_colors;
+    f.assign(1 + maxcdeg, -1);
     for (int i = 0; i <= maxcdeg; ++i)
     {
         if (numcdeg.at(i) > 0)
@@ -266,7 +594,11 @@ void CanonicalColorRefinement::split_up_color(int s)
     }
     if (debug_ > 1)
         std::cout << "                f: " << f << std::endl;
+}
 
+void CanonicalColorRefinement::move_split_vertices(int s, const std::vector<int>& new_colors)
+{
+    const auto& f = new_colors;
     for (auto const& v : A_.at(s))
     {
         if (f.at(cdeg_.at(v)) != s)
@@ -289,33 +621,93 @@ void CanonicalColorRefinement::split_up_color(int s)
     }
 }
 
+void CanonicalColorRefinement::split_up_color(int s)
+{
+    std::vector<int> numcdeg;
+    std::vector<int> f;
+    count_color_degrees(s, numcdeg);
+    assign_split_colors(s, numcdeg, f);
+    move_split_vertices(s, f);
+}
+
+void CanonicalColorRefinement::split_up_colors_parallel(ThreadPool& pool)
+{
+    const auto num_colors = colors_split_.size();
+    const auto num_chunks = get_num_chunks(pool, num_colors);
+    split_numcdeg_.resize(num_colors);
+    split_new_colors_.resize(num_colors);
+
+    run_chunks(pool,
+               num_colors,
+               num_chunks,
+               [&](size_t /* chunk */, size_t begin, size_t end)
+               {
+                   for (size_t i = begin; i < end; ++i)
+                       count_color_degrees(colors_split_[i], split_numcdeg_[i]);
+               });
+
+    // Numbering and queueing the new colors in the order of colors_split keeps the result canonical.
+    for (size_t i = 0; i < num_colors; ++i)
+        assign_split_colors(colors_split_[i], split_numcdeg_[i], split_new_colors_[i]);
+
+    // Every vertex moves from its split color to a new color of the same split, so the moves of distinct colors are independent.
+    run_chunks(pool,
+               num_colors,
+               num_chunks,
+               [&](size_t /* chunk */, size_t begin, size_t end)
+               {
+                   for (size_t i = begin; i < end; ++i)
+                       move_split_vertices(colors_split_[i], split_new_colors_[i]);
+               });
+}
+
+template<typename GetColumn>
+void CanonicalColorRefinement::append_quotient_row(int row,
+                                                   const std::vector<int>& adjacent,
+                                                   GetColumn&& get_column,
+                                                   std::vector<QuotientEntry>& ref_quotient_matrix)
+{
+    QM_columns_.clear();
+    for (const auto& v : adjacent)
+    {
+        const auto column = get_column(v);
+        if (QM_counts_[column]++ == 0)
+            QM_columns_.push_back(column);
+    }
+
+    // Only the columns of the neighbors are sorted, so a row costs O(d log d) instead of O(k).
+    std::sort(QM_columns_.begin(), QM_columns_.end());
+    for (const auto& column : QM_columns_)
+    {
+        ref_quotient_matrix.push_back({ row, column, QM_counts_[column] });
+        QM_counts_[column] = 0;
+    }
+}
+
 void CanonicalColorRefinement::calculate_quotient_matrix(const EdgeColoredGraph& graph)
 {
-    QM_ = std::vector<std::vector<int>>();
+    QM_.clear();
+    QM_counts_.assign(k_ + 1, 0);
     for (int i = 0; i < k_; ++i)
     {
-        int u = *C_.at(i).begin();
-        std::vector<int> frequency(k_, 0);
-        for (auto& v : graph.get_outbound_adjacent(u - 1))
-        {
-            int j = colour_.at(v + 1);
-            frequency.at(j - 1) += 1;
-        }
-        for (int j = 0; j < static_cast<int>(frequency.size()); ++j)
-        {
-            if (frequency.at(j) > 0)
-            {
-                std::vector<int> entry({ i + 1, j + 1, frequency.at(j) });
-                QM_.emplace_back(std::move(entry));
-            }
-        }
+        // The representative is the smallest vertex of the color, as in C_
+        const auto u = partition_->partition_nodes[partition_->partition_offsets[i]];
+        append_quotient_row(i + 1, graph.get_outbound_adjacent(u), [&](int v) { return colour_[v + 1]; }, QM_);
     }
     valid_QM_ = true;
 }
 
 const std::vector<std::set<int>>& CanonicalColorRefinement::get_coloring() const { return C_; }
 
-const std::vector<std::vector<int>>& CanonicalColorRefinement::get_quotient_matrix() const { return QM_; }
+const std::vector<int>& CanonicalColorRefinement::get_node_colors() const { return partition_->node_colors; }
+
+const std::vector<int>& CanonicalColorRefinement::get_partition_nodes() const { return partition_->partition_nodes; }
+
+const std::vector<int>& CanonicalColorRefinement::get_partition_offsets() const { return partition_->partition_offsets; }
+
+std::shared_ptr<const FlatPartition> CanonicalColorRefinement::get_partition() const { return partition_; }
+
+const std::vector<QuotientEntry>& CanonicalColorRefinement::get_quotient_matrix() const { return QM_; }
 
 std::string CanonicalColorRefinement::get_quotient_matrix_string() const
 {
@@ -328,7 +720,7 @@ std::string CanonicalColorRefinement::get_quotient_matrix_string() const
     {
         if (code != "")
             code += "-";
-        code += std::to_string(entry.at(2)) + "@(" + std::to_string(entry.at(0)) + "," + std::to_string(entry.at(1)) + ")";
+        code += std::to_string(entry.count) + "@(" + std::to_string(entry.row) + "," + std::to_string(entry.column) + ")";
     }
     return code;
 }
@@ -337,6 +729,18 @@ void CanonicalColorRefinement::set_debug(int debug) { debug_ = debug; }
 
 void CanonicalColorRefinement::set_use_stack(bool use_stack) { use_stack_ = use_stack; }
 
+void CanonicalColorRefinement::set_invariant_seeding(bool invariant_seeding) { invariant_seeding_ = invariant_seeding; }
+
+void CanonicalColorRefinement::set_cache_capacity(size_t capacity)
+{
+    if (capacity == 0)
+        cache_.reset();
+    else
+        cache_ = std::make_shared<ResultCache<CachedPartition>>(capacity);
+}
+
+CacheStatistics CanonicalColorRefinement::get_cache_statistics() const { return cache_ ? cache_->get_statistics() : CacheStatistics(); }
+
 std::vector<int> CanonicalColorRefinement::coloring_to_histogram(const std::vector<std::set<int>>& partition)
 {
     std::vector<int> hist;
@@ -0,0 +1,246 @@
+#include "wl/details/canonical_labeling.hpp"
+
+#include "wl/details/utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+CanonicalLabeling::CanonicalLabeling() :
+    refinement_(0, false),
+    graph_(nullptr),
+    initial_alpha_(),
+    has_best_(false),
+    first_(),
+    best_(),
+    generators_(),
+    path_(),
+    num_nodes_(0),
+    num_leaves_(0)
+{
+}
+
+const CanonicalForm& CanonicalLabeling::calculate(const EdgeColoredGraph& graph)
+{
+    graph_ = &graph;
+    has_best_ = false;
+    first_ = CanonicalForm();
+    best_ = CanonicalForm();
+    generators_.clear();
+    path_.clear();
+    num_nodes_ = 0;
+    num_leaves_ = 0;
+
+    const int n = graph.get_num_nodes();
+
+    if (n > 0)
+    {
+        // Compress the node labels to the colors 1, ..., k in the order of the labels, which is canonical.
+        auto labels = graph.get_node_labels();
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+        initial_alpha_.resize(n);
+        for (int v = 0; v < n; ++v)
+        {
+            initial_alpha_.at(v) = 1 + static_cast<int>(std::lower_bound(labels.begin(), labels.end(), graph.get_node_label(v)) - labels.begin());
+        }
+
+        search(initial_alpha_);
+    }
+
+    uint64_t hash = static_cast<uint64_t>(n);
+    for (const auto& label : best_.node_labels)
+        hash_combine(hash, static_cast<uint64_t>(label));
+    for (const auto& [src, dst] : best_.edges)
+        hash_combine(hash, (static_cast<uint64_t>(src) << 32) | static_cast<uint64_t>(dst));
+    best_.hash = hash;
+
+    graph_ = nullptr;
+    return best_;
+}
+
+std::vector<int> CanonicalLabeling::refine(const std::vector<int>& alpha)
+{
+    refinement_.calculate(*graph_, alpha);
+
+    // Cells are indexed by color - 1 and contain vertices + 1
+    std::vector<int> colors(graph_->get_num_nodes(), 0);
+    const auto& cells = refinement_.get_coloring();
+    for (size_t c = 0; c < cells.size(); ++c)
+    {
+        for (const auto& v : cells[c])
+            colors.at(v - 1) = static_cast<int>(c) + 1;
+    }
+    return colors;
+}
+
+void CanonicalLabeling::search(const std::vector<int>& alpha)
+{
+    ++num_nodes_;
+
+    const auto colors = refine(alpha);
+    const auto& cells = refinement_.get_coloring();
+    const int n = graph_->get_num_nodes();
+
+    if (static_cast<int>(cells.size()) == n)
+    {
+        visit_leaf(colors);
+        return;
+    }
+
+    // Target cell: the first smallest non-singleton cell
+    int target = -1;
+    size_t target_size = std::numeric_limits<size_t>::max();
+    for (size_t c = 0; c < cells.size(); ++c)
+    {
+        if (cells[c].size() > 1 && cells[c].size() < target_size)
+        {
+            target = static_cast<int>(c);
+            target_size = cells[c].size();
+        }
+    }
+    assert(target >= 0);
+
+    // Children overwrite the refinement workspace, so copy the target cell first
+    std::vector<int> cell;
+    for (const auto& v : cells[target])
+        cell.push_back(v - 1);
+    const int cell_color = target + 1;
+
+    std::vector<int> child_alpha(n);
+    std::vector<int> explored;
+    for (const auto& v : cell)
+    {
+        if (is_in_explored_orbit(v, explored))
+            continue;
+
+        // Individualize v: it keeps the color of the cell, the rest of the cell and all larger colors are shifted by one
+        for (int u = 0; u < n; ++u)
+        {
+            if (u == v || colors[u] < cell_color)
+                child_alpha[u] = colors[u];
+            else
+                child_alpha[u] = colors[u] + 1;
+        }
+
+        path_.push_back(v);
+        search(child_alpha);
+        path_.pop_back();
+        explored.push_back(v);
+    }
+}
+
+void CanonicalLabeling::visit_leaf(const std::vector<int>& colors)
+{
+    ++num_leaves_;
+
+    const int n = graph_->get_num_nodes();
+
+    CanonicalForm form;
+    form.labeling.resize(n);
+    form.node_labels.resize(n);
+    for (int v = 0; v < n; ++v)
+    {
+        form.labeling[v] = colors[v] - 1;
+        form.node_labels[form.labeling[v]] = graph_->get_node_label(v);
+    }
+    for (int v = 0; v < n; ++v)
+    {
+        for (const auto& w : graph_->get_outbound_adjacent(v))
+            form.edges.emplace_back(form.labeling[v], form.labeling[w]);
+    }
+    std::sort(form.edges.begin(), form.edges.end());
+    form.hash = 0;
+
+    if (!has_best_)
+    {
+        first_ = form;
+        best_ = std::move(form);
+        has_best_ = true;
+        return;
+    }
+
+    // Equal certificates map the vertex at each position of one leaf to the vertex at the same position of the other leaf
+    auto add_automorphism = [&](const CanonicalForm& other)
+    {
+        std::vector<int> inverse(n);
+        for (int v = 0; v < n; ++v)
+            inverse[other.labeling[v]] = v;
+
+        std::vector<int> automorphism(n);
+        bool is_identity = true;
+        for (int v = 0; v < n; ++v)
+        {
+            automorphism[v] = inverse[form.labeling[v]];
+            is_identity = is_identity && automorphism[v] == v;
+        }
+        if (!is_identity)
+            generators_.push_back(std::move(automorphism));
+    };
+
+    if (form == first_)
+    {
+        add_automorphism(first_);
+    }
+    else if (form == best_)
+    {
+        add_automorphism(best_);
+    }
+    else if (std::tie(form.node_labels, form.edges) < std::tie(best_.node_labels, best_.edges))
+    {
+        best_ = std::move(form);
+    }
+}
+
+bool CanonicalLabeling::is_in_explored_orbit(int vertex, const std::vector<int>& explored) const
+{
+    if (explored.empty() || generators_.empty())
+        return false;
+
+    const int n = graph_->get_num_nodes();
+
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v)
+    {
+        while (parent[v] != v)
+        {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+
+    // Only automorphisms that fix the individualized vertices pointwise preserve the current search node
+    for (const auto& automorphism : generators_)
+    {
+        if (!std::all_of(path_.begin(), path_.end(), [&](int v) { return automorphism[v] == v; }))
+            continue;
+
+        for (int v = 0; v < n; ++v)
+            parent[find(v)] = find(automorphism[v]);
+    }
+
+    const int root = find(vertex);
+    return std::any_of(explored.begin(), explored.end(), [&](int v) { return find(v) == root; });
+}
+
+const CanonicalForm& CanonicalLabeling::get_canonical_form() const { return best_; }
+
+uint64_t CanonicalLabeling::get_hash() const { return best_.hash; }
+
+const std::vector<std::vector<int>>& CanonicalLabeling::get_automorphism_generators() const { return generators_; }
+
+size_t CanonicalLabeling::get_num_search_nodes() const { return num_nodes_; }
+
+size_t CanonicalLabeling::get_num_leaves() const { return num_leaves_; }
+
+}
@@ -0,0 +1,178 @@
+#include "wl/details/certificate_store.hpp"
+
+#include "wl/details/utils.hpp"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace wl
+{
+
+static constexpr size_t NUM_SHARDS = 64;
+
+// Tags that separate the kinds of certificates
+static constexpr int HISTOGRAM_CERTIFICATE = 0;
+static constexpr int QUOTIENT_MATRIX_CERTIFICATE = 1;
+
+CertificateStore::CertificateStore(const CertificateStoreOptions& options) :
+    m_options(options),
+    m_shards(NUM_SHARDS),
+    m_bloom_filter((options.num_bloom_filter_bits + 63) / 64),
+    m_size(0)
+{
+    if (!m_bloom_filter.empty() && options.num_bloom_filter_hashes < 1)
+    {
+        throw std::invalid_argument("num_bloom_filter_hashes must be positive");
+    }
+}
+
+std::vector<int> CertificateStore::make_certificate(const std::vector<int>& unique, const std::vector<int>& counts)
+{
+    if (unique.size() != counts.size())
+    {
+        throw std::invalid_argument("unique and counts must have the same size");
+    }
+
+    auto certificate = std::vector<int>();
+    certificate.reserve(2 * unique.size() + 1);
+    certificate.push_back(HISTOGRAM_CERTIFICATE);
+    for (size_t i = 0; i < unique.size(); ++i)
+    {
+        certificate.push_back(unique[i]);
+        certificate.push_back(counts[i]);
+    }
+    return certificate;
+}
+
+std::vector<int> CertificateStore::make_certificate(const std::vector<QuotientEntry>& quotient_matrix)
+{
+    auto certificate = std::vector<int>();
+    certificate.reserve(1 + 4 * quotient_matrix.size());
+    certificate.push_back(QUOTIENT_MATRIX_CERTIFICATE);
+    for (const auto& entry : quotient_matrix)
+    {
+        // Length-prefixed triples
+        certificate.push_back(3);
+        certificate.push_back(entry.row);
+        certificate.push_back(entry.column);
+        certificate.push_back(entry.count);
+    }
+    return certificate;
+}
+
+Fingerprint CertificateStore::get_fingerprint(const std::vector<int>& certificate)
+{
+    // Two hash chains with independent seeds
+    uint64_t high = 0x6a09e667f3bcc908ULL;
+    uint64_t low = 0xbb67ae8584caa73bULL;
+    hash_combine(high, certificate.size());
+    hash_combine(low, ~static_cast<uint64_t>(certificate.size()));
+    for (const auto& value : certificate)
+    {
+        hash_combine(high, static_cast<uint32_t>(value));
+        hash_combine(low, static_cast<uint64_t>(static_cast<uint32_t>(value)) * 0x9e3779b97f4a7c15ULL);
+    }
+    return Fingerprint { high, low };
+}
+
+CertificateStore::Shard& CertificateStore::get_shard(const Fingerprint& fingerprint) { return m_shards[fingerprint.high % m_shards.size()]; }
+
+const CertificateStore::Shard& CertificateStore::get_shard(const Fingerprint& fingerprint) const { return m_shards[fingerprint.high % m_shards.size()]; }
+
+bool CertificateStore::bloom_filter_may_contain(const Fingerprint& fingerprint) const
+{
+    if (m_bloom_filter.empty())
+        return true;
+
+    const auto num_bits = m_bloom_filter.size() * 64;
+    for (int i = 0; i < m_options.num_bloom_filter_hashes; ++i)
+    {
+        const auto bit = (fingerprint.low + i * fingerprint.high) % num_bits;
+        if (!(m_bloom_filter[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64))))
+            return false;
+    }
+    return true;
+}
+
+void CertificateStore::add_to_bloom_filter(const Fingerprint& fingerprint)
+{
+    if (m_bloom_filter.empty())
+        return;
+
+    const auto num_bits = m_bloom_filter.size() * 64;
+    for (int i = 0; i < m_options.num_bloom_filter_hashes; ++i)
+    {
+        const auto bit = (fingerprint.low + i * fingerprint.high) % num_bits;
+        m_bloom_filter[bit / 64].fetch_or(uint64_t(1) << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+size_t CertificateStore::find(const Shard& shard, const Fingerprint& fingerprint, const std::vector<int>& certificate) const
+{
+    auto [begin, end] = shard.entries.equal_range(fingerprint);
+    for (auto it = begin; it != end; ++it)
+    {
+        if (!m_options.verify || it->second.certificate == certificate)
+            return it->second.id;
+    }
+    return NOT_FOUND;
+}
+
+std::pair<size_t, bool> CertificateStore::insert(const std::vector<int>& certificate)
+{
+    const auto fingerprint = get_fingerprint(certificate);
+    auto& shard = get_shard(fingerprint);
+
+    if (bloom_filter_may_contain(fingerprint))
+    {
+        std::shared_lock lock(shard.mutex);
+
+        const auto id = find(shard, fingerprint, certificate);
+        if (id != NOT_FOUND)
+        {
+            return { id, false };
+        }
+    }
+
+    std::unique_lock lock(shard.mutex);
+
+    // Another thread may have inserted the certificate between releasing the shared lock and acquiring the exclusive lock.
+    const auto id = find(shard, fingerprint, certificate);
+    if (id != NOT_FOUND)
+    {
+        return { id, false };
+    }
+
+    const auto new_id = m_size.fetch_add(1);
+    shard.entries.emplace(fingerprint, Entry { new_id, m_options.verify ? certificate : std::vector<int>() });
+    // Set the bits while holding the lock, so that a lookup that finds them unset cannot miss a finished insertion.
+    add_to_bloom_filter(fingerprint);
+    return { new_id, true };
+}
+
+size_t CertificateStore::find(const std::vector<int>& certificate) const
+{
+    const auto fingerprint = get_fingerprint(certificate);
+    if (!bloom_filter_may_contain(fingerprint))
+    {
+        return NOT_FOUND;
+    }
+
+    const auto& shard = get_shard(fingerprint);
+    std::shared_lock lock(shard.mutex);
+    return find(shard, fingerprint, certificate);
+}
+
+bool CertificateStore::contains(const std::vector<int>& certificate) const { return find(certificate) != NOT_FOUND; }
+
+std::pair<size_t, bool> CertificateStore::insert_coloring(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations)
+{
+    const auto [is_stable, num_iterations, unique, counts] = engine.compute_coloring(graph, max_num_iterations);
+    return insert(make_certificate(unique, counts));
+}
+
+size_t CertificateStore::size() const { return m_size.load(); }
+
+const CertificateStoreOptions& CertificateStore::get_options() const { return m_options; }
+
+}
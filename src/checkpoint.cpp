@@ -0,0 +1,32 @@
+#include "wl/details/checkpoint.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+namespace wl
+{
+
+void write_file_atomically(const std::string& path, const std::function<void(std::ostream&)>& write)
+{
+    const auto temporary_path = path + ".tmp";
+
+    {
+        auto out = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::runtime_error("write_file_atomically: cannot open " + temporary_path);
+        }
+
+        write(out);
+
+        out.flush();
+        if (!out)
+        {
+            throw std::runtime_error("write_file_atomically: failed to write " + temporary_path);
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path);
+}
+
+}
@@ -0,0 +1,185 @@
+#include "wl/details/color_function.hpp"
+
+#include "wl/details/checkpoint.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+static void write_adjacent_colors(std::ostream& out, const std::vector<AdjacentColor>& adjacent_colors)
+{
+    auto values = std::vector<Color>();
+    values.reserve(2 * adjacent_colors.size());
+    for (const auto& [first, second] : adjacent_colors)
+    {
+        values.push_back(first);
+        values.push_back(second);
+    }
+    write_binary_vector(out, values);
+}
+
+static std::vector<AdjacentColor> read_adjacent_colors(std::istream& in)
+{
+    const auto values = read_binary_vector<Color>(in);
+    if (values.size() % 2 != 0)
+    {
+        throw std::runtime_error("ColorFunction::read: odd number of adjacent color values");
+    }
+    auto adjacent_colors = std::vector<AdjacentColor>();
+    adjacent_colors.reserve(values.size() / 2);
+    for (size_t i = 0; i < values.size(); i += 2)
+    {
+        adjacent_colors.emplace_back(values[i], values[i + 1]);
+    }
+    return adjacent_colors;
+}
+
+ColorFunction::ColorFunction() :
+    m_color_function(),
+    m_mutex(),
+    m_frozen(false),
+    m_policy(UnseenContextPolicy::UNKNOWN_COLOR),
+    m_unknown_color(UNKNOWN_COLOR)
+{
+}
+
+Color ColorFunction::get_unseen_color() const
+{
+    if (m_policy == UnseenContextPolicy::THROW)
+    {
+        throw UnseenContextError();
+    }
+
+    return m_unknown_color;
+}
+
+Color ColorFunction::get_or_insert(NodeColorContext&& node_color_context)
+{
+    // A frozen mapping never changes again, so it can be read without a lock.
+    if (m_frozen.load(std::memory_order_acquire))
+    {
+        auto it = m_color_function.find(node_color_context);
+
+        return (it != m_color_function.end()) ? it->second : get_unseen_color();
+    }
+
+    {
+        std::shared_lock lock(m_mutex);
+
+        auto it = m_color_function.find(node_color_context);
+
+        if (it != m_color_function.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(m_mutex);
+
+    // Another thread may have frozen the mapping between releasing the shared lock and acquiring the exclusive lock.
+    if (m_frozen.load(std::memory_order_relaxed))
+    {
+        auto it = m_color_function.find(node_color_context);
+
+        return (it != m_color_function.end()) ? it->second : get_unseen_color();
+    }
+
+    // Another thread may have inserted the context between releasing the shared lock and acquiring the exclusive lock.
+    auto color = static_cast<Color>(m_color_function.size());
+    auto [it, inserted] = m_color_function.emplace(std::move(node_color_context), color);
+
+    return it->second;
+}
+
+void ColorFunction::freeze(UnseenContextPolicy policy, Color unknown_color)
+{
+    std::unique_lock lock(m_mutex);
+
+    // Lock-free readers may already use the policy of the first call.
+    if (m_frozen.load(std::memory_order_relaxed))
+    {
+        throw std::logic_error("ColorFunction::freeze: already frozen");
+    }
+
+    m_policy = policy;
+    m_unknown_color = unknown_color;
+    m_frozen.store(true, std::memory_order_release);
+}
+
+bool ColorFunction::is_frozen() const { return m_frozen.load(std::memory_order_acquire); }
+
+UnseenContextPolicy ColorFunction::get_unseen_context_policy() const { return m_policy; }
+
+Color ColorFunction::get_unknown_color() const { return m_unknown_color; }
+
+size_t ColorFunction::size() const
+{
+    if (m_frozen.load(std::memory_order_acquire))
+    {
+        return m_color_function.size();
+    }
+
+    std::shared_lock lock(m_mutex);
+
+    return m_color_function.size();
+}
+
+void ColorFunction::write(std::ostream& out) const
+{
+    std::shared_lock lock(m_mutex);
+
+    write_binary<uint64_t>(out, m_color_function.size());
+
+    for (const auto& [node_color_context, color] : m_color_function)
+    {
+        write_binary<Color>(out, color);
+        write_binary<ContextColor>(out, std::get<0>(node_color_context));
+        write_adjacent_colors(out, std::get<1>(node_color_context));
+        write_adjacent_colors(out, std::get<2>(node_color_context));
+    }
+}
+
+void ColorFunction::read(std::istream& in)
+{
+    const auto size = read_binary<uint64_t>(in);
+
+    auto color_function = std::map<NodeColorContext, Color>();
+    auto is_used = std::vector<bool>(size, false);
+
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        const auto color = read_binary<Color>(in);
+        const auto first_color = read_binary<ContextColor>(in);
+        auto first_colors = read_adjacent_colors(in);
+        auto second_colors = read_adjacent_colors(in);
+
+        // New colors are assigned as the size of the mapping, so the colors must be exactly 0, ..., size - 1.
+        if (color < 0 || static_cast<uint64_t>(color) >= size)
+        {
+            throw std::runtime_error("ColorFunction::read: color out of range");
+        }
+        if (is_used[color])
+        {
+            throw std::runtime_error("ColorFunction::read: duplicate color");
+        }
+        is_used[color] = true;
+
+        color_function.emplace(NodeColorContext { first_color, std::move(first_colors), std::move(second_colors) }, color);
+    }
+
+    std::unique_lock lock(m_mutex);
+
+    if (m_frozen.load(std::memory_order_relaxed))
+    {
+        throw std::logic_error("ColorFunction::read: frozen");
+    }
+
+    m_color_function = std::move(color_function);
+}
+
+}
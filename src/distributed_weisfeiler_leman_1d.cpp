@@ -0,0 +1,577 @@
+#include "wl/details/distributed_weisfeiler_leman_1d.hpp"
+
+#include "wl/details/utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace wl
+{
+
+static constexpr int STATUS_CONTINUE = 0;
+static constexpr int STATUS_STOP = 1;
+
+// Kinds of the adjacency records that distribute_graph sends to the owners of vertices
+static constexpr int OUTBOUND = 0;
+static constexpr int INBOUND = 1;
+
+static int get_owner(const std::vector<int>& boundaries, int node)
+{
+    return static_cast<int>(std::upper_bound(boundaries.begin(), boundaries.end(), node) - boundaries.begin()) - 1;
+}
+
+/// @brief Send messages[w] to worker w and return the message of each worker, where the own message is passed through.
+/// Pairs exchange in increasing order of the peer, which all workers agree on, so blocking sends cannot deadlock.
+static std::vector<Message> exchange(Transport& transport, int worker, std::vector<Message> messages)
+{
+    const auto num_workers = static_cast<int>(messages.size());
+    auto received = std::vector<Message>(num_workers);
+    for (int w = 0; w < num_workers; ++w)
+    {
+        if (w == worker)
+        {
+            received[w] = std::move(messages[w]);
+        }
+        else if (worker < w)
+        {
+            transport.send(w + 1, messages[w]);
+            received[w] = transport.receive(w + 1);
+        }
+        else
+        {
+            received[w] = transport.receive(w + 1);
+            transport.send(w + 1, messages[w]);
+        }
+    }
+    return received;
+}
+
+// ---------------
+// GraphPartition
+// ---------------
+
+std::vector<int> get_partition_boundaries(int num_nodes, int num_workers)
+{
+    if (num_workers < 1)
+    {
+        throw std::invalid_argument("num_workers must be positive");
+    }
+
+    auto boundaries = std::vector<int>(num_workers + 1);
+    for (int w = 0; w <= num_workers; ++w)
+    {
+        boundaries[w] = static_cast<int>(static_cast<long long>(num_nodes) * w / num_workers);
+    }
+    return boundaries;
+}
+
+std::vector<GraphPartition> partition_graph(const EdgeColoredGraph& graph, int num_workers)
+{
+    const auto num_nodes = graph.get_num_nodes();
+    const auto& edge_labels = graph.get_edge_labels();
+    const auto boundaries = get_partition_boundaries(num_nodes, num_workers);
+
+    auto append_adjacency = [&](const std::vector<int>& nodes, const std::vector<EdgeId>& edges, std::vector<int>& ref_nodes, std::vector<int>& ref_labels)
+    {
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            ref_nodes.push_back(nodes[i]);
+            ref_labels.push_back(edge_labels[edges[i]]);
+        }
+    };
+
+    auto partitions = std::vector<GraphPartition>(num_workers);
+    for (int w = 0; w < num_workers; ++w)
+    {
+        auto& partition = partitions[w];
+        partition.num_nodes = num_nodes;
+        partition.directed = graph.is_directed();
+        partition.boundaries = boundaries;
+        partition.worker = w;
+        partition.outbound_offsets.push_back(0);
+        partition.inbound_offsets.push_back(0);
+
+        for (int v = boundaries[w]; v < boundaries[w + 1]; ++v)
+        {
+            partition.node_labels.push_back(graph.get_node_label(v));
+
+            append_adjacency(graph.get_outbound_adjacent(v), graph.get_outbound_edges(v), partition.outbound_nodes, partition.outbound_labels);
+            partition.outbound_offsets.push_back(static_cast<int64_t>(partition.outbound_nodes.size()));
+
+            if (graph.is_directed())
+            {
+                append_adjacency(graph.get_inbound_adjacent(v), graph.get_inbound_edges(v), partition.inbound_nodes, partition.inbound_labels);
+            }
+            partition.inbound_offsets.push_back(static_cast<int64_t>(partition.inbound_nodes.size()));
+        }
+    }
+
+    return partitions;
+}
+
+GraphPartition distribute_graph(Transport& transport, int num_nodes, bool directed, std::vector<int> node_labels, const std::vector<LabeledEdge>& edges)
+{
+    const auto num_workers = transport.get_num_ranks() - 1;
+    const auto worker = transport.get_rank() - 1;
+    if (worker < 0)
+    {
+        throw std::invalid_argument("distribute_graph: the coordinator does not hold a partition");
+    }
+
+    auto partition = GraphPartition();
+    partition.num_nodes = num_nodes;
+    partition.directed = directed;
+    partition.boundaries = get_partition_boundaries(num_nodes, num_workers);
+    partition.worker = worker;
+
+    const auto begin = partition.get_begin();
+    const auto num_owned = partition.get_end() - begin;
+    if (static_cast<int>(node_labels.size()) != num_owned)
+    {
+        throw std::invalid_argument("distribute_graph: node_labels must hold the labels of the owned vertices");
+    }
+    partition.node_labels = std::move(node_labels);
+
+    // Records (node, neighbor, label, kind) for the owner of node. Undirected edges are outbound from both endpoints, as in EdgeColoredGraph.
+    auto messages = std::vector<Message>(num_workers);
+    auto add_record = [&](int node, int neighbor, int label, int kind)
+    {
+        auto& message = messages[get_owner(partition.boundaries, node)];
+        message.insert(message.end(), { node, neighbor, label, kind });
+    };
+
+    for (const auto& edge : edges)
+    {
+        if (edge.source < 0 || edge.source >= num_nodes || edge.target < 0 || edge.target >= num_nodes || edge.label < 0)
+        {
+            throw std::invalid_argument("distribute_graph: invalid edge");
+        }
+        add_record(edge.source, edge.target, edge.label, OUTBOUND);
+        add_record(edge.target, edge.source, edge.label, directed ? INBOUND : OUTBOUND);
+    }
+
+    const auto received = exchange(transport, worker, std::move(messages));
+
+    // Counting sort of the records by owned vertex into CSR arrays
+    auto outbound_counts = std::vector<int64_t>(num_owned + 1, 0);
+    auto inbound_counts = std::vector<int64_t>(num_owned + 1, 0);
+    for (const auto& message : received)
+    {
+        for (size_t i = 0; i < message.size(); i += 4)
+            ++(message[i + 3] == OUTBOUND ? outbound_counts : inbound_counts)[message[i] - begin + 1];
+    }
+    for (int v = 0; v < num_owned; ++v)
+    {
+        outbound_counts[v + 1] += outbound_counts[v];
+        inbound_counts[v + 1] += inbound_counts[v];
+    }
+
+    partition.outbound_offsets = outbound_counts;
+    partition.inbound_offsets = inbound_counts;
+    partition.outbound_nodes.resize(outbound_counts.back());
+    partition.outbound_labels.resize(outbound_counts.back());
+    partition.inbound_nodes.resize(inbound_counts.back());
+    partition.inbound_labels.resize(inbound_counts.back());
+
+    for (const auto& message : received)
+    {
+        for (size_t i = 0; i < message.size(); i += 4)
+        {
+            const auto local_node = message[i] - begin;
+            if (message[i + 3] == OUTBOUND)
+            {
+                const auto position = outbound_counts[local_node]++;
+                partition.outbound_nodes[position] = message[i + 1];
+                partition.outbound_labels[position] = message[i + 2];
+            }
+            else
+            {
+                const auto position = inbound_counts[local_node]++;
+                partition.inbound_nodes[position] = message[i + 1];
+                partition.inbound_labels[position] = message[i + 2];
+            }
+        }
+    }
+
+    return partition;
+}
+
+// -------------------
+// ColorFunctionShard
+// -------------------
+
+ColorFunctionShard::ColorFunctionShard() : m_color_function() {}
+
+Color ColorFunctionShard::find(const NodeColorContext& node_color_context) const
+{
+    auto it = m_color_function.find(node_color_context);
+    return it != m_color_function.end() ? it->second : -1;
+}
+
+void ColorFunctionShard::insert(const NodeColorContext& node_color_context, Color color) { m_color_function.emplace(node_color_context, color); }
+
+size_t ColorFunctionShard::size() const { return m_color_function.size(); }
+
+/// @brief The worker whose shard holds the context. The hash only depends on the context, so all processes agree on it.
+static int get_context_owner(const NodeColorContext& node_color_context, int num_workers)
+{
+    uint64_t hash = static_cast<uint64_t>(std::get<0>(node_color_context));
+    for (const auto& [color, label] : std::get<1>(node_color_context))
+        hash_combine(hash, (static_cast<uint64_t>(static_cast<uint32_t>(color)) << 32) | static_cast<uint32_t>(label));
+    hash_combine(hash, std::get<1>(node_color_context).size());
+    for (const auto& [color, label] : std::get<2>(node_color_context))
+        hash_combine(hash, (static_cast<uint64_t>(static_cast<uint32_t>(color)) << 32) | static_cast<uint32_t>(label));
+    return static_cast<int>(hash % static_cast<uint64_t>(num_workers));
+}
+
+// -----------------------------
+// DistributedWeisfeilerLeman1D
+// -----------------------------
+
+/// @brief Encode a context as [color, #outgoing, (color, label)*, #ingoing, (color, label)*].
+static void encode_context(const NodeColorContext& node_color_context, Message& ref_message)
+{
+    // 1-WL contexts start with a color or a negated node label, which both fit into a message word.
+    ref_message.push_back(static_cast<int>(std::get<0>(node_color_context)));
+    for (const auto* colors : { &std::get<1>(node_color_context), &std::get<2>(node_color_context) })
+    {
+        ref_message.push_back(static_cast<int>(colors->size()));
+        for (const auto& [color, label] : *colors)
+        {
+            ref_message.push_back(color);
+            ref_message.push_back(label);
+        }
+    }
+}
+
+static NodeColorContext decode_context(const Message& message, size_t& ref_position)
+{
+    auto node_color_context = NodeColorContext();
+    std::get<0>(node_color_context) = message.at(ref_position++);
+    for (auto* colors : { &std::get<1>(node_color_context), &std::get<2>(node_color_context) })
+    {
+        const auto num_colors = message.at(ref_position++);
+        colors->reserve(num_colors);
+        for (int i = 0; i < num_colors; ++i)
+        {
+            colors->emplace_back(message.at(ref_position), message.at(ref_position + 1));
+            ref_position += 2;
+        }
+    }
+    return node_color_context;
+}
+
+DistributedWeisfeilerLeman1D::DistributedWeisfeilerLeman1D(bool ignore_counting) : m_num_colors(0), m_ignore_counting(ignore_counting) {}
+
+size_t DistributedWeisfeilerLeman1D::get_coloring_function_size() const { return m_num_colors; }
+
+bool DistributedWeisfeilerLeman1D::get_ignore_counting() const { return m_ignore_counting; }
+
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> DistributedWeisfeilerLeman1D::compute_coloring(Transport& transport, size_t max_num_iterations)
+{
+    if (transport.get_rank() != 0)
+    {
+        throw std::invalid_argument("the coordinator must run on rank 0");
+    }
+
+    const auto num_workers = transport.get_num_ranks() - 1;
+
+    // Receive the number of new contexts and of distinct owned contexts of each worker, send the status and the first new color
+    // of each worker, and return the number of distinct colors of the round.
+    auto color_round = [&](auto&& get_status)
+    {
+        auto num_new_contexts = std::vector<size_t>(num_workers);
+        size_t num_colors = 0;
+        for (int w = 0; w < num_workers; ++w)
+        {
+            const auto message = transport.receive(w + 1);
+            num_new_contexts[w] = static_cast<size_t>(message.at(0));
+            num_colors += static_cast<size_t>(message.at(1));
+        }
+
+        const auto status = get_status(num_colors);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            transport.send(w + 1, Message { status, static_cast<int>(m_num_colors) });
+            m_num_colors += num_new_contexts[w];
+        }
+
+        return num_colors;
+    };
+
+    // Initial coloring
+    auto num_colors = color_round([](size_t) { return STATUS_CONTINUE; });
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
+    {
+        ++num_iterations;
+
+        // Each round refines the previous one, so the coloring is stable iff the number of colors did not change.
+        bool is_stable_i = false;
+        num_colors = color_round(
+            [&](size_t next_num_colors)
+            {
+                is_stable_i = (next_num_colors == num_colors);
+                return (is_stable_i || num_iterations == max_num_iterations) ? STATUS_STOP : STATUS_CONTINUE;
+            });
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
+    }
+
+    // Merge the histograms [#colors, color*, count*] of the workers
+    auto frequencies = std::map<int, int>();
+    for (int w = 0; w < num_workers; ++w)
+    {
+        const auto histogram = transport.receive(w + 1);
+        const auto num_unique = histogram.at(0);
+        for (int i = 0; i < num_unique; ++i)
+            frequencies[histogram.at(1 + i)] += histogram.at(1 + num_unique + i);
+    }
+
+    auto unique = std::vector<int>();
+    auto counts = std::vector<int>();
+    for (const auto& [color, count] : frequencies)
+    {
+        unique.push_back(color);
+        counts.push_back(count);
+    }
+    lexical_sort(unique, counts);
+    return { is_stable, num_iterations, std::move(unique), std::move(counts) };
+}
+
+// -------
+// Worker
+// -------
+
+void run_weisfeiler_leman_1d_worker(Transport& transport, const GraphPartition& partition, bool ignore_counting)
+{
+    auto shard = ColorFunctionShard();
+    run_weisfeiler_leman_1d_worker(transport, partition, shard, ignore_counting);
+}
+
+void run_weisfeiler_leman_1d_worker(Transport& transport, const GraphPartition& partition, ColorFunctionShard& ref_shard, bool ignore_counting)
+{
+    const auto num_workers = static_cast<int>(partition.boundaries.size()) - 1;
+    const auto worker = partition.worker;
+    const auto begin = partition.get_begin();
+    const auto num_owned = partition.get_end() - begin;
+
+    if (transport.get_rank() != worker + 1 || transport.get_num_ranks() != num_workers + 1)
+    {
+        throw std::invalid_argument("the transport does not match the partition");
+    }
+
+    // Ghost vertices grouped by owner. Colors are stored in slots: owned vertices first, then the ghosts of each owner in order.
+    auto ghosts = std::vector<Message>(num_workers);
+    for (const auto* nodes : { &partition.outbound_nodes, &partition.inbound_nodes })
+    {
+        for (const auto& node : *nodes)
+        {
+            const auto owner = get_owner(partition.boundaries, node);
+            if (owner != worker)
+                ghosts[owner].push_back(node);
+        }
+    }
+
+    auto ghost_offsets = std::vector<int>(num_workers + 1, num_owned);
+    for (int w = 0; w < num_workers; ++w)
+    {
+        std::sort(ghosts[w].begin(), ghosts[w].end());
+        ghosts[w].erase(std::unique(ghosts[w].begin(), ghosts[w].end()), ghosts[w].end());
+        ghost_offsets[w + 1] = ghost_offsets[w] + static_cast<int>(ghosts[w].size());
+    }
+
+    auto get_slot = [&](int node)
+    {
+        const auto owner = get_owner(partition.boundaries, node);
+        if (owner == worker)
+            return node - begin;
+        return ghost_offsets[owner] + static_cast<int>(std::lower_bound(ghosts[owner].begin(), ghosts[owner].end(), node) - ghosts[owner].begin());
+    };
+
+    auto outbound_slots = std::vector<int>(partition.outbound_nodes.size());
+    std::transform(partition.outbound_nodes.begin(), partition.outbound_nodes.end(), outbound_slots.begin(), get_slot);
+    auto inbound_slots = std::vector<int>(partition.inbound_nodes.size());
+    std::transform(partition.inbound_nodes.begin(), partition.inbound_nodes.end(), inbound_slots.begin(), get_slot);
+
+    // Tell each owner which of its vertices we need, and learn which of ours the others need
+    auto requests = exchange(transport, worker, ghosts);
+    requests[worker].clear();
+
+    auto colors = std::vector<Color>(ghost_offsets.back());
+
+    auto exchange_ghost_colors = [&]()
+    {
+        auto messages = std::vector<Message>(num_workers);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (const auto& node : requests[w])
+                messages[w].push_back(colors[node - begin]);
+        }
+        const auto received = exchange(transport, worker, std::move(messages));
+        for (int w = 0; w < num_workers; ++w)
+        {
+            if (w != worker)
+                std::copy(received[w].begin(), received[w].end(), colors.begin() + ghost_offsets[w]);
+        }
+    };
+
+    auto get_adjacent_colors = [&](const std::vector<int64_t>& offsets, const std::vector<int>& slots, const std::vector<int>& labels, int local_node)
+    {
+        auto adjacent_colors = std::vector<AdjacentColor>();
+        for (auto i = offsets[local_node]; i < offsets[local_node + 1]; ++i)
+            adjacent_colors.emplace_back(colors[slots[i]], labels[i]);
+        std::sort(adjacent_colors.begin(), adjacent_colors.end());
+        if (ignore_counting)
+            adjacent_colors.erase(std::unique(adjacent_colors.begin(), adjacent_colors.end()), adjacent_colors.end());
+        return adjacent_colors;
+    };
+
+    // Color the owned vertices by their contexts through the shards of all workers, and return whether to stop
+    auto color_round = [&](const std::vector<NodeColorContext>& node_color_contexts)
+    {
+        // 1. Send the distinct contexts, in order of their first vertex, to the workers that own them.
+        auto distinct_contexts = std::map<NodeColorContext, int>();
+        auto context_indices = std::vector<int>(num_owned);
+        auto routed = std::vector<std::vector<int>>(num_workers);  // Indexed by owner. The distinct contexts sent to it, in order
+        auto messages = std::vector<Message>(num_workers);
+        for (int v = 0; v < num_owned; ++v)
+        {
+            auto [it, inserted] = distinct_contexts.emplace(node_color_contexts[v], static_cast<int>(distinct_contexts.size()));
+            if (inserted)
+            {
+                const auto owner = get_context_owner(node_color_contexts[v], num_workers);
+                routed[owner].push_back(it->second);
+                encode_context(node_color_contexts[v], messages[owner]);
+            }
+            context_indices[v] = it->second;
+        }
+        const auto num_distinct = static_cast<int>(distinct_contexts.size());
+        const auto received_contexts = exchange(transport, worker, std::move(messages));
+
+        // 2. As owner, look up the received contexts. A new context is colored by the lowest worker that sent it, whose vertices come first.
+        auto owned_contexts = std::vector<std::vector<NodeColorContext>>(num_workers);
+        auto new_contexts = std::set<NodeColorContext>();
+        auto owned_colors = std::unordered_set<Color>();
+        auto first_new = std::vector<Message>(num_workers);  // Indexed by worker. Positions of the contexts it colors
+        for (int w = 0; w < num_workers; ++w)
+        {
+            size_t position = 0;
+            while (position < received_contexts[w].size())
+            {
+                auto node_color_context = decode_context(received_contexts[w], position);
+                const auto color = ref_shard.find(node_color_context);
+                if (color >= 0)
+                    owned_colors.insert(color);
+                else if (new_contexts.insert(node_color_context).second)
+                    first_new[w].push_back(static_cast<int>(owned_contexts[w].size()));
+                owned_contexts[w].push_back(std::move(node_color_context));
+            }
+        }
+        const auto num_owned_colors = owned_colors.size() + new_contexts.size();
+        const auto colored_positions = exchange(transport, worker, first_new);  // Indexed by owner. Positions in routed of the contexts we color
+
+        // 3. The coordinator turns the number of new contexts of each worker into the first color of its new contexts.
+        auto is_new = std::vector<bool>(num_distinct, false);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (const auto& position : colored_positions[w])
+                is_new[routed[w].at(position)] = true;
+        }
+        transport.send(0, Message { static_cast<int>(std::count(is_new.begin(), is_new.end(), true)), static_cast<int>(num_owned_colors) });
+        const auto reply = transport.receive(0);
+
+        auto distinct_colors = std::vector<Color>(num_distinct, -1);
+        auto next_color = reply.at(1);
+        for (int i = 0; i < num_distinct; ++i)
+        {
+            if (is_new[i])
+                distinct_colors[i] = next_color++;
+        }
+
+        // 4. Send the new colors to the owners, which insert them and return the colors of all contexts.
+        messages = std::vector<Message>(num_workers);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (const auto& position : colored_positions[w])
+                messages[w].push_back(distinct_colors[routed[w][position]]);
+        }
+        const auto new_colors = exchange(transport, worker, std::move(messages));
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (size_t k = 0; k < new_colors[w].size(); ++k)
+                ref_shard.insert(owned_contexts[w][first_new[w].at(k)], new_colors[w][k]);
+        }
+
+        messages = std::vector<Message>(num_workers);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (const auto& node_color_context : owned_contexts[w])
+                messages[w].push_back(ref_shard.find(node_color_context));
+        }
+        const auto replies = exchange(transport, worker, std::move(messages));
+        for (int w = 0; w < num_workers; ++w)
+        {
+            for (size_t k = 0; k < replies[w].size(); ++k)
+                distinct_colors[routed[w][k]] = replies[w][k];
+        }
+
+        for (int v = 0; v < num_owned; ++v)
+            colors[v] = distinct_colors[context_indices[v]];
+        return reply.at(0) == STATUS_STOP;
+    };
+
+    auto node_color_contexts = std::vector<NodeColorContext>(num_owned);
+
+    // Both graph labels and colors are natural numbers.
+    // We make the graph labels negative so that they are not confused with colors.
+    for (int v = 0; v < num_owned; ++v)
+        node_color_contexts[v] = NodeColorContext { -partition.node_labels[v] - 1, {}, {} };
+
+    bool stop = color_round(node_color_contexts);
+
+    while (!stop)
+    {
+        exchange_ghost_colors();
+
+        for (int v = 0; v < num_owned; ++v)
+        {
+            node_color_contexts[v] = NodeColorContext { colors[v],
+                                                        get_adjacent_colors(partition.outbound_offsets, outbound_slots, partition.outbound_labels, v),
+                                                        partition.directed ?
+                                                            get_adjacent_colors(partition.inbound_offsets, inbound_slots, partition.inbound_labels, v) :
+                                                            std::vector<AdjacentColor>() };
+        }
+
+        stop = color_round(node_color_contexts);
+    }
+
+    // Send the histogram [#colors, color*, count*] of the owned vertices
+    auto frequencies = std::map<int, int>();
+    for (int v = 0; v < num_owned; ++v)
+        ++frequencies[colors[v]];
+    auto histogram = Message { static_cast<int>(frequencies.size()) };
+    for (const auto& [color, count] : frequencies)
+        histogram.push_back(color);
+    for (const auto& [color, count] : frequencies)
+        histogram.push_back(count);
+    transport.send(0, histogram);
+}
+
+}
@@ -1,5 +1,9 @@
 #include "wl/details/edge_colored_graph.hpp"
 
+#include "wl/details/kernels.hpp"
+#include "wl/details/utils.hpp"
+
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -38,19 +42,9 @@ int EdgeColoredGraph::add_node(int label)
     m_ingoing_adjacent.emplace_back();
     m_node_labels.emplace_back(label);
 
-    auto& outgoing_adjacent_between = m_outgoing_edges_between.emplace_back();
-    auto& ingoing_adjacent_between = m_ingoing_edges_between.emplace_back();
-
-    for (int other_node = 0; other_node < node; ++other_node)
-    {
-        m_outgoing_edges_between.at(other_node).emplace(node, std::vector<int>());
-        m_ingoing_edges_between.at(other_node).emplace(node, std::vector<int>());
-        outgoing_adjacent_between.emplace(other_node, std::vector<int>());
-        ingoing_adjacent_between.emplace(other_node, std::vector<int>());
-    }
-
-    outgoing_adjacent_between.emplace(node, std::vector<int>());
-    ingoing_adjacent_between.emplace(node, std::vector<int>());
+    // The edges between two nodes are only stored for adjacent nodes, so adding a node takes constant time.
+    m_outgoing_edges_between.emplace_back();
+    m_ingoing_edges_between.emplace_back();
 
     return node;
 }
@@ -61,55 +55,100 @@ void EdgeColoredGraph::add_edge(int src_node, int dst_node, int label)
     {
         throw std::invalid_argument("label must be non-negative");
     }
-
     {  // Add src_node -> dst_node
-        int edge = get_num_edges();
+        const auto edge = get_num_edges();
         m_outgoing_edges.at(src_node).emplace_back(edge);
         m_ingoing_edges.at(dst_node).emplace_back(edge);
         m_outgoing_adjacent.at(src_node).emplace_back(dst_node);
         m_ingoing_adjacent.at(dst_node).emplace_back(src_node);
-        m_outgoing_edges_between.at(src_node).at(dst_node).emplace_back(edge);
-        m_ingoing_edges_between.at(dst_node).at(src_node).emplace_back(edge);
+        m_outgoing_edges_between.at(src_node)[dst_node].emplace_back(edge);
+        m_ingoing_edges_between.at(dst_node)[src_node].emplace_back(edge);
         m_edge_labels.emplace_back(label);
     }
 
     if (!m_directed)  // Add dst_node -> src_node
     {
-        int edge = get_num_edges();
+        const auto edge = get_num_edges();
         m_outgoing_edges.at(dst_node).emplace_back(edge);
         m_ingoing_edges.at(src_node).emplace_back(edge);
         m_outgoing_adjacent.at(dst_node).emplace_back(src_node);
         m_ingoing_adjacent.at(src_node).emplace_back(dst_node);
-        m_outgoing_edges_between.at(dst_node).at(src_node).emplace_back(edge);
-        m_ingoing_edges_between.at(src_node).at(dst_node).emplace_back(edge);
+        m_outgoing_edges_between.at(dst_node)[src_node].emplace_back(edge);
+        m_ingoing_edges_between.at(src_node)[dst_node].emplace_back(edge);
         m_edge_labels.emplace_back(label);
     }
 }
 
-const std::vector<int>& EdgeColoredGraph::get_outbound_edges(int node) const { return m_outgoing_edges.at(node); }
+const std::vector<EdgeId>& EdgeColoredGraph::get_outbound_edges(int node) const { return m_outgoing_edges.at(node); }
 
-const std::vector<int>& EdgeColoredGraph::get_inbound_edges(int node) const { return m_ingoing_edges.at(node); }
+const std::vector<EdgeId>& EdgeColoredGraph::get_inbound_edges(int node) const { return m_ingoing_edges.at(node); }
 
 const std::vector<int>& EdgeColoredGraph::get_outbound_adjacent(int node) const { return m_outgoing_adjacent.at(node); }
 
 const std::vector<int>& EdgeColoredGraph::get_inbound_adjacent(int node) const { return m_ingoing_adjacent.at(node); }
 
+LabeledNeighborSpan EdgeColoredGraph::get_outbound_neighbors(int node) const
+{
+    const auto& adjacent = m_outgoing_adjacent.at(node);
+    return LabeledNeighborSpan(adjacent.data(), m_outgoing_edges[node].data(), m_edge_labels.data(), adjacent.size());
+}
+
+LabeledNeighborSpan EdgeColoredGraph::get_inbound_neighbors(int node) const
+{
+    const auto& adjacent = m_ingoing_adjacent.at(node);
+    return LabeledNeighborSpan(adjacent.data(), m_ingoing_edges[node].data(), m_edge_labels.data(), adjacent.size());
+}
+
 int EdgeColoredGraph::get_num_nodes() const { return static_cast<int>(m_node_labels.size()); }
 
-int EdgeColoredGraph::get_num_edges() const { return static_cast<int>(m_edge_labels.size()); }
+EdgeId EdgeColoredGraph::get_num_edges() const { return static_cast<EdgeId>(m_edge_labels.size()); }
 
 int EdgeColoredGraph::get_node_label(int node) const { return m_node_labels.at(node); }
 
-int EdgeColoredGraph::get_edge_label(int edge) const { return m_edge_labels.at(edge); }
+int EdgeColoredGraph::get_edge_label(EdgeId edge) const { return m_edge_labels.at(edge); }
 
 const std::vector<int>& EdgeColoredGraph::get_node_labels() const { return m_node_labels; }
 
 const std::vector<int>& EdgeColoredGraph::get_edge_labels() const { return m_edge_labels; }
 
-const std::vector<int>& EdgeColoredGraph::get_edges(int src_node, int dst_node) const { return m_outgoing_edges_between.at(src_node).at(dst_node); }
+const std::vector<EdgeId>& EdgeColoredGraph::get_edges(int src_node, int dst_node) const
+{
+    static const std::vector<EdgeId> no_edges;
+
+    const auto& edges_between = m_outgoing_edges_between.at(src_node);
+    if (dst_node < 0 || dst_node >= get_num_nodes())
+    {
+        throw std::out_of_range("dst_node out of range");
+    }
+    auto it = edges_between.find(dst_node);
+    return it != edges_between.end() ? it->second : no_edges;
+}
 
 bool EdgeColoredGraph::is_directed() const { return m_directed; }
 
+uint64_t EdgeColoredGraph::get_content_hash() const
+{
+    uint64_t hash = m_directed ? 1 : 0;
+    hash_combine(hash, m_node_labels.size());
+    hash_combine(hash, m_edge_labels.size());
+
+    for (int node = 0; node < get_num_nodes(); ++node)
+    {
+        hash_combine(hash, static_cast<uint32_t>(m_node_labels[node]));
+
+        const auto& adjacent = m_outgoing_adjacent[node];
+        const auto& edges = m_outgoing_edges[node];
+        hash_combine(hash, adjacent.size());
+        for (size_t k = 0; k < adjacent.size(); ++k)
+        {
+            hash_combine(hash, static_cast<uint32_t>(adjacent[k]));
+            hash_combine(hash, static_cast<uint32_t>(m_edge_labels[edges[k]]));
+        }
+    }
+
+    return hash;
+}
+
 std::string EdgeColoredGraph::to_string() const
 {
     std::stringstream ss;
@@ -123,40 +162,50 @@ std::string EdgeColoredGraph::to_string() const
 
 std::pair<std::vector<int>, std::vector<int>> GraphColoring::get_frequencies() const
 {
-    std::unordered_map<int, int> frequencies;
-
-    for (int item : colorings)
-    {
-        frequencies[item]++;
-    }
-
     std::vector<int> unique;
     std::vector<int> counts;
-
-    for (const auto& [item, count] : frequencies)
-    {
-        unique.push_back(item);
-        counts.push_back(count);
-    }
+    count_colors(colorings, unique, counts);
 
     return { unique, counts };
 }
 
 bool GraphColoring::is_identical_to(const GraphColoring& other) const
 {
-    bool fixpoint = true;
-    auto coloring_difference = other.colorings[0] - colorings[0];
+    if (colorings.size() != other.colorings.size())
+    {
+        return false;
+    }
+
+    if (colorings.empty())
+    {
+        return true;
+    }
+
+    // Fast path: a single engine running alone assigns fresh colors in the order of first occurrence,
+    // so identical partitions usually differ by a constant offset.
+    const auto coloring_difference = static_cast<int>(static_cast<uint32_t>(other.colorings[0]) - static_cast<uint32_t>(colorings[0]));
 
-    for (size_t i = 0; i < other.colorings.size(); ++i)
+    if (is_shifted_copy(colorings.data(), other.colorings.data(), colorings.size(), coloring_difference))
     {
-        if ((colorings[i] + coloring_difference) != other.colorings[i])
+        return true;
+    }
+
+    // Engines sharing a color function interleave their fresh colors, so compare the induced partitions instead.
+    std::unordered_map<int, int> forward;
+    std::unordered_map<int, int> backward;
+
+    for (size_t i = 0; i < colorings.size(); ++i)
+    {
+        auto [forward_it, forward_inserted] = forward.emplace(colorings[i], other.colorings[i]);
+        auto [backward_it, backward_inserted] = backward.emplace(other.colorings[i], colorings[i]);
+
+        if (forward_it->second != other.colorings[i] || backward_it->second != colorings[i])
         {
-            fixpoint = false;
-            break;
+            return false;
         }
     }
 
-    return fixpoint;
+    return true;
 }
 
 }
@@ -0,0 +1,487 @@
+#include "wl/details/graph_io.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wl
+{
+
+// -----------
+// MappedFile
+// -----------
+
+MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0), m_mapped(false), m_buffer()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void* data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            ::madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(data);
+            m_size = static_cast<size_t>(status.st_size);
+            m_mapped = true;
+        }
+    }
+    ::close(fd);
+
+    if (m_mapped || (::stat(path.c_str(), &status) == 0 && status.st_size == 0))
+    {
+        return;
+    }
+#endif
+
+    // Fall back to reading the file, e.g., for pipes or on platforms without mmap
+    auto stream = std::ifstream(path, std::ios::binary);
+    if (!stream)
+    {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (m_mapped)
+    {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+}
+
+std::string_view MappedFile::get_view() const { return std::string_view(m_data, m_size); }
+
+// --------
+// Parsing
+// --------
+
+/// @brief Split the text into at most num_chunks chunks that end at line boundaries.
+static std::vector<std::string_view> split_lines(std::string_view text, size_t num_chunks)
+{
+    if (num_chunks == 0)
+    {
+        num_chunks = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    auto chunks = std::vector<std::string_view>();
+    size_t begin = 0;
+    for (size_t i = 1; i <= num_chunks && begin < text.size(); ++i)
+    {
+        auto end = (i == num_chunks) ? text.size() : std::max(begin, text.size() * i / num_chunks);
+        end = text.find('\n', end);
+        end = (end == std::string_view::npos) ? text.size() : end + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+/// @brief Run f on every chunk in its own thread and return the results in chunk order.
+template<typename F>
+static auto parse_chunks(const std::vector<std::string_view>& chunks, F&& f)
+{
+    auto results = std::vector<decltype(f(std::string_view()))>(chunks.size());
+    if (chunks.size() == 1)
+    {
+        results[0] = f(chunks[0]);
+        return results;
+    }
+
+    auto threads = std::vector<std::thread>();
+    auto errors = std::vector<std::exception_ptr>(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                try
+                {
+                    results[i] = f(chunks[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+    return results;
+}
+
+/// @brief Call f with every line of the text, without the line break.
+template<typename F>
+static void for_each_line(std::string_view text, F&& f)
+{
+    size_t begin = 0;
+    while (begin < text.size())
+    {
+        auto end = text.find('\n', begin);
+        if (end == std::string_view::npos)
+            end = text.size();
+        auto line = text.substr(begin, end - begin);
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        f(line);
+        begin = end + 1;
+    }
+}
+
+/// @brief Parse the whitespace separated integers of a line into values. Return the number of integers.
+static size_t parse_integers(std::string_view line, int* values, size_t max_num_values)
+{
+    size_t num_values = 0;
+    const char* it = line.data();
+    const char* end = line.data() + line.size();
+    while (it < end && num_values < max_num_values)
+    {
+        while (it < end && (*it == ' ' || *it == '\t'))
+            ++it;
+        if (it == end)
+            break;
+        auto [next, error] = std::from_chars(it, end, values[num_values]);
+        if (error != std::errc())
+        {
+            throw std::runtime_error("invalid integer in line: " + std::string(line));
+        }
+        it = next;
+        ++num_values;
+    }
+    return num_values;
+}
+
+/// @brief Edges and node labels of a chunk.
+struct ParsedLines
+{
+    std::vector<std::tuple<int, int, int>> edges;
+    std::vector<std::pair<int, int>> node_labels;
+    int num_nodes = -1;  // Declared number of nodes, if any
+};
+
+static EdgeColoredGraph build_graph(std::vector<ParsedLines>&& chunks, bool directed, int num_nodes)
+{
+    // Vertices are 0-based here. The largest int is rejected as well, so that the number of nodes v + 1 fits.
+    auto check_node = [](int v)
+    {
+        if (v < 0 || v == std::numeric_limits<int>::max())
+            throw std::runtime_error("vertex out of range: " + std::to_string(v));
+    };
+
+    for (const auto& chunk : chunks)
+    {
+        num_nodes = std::max(num_nodes, chunk.num_nodes);
+        for (const auto& [u, v, label] : chunk.edges)
+        {
+            check_node(u);
+            check_node(v);
+            num_nodes = std::max({ num_nodes, u + 1, v + 1 });
+        }
+        for (const auto& [v, label] : chunk.node_labels)
+        {
+            check_node(v);
+            num_nodes = std::max(num_nodes, v + 1);
+        }
+    }
+
+    auto labels = std::vector<int>(std::max(num_nodes, 0), 0);
+    for (const auto& chunk : chunks)
+    {
+        for (const auto& [v, label] : chunk.node_labels)
+            labels[v] = label;
+    }
+
+    auto graph = EdgeColoredGraph(directed);
+    for (const auto& label : labels)
+    {
+        graph.add_node(label);
+    }
+    for (const auto& chunk : chunks)
+    {
+        for (const auto& [u, v, label] : chunk.edges)
+        {
+            graph.add_edge(u, v, label);
+        }
+    }
+    return graph;
+}
+
+static ParsedLines parse_dimacs_lines(std::string_view text)
+{
+    auto parsed = ParsedLines();
+    for_each_line(text,
+                  [&](std::string_view line)
+                  {
+                      int values[3] = { 0, 0, 0 };
+                      if (line.empty())
+                          return;
+
+                      switch (line.front())
+                      {
+                          case 'e':
+                              // Vertices are 1-based, so smaller values would underflow when shifted
+                              if (parse_integers(line.substr(1), values, 3) < 2 || values[0] < 1 || values[1] < 1)
+                                  throw std::runtime_error("invalid edge line: " + std::string(line));
+                              parsed.edges.emplace_back(values[0] - 1, values[1] - 1, values[2]);
+                              break;
+                          case 'n':
+                              if (parse_integers(line.substr(1), values, 2) < 2 || values[0] < 1)
+                                  throw std::runtime_error("invalid node line: " + std::string(line));
+                              parsed.node_labels.emplace_back(values[0] - 1, values[1]);
+                              break;
+                          case 'p':
+                          {
+                              // "p <format> <num_nodes> <num_edges>"
+                              auto position = line.find_first_of("0123456789");
+                              if (position == std::string_view::npos || parse_integers(line.substr(position), values, 2) < 1)
+                                  throw std::runtime_error("invalid problem line: " + std::string(line));
+                              parsed.num_nodes = values[0];
+                              break;
+                          }
+                          default:  // Comments and unknown lines
+                              break;
+                      }
+                  });
+    return parsed;
+}
+
+static ParsedLines parse_edge_list_lines(std::string_view text)
+{
+    auto parsed = ParsedLines();
+    for_each_line(text,
+                  [&](std::string_view line)
+                  {
+                      int values[3] = { 0, 0, 0 };
+                      if (line.empty() || line.front() == '#' || line.front() == '%')
+                          return;
+
+                      if (line.front() == 'n')
+                      {
+                          if (parse_integers(line.substr(1), values, 2) < 2)
+                              throw std::runtime_error("invalid node line: " + std::string(line));
+                          parsed.node_labels.emplace_back(values[0], values[1]);
+                          return;
+                      }
+
+                      const auto num_values = parse_integers(line, values, 3);
+                      if (num_values == 1)
+                          throw std::runtime_error("invalid edge line: " + std::string(line));
+                      if (num_values >= 2)
+                          parsed.edges.emplace_back(values[0], values[1], values[2]);
+                  });
+    return parsed;
+}
+
+EdgeColoredGraph read_dimacs(const std::string& path, bool directed, size_t num_threads)
+{
+    const auto file = MappedFile(path);
+    return build_graph(parse_chunks(split_lines(file.get_view(), num_threads), parse_dimacs_lines), directed, 0);
+}
+
+EdgeColoredGraph read_edge_list(const std::string& path, bool directed, size_t num_threads)
+{
+    const auto file = MappedFile(path);
+    return build_graph(parse_chunks(split_lines(file.get_view(), num_threads), parse_edge_list_lines), directed, 0);
+}
+
+/// @brief Reader of the 6-bit big-endian groups of graph6 and sparse6.
+class SixBitReader
+{
+private:
+    std::string_view m_text;
+    size_t m_position;  // Index of the next bit
+
+public:
+    explicit SixBitReader(std::string_view text) : m_text(text), m_position(0) {}
+
+    size_t get_num_remaining_bits() const { return 6 * m_text.size() - m_position; }
+
+    int read_bit()
+    {
+        const auto byte = m_text[m_position / 6] - 63;
+        if (byte < 0 || byte > 63)
+        {
+            throw std::runtime_error("invalid graph6 character");
+        }
+        const auto bit = (byte >> (5 - m_position % 6)) & 1;
+        ++m_position;
+        return bit;
+    }
+
+    uint64_t read_bits(int num_bits)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < num_bits; ++i)
+            value = (value << 1) | static_cast<uint64_t>(read_bit());
+        return value;
+    }
+};
+
+/// @brief Parse the number of vertices N(n) and remove it from the text.
+static int parse_graph6_size(std::string_view& text)
+{
+    auto read_groups = [&](size_t offset, size_t num_groups)
+    {
+        if (text.size() < offset + num_groups)
+        {
+            throw std::runtime_error("truncated graph6 size");
+        }
+        auto reader = SixBitReader(text.substr(offset, num_groups));
+        const auto n = reader.read_bits(static_cast<int>(6 * num_groups));
+        text.remove_prefix(offset + num_groups);
+        return n;
+    };
+
+    if (text.empty())
+    {
+        throw std::runtime_error("empty graph6 string");
+    }
+    if (text[0] != 126)
+        return static_cast<int>(read_groups(0, 1));
+    if (text.size() > 1 && text[1] != 126)
+        return static_cast<int>(read_groups(1, 3));
+    const auto n = read_groups(2, 6);
+    if (n > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+    {
+        throw std::runtime_error("graph6 graph too large");
+    }
+    return static_cast<int>(n);
+}
+
+EdgeColoredGraph parse_graph6(std::string_view line)
+{
+    const bool sparse = !line.empty() && line.front() == ':';
+    if (sparse)
+    {
+        line.remove_prefix(1);
+    }
+
+    const auto n = parse_graph6_size(line);
+    auto graph = EdgeColoredGraph(false);
+    for (int v = 0; v < n; ++v)
+    {
+        graph.add_node();
+    }
+
+    auto reader = SixBitReader(line);
+
+    if (!sparse)
+    {
+        // Upper triangle of the adjacency matrix, column by column
+        if (reader.get_num_remaining_bits() < static_cast<size_t>(n) * (n - 1) / 2)
+        {
+            throw std::runtime_error("truncated graph6 string");
+        }
+        for (int j = 1; j < n; ++j)
+        {
+            for (int i = 0; i < j; ++i)
+            {
+                if (reader.read_bit())
+                    graph.add_edge(i, j);
+            }
+        }
+        return graph;
+    }
+
+    // Sequence of (b, x) with a 1-bit b and a k-bit x. b = 1 advances the current vertex v, x > v jumps to x, and x <= v is the edge {x, v}.
+    int k = 1;
+    while ((int64_t(1) << k) < n)
+        ++k;
+    int64_t v = 0;
+    while (reader.get_num_remaining_bits() >= static_cast<size_t>(1 + k))
+    {
+        const auto b = reader.read_bit();
+        const auto x = static_cast<int64_t>(reader.read_bits(k));
+        if (b == 1)
+            ++v;
+        if (x >= n || v >= n)
+            break;
+        if (x > v)
+            v = x;
+        else
+            graph.add_edge(static_cast<int>(x), static_cast<int>(v));
+    }
+    return graph;
+}
+
+static std::vector<EdgeColoredGraph> parse_graph6_lines(std::string_view text)
+{
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for_each_line(text,
+                  [&](std::string_view line)
+                  {
+                      // Optional headers
+                      for (const auto header : { std::string_view(">>graph6<<"), std::string_view(">>sparse6<<") })
+                      {
+                          if (line.substr(0, header.size()) == header)
+                              line.remove_prefix(header.size());
+                      }
+                      if (!line.empty())
+                          graphs.push_back(parse_graph6(line));
+                  });
+    return graphs;
+}
+
+std::vector<EdgeColoredGraph> read_graph6(const std::string& path, size_t num_threads)
+{
+    const auto file = MappedFile(path);
+
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for (auto& chunk : parse_chunks(split_lines(file.get_view(), num_threads), parse_graph6_lines))
+    {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(graphs));
+    }
+    return graphs;
+}
+
+std::vector<EdgeColoredGraph> read_graphs(const std::string& path, bool directed, size_t num_threads)
+{
+    const auto extension = std::filesystem::path(path).extension().string();
+
+    if (extension == ".g6" || extension == ".s6")
+    {
+        return read_graph6(path, num_threads);
+    }
+
+    auto graphs = std::vector<EdgeColoredGraph>();
+    if (extension == ".dimacs" || extension == ".col" || extension == ".clq")
+        graphs.push_back(read_dimacs(path, directed, num_threads));
+    else
+        graphs.push_back(read_edge_list(path, directed, num_threads));
+    return graphs;
+}
+
+}
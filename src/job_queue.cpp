@@ -0,0 +1,59 @@
+#include "wl/details/job_queue.hpp"
+
+#include "wl/details/canonical_color_refinement.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace wl
+{
+
+JobQueue::JobQueue(std::shared_ptr<ThreadPool> pool, int min_num_nodes_to_split) : m_pool(std::move(pool)), m_min_num_nodes_to_split(min_num_nodes_to_split)
+{
+    if (!m_pool)
+    {
+        throw std::invalid_argument("pool must not be null");
+    }
+}
+
+const std::shared_ptr<ThreadPool>& JobQueue::get_pool() const { return m_pool; }
+
+int JobQueue::get_min_num_nodes_to_split() const { return m_min_num_nodes_to_split; }
+
+std::future<ColoringResult> JobQueue::submit_coloring(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations)
+{
+    auto pool = m_pool.get();
+    auto split = graph.get_num_nodes() >= m_min_num_nodes_to_split;
+
+    return m_pool->submit(
+        [&engine, &graph, pool, split, max_num_iterations]()
+        {
+            if (split)
+                return engine.compute_coloring_parallel(graph, *pool, max_num_iterations);
+            return engine.compute_coloring(graph, max_num_iterations);
+        });
+}
+
+std::future<RefinementResult> JobQueue::submit_refinement(const EdgeColoredGraph& graph)
+{
+    auto pool = m_pool.get();
+    auto split = graph.get_num_nodes() >= m_min_num_nodes_to_split;
+
+    return m_pool->submit(
+        [&graph, pool, split]()
+        {
+            if (split)
+            {
+                // While waiting for its sub-tasks, the worker may run other refinements, so the workspace cannot be thread-local.
+                auto color_refinement = CanonicalColorRefinement();
+                color_refinement.calculate_parallel(graph, *pool, true);
+                return RefinementResult { color_refinement.get_coloring(), color_refinement.get_quotient_matrix() };
+            }
+
+            thread_local auto color_refinement = CanonicalColorRefinement();
+            color_refinement.calculate(graph, true);
+            return RefinementResult { color_refinement.get_coloring(), color_refinement.get_quotient_matrix() };
+        });
+}
+
+}
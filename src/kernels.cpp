@@ -0,0 +1,163 @@
+#include "wl/details/kernels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Every function with WL_TARGET_CLONES is compiled once per target, and an ifunc resolver picks one at load time.
+#if defined(WL_USE_TARGET_CLONES)
+#define WL_TARGET_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define WL_TARGET_CLONES
+#endif
+
+namespace wl
+{
+
+// Vectors of at least that many adjacent colors are sorted as packed 64-bit keys
+static constexpr size_t MIN_PACKED_SORT_SIZE = 64;
+
+// Color ranges up to that many times the number of colors are counted in an array instead of a hash map
+static constexpr int64_t MAX_DENSE_RANGE_FACTOR = 4;
+
+// Colors are compared in blocks of that size, so that the inner loop has no early exit and vectorizes
+static constexpr size_t COMPARE_BLOCK_SIZE = 1024;
+
+/// @brief Map a pair to a key whose unsigned order is the lexicographic order of the pair.
+static inline uint64_t pack(const AdjacentColor& color)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(color.first) ^ 0x80000000u) << 32) | (static_cast<uint32_t>(color.second) ^ 0x80000000u);
+}
+
+static inline AdjacentColor unpack(uint64_t key)
+{
+    return { static_cast<int>(static_cast<uint32_t>(key >> 32) ^ 0x80000000u), static_cast<int>(static_cast<uint32_t>(key) ^ 0x80000000u) };
+}
+
+WL_TARGET_CLONES
+void sort_adjacent_colors(std::vector<AdjacentColor>& ref_colors)
+{
+    if (ref_colors.size() < MIN_PACKED_SORT_SIZE)
+    {
+        std::sort(ref_colors.begin(), ref_colors.end());
+        return;
+    }
+
+    // One comparison per key instead of two per pair, and the packing loops vectorize.
+    thread_local auto keys = std::vector<uint64_t>();
+    keys.resize(ref_colors.size());
+    for (size_t i = 0; i < ref_colors.size(); ++i)
+        keys[i] = pack(ref_colors[i]);
+
+    std::sort(keys.begin(), keys.end());
+
+    for (size_t i = 0; i < ref_colors.size(); ++i)
+        ref_colors[i] = unpack(keys[i]);
+}
+
+WL_TARGET_CLONES
+bool is_shifted_copy(const int* first, const int* second, size_t size, int offset)
+{
+    const auto shift = static_cast<uint32_t>(offset);
+
+    for (size_t begin = 0; begin < size; begin += COMPARE_BLOCK_SIZE)
+    {
+        const auto end = std::min(size, begin + COMPARE_BLOCK_SIZE);
+
+        uint32_t mismatch = 0;
+        for (size_t i = begin; i < end; ++i)
+            mismatch |= (static_cast<uint32_t>(first[i]) + shift) ^ static_cast<uint32_t>(second[i]);
+
+        if (mismatch != 0)
+            return false;
+    }
+    return true;
+}
+
+WL_TARGET_CLONES
+void count_colors(const std::vector<int>& colors, std::vector<int>& ref_unique, std::vector<int>& ref_counts)
+{
+    ref_unique.clear();
+    ref_counts.clear();
+
+    if (colors.empty())
+        return;
+
+    auto min_color = std::numeric_limits<int>::max();
+    auto max_color = std::numeric_limits<int>::min();
+    for (const auto color : colors)
+    {
+        min_color = std::min(min_color, color);
+        max_color = std::max(max_color, color);
+    }
+
+    const auto range = static_cast<int64_t>(max_color) - min_color + 1;
+    if (range <= MAX_DENSE_RANGE_FACTOR * static_cast<int64_t>(colors.size()))
+    {
+        auto counts = std::vector<int>(range, 0);
+        for (const auto color : colors)
+            ++counts[color - min_color];
+
+        for (int64_t i = 0; i < range; ++i)
+        {
+            if (counts[i] > 0)
+            {
+                ref_unique.push_back(static_cast<int>(min_color + i));
+                ref_counts.push_back(counts[i]);
+            }
+        }
+        return;
+    }
+
+    auto frequencies = std::unordered_map<int, int>();
+    for (const auto color : colors)
+        ++frequencies[color];
+
+    for (const auto& [color, count] : frequencies)
+    {
+        ref_unique.push_back(color);
+        ref_counts.push_back(count);
+    }
+}
+
+template<typename T>
+static inline void compose_pair_colors_impl(const T* row, const T* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out)
+{
+    for (size_t k = 0; k < size; ++k)
+        out[k] = { palette[row[k]], palette[column[k * stride]] };
+}
+
+WL_TARGET_CLONES
+void compose_pair_colors(const uint8_t* row, const uint8_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out)
+{
+    compose_pair_colors_impl(row, column, stride, palette, size, out);
+}
+
+WL_TARGET_CLONES
+void compose_pair_colors(const uint16_t* row, const uint16_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out)
+{
+    compose_pair_colors_impl(row, column, stride, palette, size, out);
+}
+
+WL_TARGET_CLONES
+void compose_pair_colors(const uint32_t* row, const uint32_t* column, size_t stride, const Color* palette, size_t size, AdjacentColor* out)
+{
+    compose_pair_colors_impl(row, column, stride, palette, size, out);
+}
+
+std::string get_kernel_target()
+{
+#if defined(WL_USE_TARGET_CLONES)
+    // The same checks in the same order as the resolvers of the clones
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4"))
+        return "x86-64-v4";
+    if (__builtin_cpu_supports("x86-64-v3"))
+        return "x86-64-v3";
+#endif
+    return "default";
+}
+
+}
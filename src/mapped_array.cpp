@@ -0,0 +1,86 @@
+#include "wl/details/mapped_array.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace wl
+{
+
+FileMapping::FileMapping(size_t size, const std::string& directory) : m_data(nullptr), m_size(size)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const auto parent = directory.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(directory);
+    auto path = (parent / "wl_mapping_XXXXXX").string();
+
+    const int fd = ::mkstemp(path.data());
+    if (fd < 0)
+    {
+        throw std::runtime_error("FileMapping: cannot create a file in " + parent.string() + ": " + std::strerror(errno));
+    }
+    ::unlink(path.c_str());
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw std::runtime_error("FileMapping: cannot resize " + path + ": " + std::strerror(error));
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const auto error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("FileMapping: cannot map " + path + ": " + std::strerror(error));
+    }
+    m_data = data;
+#else
+    throw std::runtime_error("FileMapping: memory mapped files are not supported on this platform");
+#endif
+}
+
+FileMapping::~FileMapping()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (m_data)
+    {
+        ::munmap(m_data, m_size);
+    }
+#endif
+}
+
+void* FileMapping::data() const { return m_data; }
+
+size_t FileMapping::size() const { return m_size; }
+
+void FileMapping::advise_sequential() const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+#endif
+}
+
+void FileMapping::will_need(size_t offset, size_t length) const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (offset >= m_size)
+        return;
+
+    // madvise needs a page aligned address
+    const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = offset - offset % page_size;
+    const auto end = std::min(m_size, offset + length);
+    ::madvise(static_cast<char*>(m_data) + begin, end - begin, MADV_WILLNEED);
+#endif
+}
+
+}
@@ -0,0 +1,212 @@
+#include "wl/details/min_hash.hpp"
+
+#include "wl/details/utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace wl
+{
+
+// Offset added per bin that an empty bin borrows across, so that borrowed values differ from the original ones.
+static constexpr uint64_t DENSIFICATION_OFFSET = 0x9e3779b97f4a7c15ULL;
+
+// -----
+// MinHashSketch
+// -----
+
+double MinHashSketch::estimate_similarity(const MinHashSketch& other) const
+{
+    if (values.size() != other.values.size())
+    {
+        throw std::invalid_argument("MinHashSketch::estimate_similarity: sketches of different sizes");
+    }
+    if (values.empty())
+    {
+        return 1.0;
+    }
+
+    size_t num_equal = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        num_equal += (values[i] == other.values[i]) ? 1 : 0;
+    }
+    return static_cast<double>(num_equal) / static_cast<double>(values.size());
+}
+
+// -----
+// MinHashSketcher
+// -----
+
+MinHashSketcher::MinHashSketcher(size_t num_hashes, uint64_t seed) : m_num_hashes(num_hashes), m_seed(seed)
+{
+    if (num_hashes == 0 || num_hashes > UINT32_MAX)
+    {
+        throw std::invalid_argument("num_hashes must be in [1, 2^32)");
+    }
+}
+
+size_t MinHashSketcher::get_num_hashes() const { return m_num_hashes; }
+
+uint64_t MinHashSketcher::get_seed() const { return m_seed; }
+
+void MinHashSketcher::add_round(size_t round, const std::vector<int>& colors, std::unordered_map<int, int>& ref_occurrences, std::vector<uint64_t>& ref_bins) const
+{
+    ref_occurrences.clear();
+
+    for (const auto color : colors)
+    {
+        const auto occurrence = ref_occurrences[color]++;
+
+        auto hash = m_seed;
+        hash_combine(hash, round);
+        hash_combine(hash, static_cast<uint32_t>(color));
+        hash_combine(hash, static_cast<uint32_t>(occurrence));
+
+        // The high bits choose the bin, the remixed hash is the value, so that both are independent.
+        const auto bin = static_cast<size_t>(((hash >> 32) * m_num_hashes) >> 32);
+        ref_bins[bin] = std::min(ref_bins[bin], mix64(hash) >> 1);
+    }
+}
+
+MinHashSketch MinHashSketcher::finish(std::vector<uint64_t>&& bins) const
+{
+    // Rotation densification: an empty bin takes the value of the next non-empty bin to the right, plus an offset per bin skipped.
+    // Values of non-empty bins are below 2^63, so borrowed values can only collide with borrowed ones.
+    if (std::all_of(bins.begin(), bins.end(), [](uint64_t value) { return value == EMPTY_BIN; }))
+    {
+        return MinHashSketch { std::move(bins) };
+    }
+
+    auto values = bins;
+    for (size_t i = 0; i < bins.size(); ++i)
+    {
+        if (bins[i] != EMPTY_BIN)
+            continue;
+
+        size_t distance = 1;
+        while (bins[(i + distance) % bins.size()] == EMPTY_BIN)
+        {
+            ++distance;
+        }
+        values[i] = (bins[(i + distance) % bins.size()] + distance * DENSIFICATION_OFFSET) | (uint64_t(1) << 63);
+    }
+    return MinHashSketch { std::move(values) };
+}
+
+MinHashSketch MinHashSketcher::compute_sketch(const std::vector<GraphColoring>& rounds) const
+{
+    auto occurrences = std::unordered_map<int, int>();
+    auto bins = std::vector<uint64_t>(m_num_hashes, EMPTY_BIN);
+
+    for (size_t round = 0; round < rounds.size(); ++round)
+    {
+        add_round(round, rounds[round].colorings, occurrences, bins);
+    }
+
+    return finish(std::move(bins));
+}
+
+std::tuple<bool, size_t, MinHashSketch> MinHashSketcher::compute_sketch(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations) const
+{
+    auto occurrences = std::unordered_map<int, int>();
+    auto bins = std::vector<uint64_t>(m_num_hashes, EMPTY_BIN);
+
+    auto current_coloring = engine.compute_initial_coloring(graph);
+    auto next_coloring = GraphColoring { std::vector<int>(current_coloring.colorings.size()) };
+    add_round(0, current_coloring.colorings, occurrences, bins);
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
+    {
+        ++num_iterations;
+
+        bool is_stable_i = engine.compute_next_coloring(graph, current_coloring, next_coloring);
+
+        std::swap(current_coloring, next_coloring);
+        add_round(num_iterations, current_coloring.colorings, occurrences, bins);
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
+    }
+
+    return { is_stable, num_iterations, finish(std::move(bins)) };
+}
+
+// -----
+// MinHashIndex
+// -----
+
+MinHashIndex::MinHashIndex(size_t num_bands, size_t rows_per_band) :
+    m_num_bands(num_bands),
+    m_rows_per_band(rows_per_band),
+    m_buckets(num_bands),
+    m_size(0)
+{
+    if (num_bands == 0 || rows_per_band == 0)
+    {
+        throw std::invalid_argument("num_bands and rows_per_band must be positive");
+    }
+}
+
+uint64_t MinHashIndex::get_band_hash(const MinHashSketch& sketch, size_t band) const
+{
+    if (sketch.values.size() != m_num_bands * m_rows_per_band)
+    {
+        throw std::invalid_argument("MinHashIndex: the sketch size must be num_bands * rows_per_band");
+    }
+
+    uint64_t hash = band;
+    for (size_t row = 0; row < m_rows_per_band; ++row)
+    {
+        hash_combine(hash, sketch.values[band * m_rows_per_band + row]);
+    }
+    return hash;
+}
+
+size_t MinHashIndex::insert(const MinHashSketch& sketch)
+{
+    const auto id = m_size;
+    for (size_t band = 0; band < m_num_bands; ++band)
+    {
+        m_buckets[band][get_band_hash(sketch, band)].push_back(id);
+    }
+    ++m_size;
+    return id;
+}
+
+std::vector<size_t> MinHashIndex::query(const MinHashSketch& sketch) const
+{
+    auto candidates = std::vector<size_t>();
+    for (size_t band = 0; band < m_num_bands; ++band)
+    {
+        const auto it = m_buckets[band].find(get_band_hash(sketch, band));
+        if (it != m_buckets[band].end())
+        {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+size_t MinHashIndex::size() const { return m_size; }
+
+size_t MinHashIndex::get_num_bands() const { return m_num_bands; }
+
+size_t MinHashIndex::get_rows_per_band() const { return m_rows_per_band; }
+
+}
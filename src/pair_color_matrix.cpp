@@ -0,0 +1,334 @@
+#include "wl/details/pair_color_matrix.hpp"
+
+#include "wl/details/checkpoint.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace wl
+{
+
+template<typename T, typename U>
+static MappedArray<T> convert(const MappedArray<U>& values, bool mapped, const std::string& directory)
+{
+    auto result = MappedArray<T>(values.size(), mapped, directory);
+    std::copy(values.data(), values.data() + values.size(), result.data());
+    return result;
+}
+
+template<typename T>
+static void write_mapped_array(std::ostream& out, const MappedArray<T>& values)
+{
+    write_binary<uint64_t>(out, values.size());
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template<typename T>
+static MappedArray<T> read_mapped_array(std::istream& in, size_t num_entries, bool mapped, const std::string& directory)
+{
+    // The size is checked before allocating, so that a corrupt size cannot create a huge file.
+    if (read_binary<uint64_t>(in) != num_entries)
+    {
+        throw std::runtime_error("PairColorMatrix::read: wrong number of entries");
+    }
+
+    auto values = MappedArray<T>(num_entries, mapped, directory);
+    if (!in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(num_entries * sizeof(T))))
+    {
+        throw std::runtime_error("PairColorMatrix::read: unexpected end of checkpoint");
+    }
+    return values;
+}
+
+PairColorMatrix::PairColorMatrix() : PairColorMatrix(PairColoringOptions()) {}
+
+PairColorMatrix::PairColorMatrix(const PairColoringOptions& options) :
+    m_num_nodes(0),
+    m_layout(options.layout),
+    m_storage(options.storage),
+    m_directory(options.directory),
+    m_local_colors(),
+    m_palette(),
+    m_local_ids(),
+    m_pair_local_ids(),
+    m_transpose()
+{
+}
+
+void PairColorMatrix::reset(int num_nodes, PairColoringLayout layout, size_t min_num_colors)
+{
+    m_num_nodes = num_nodes;
+    m_layout = layout;
+    m_palette.clear();
+    m_local_ids.clear();
+    m_pair_local_ids.clear();
+    m_transpose.clear();
+
+    const auto num_entries = get_num_entries();
+    const auto mapped = m_storage == PairColoringStorage::MAPPED_FILE;
+
+    // Release the previous storage first, so that old and new files do not coexist.
+    m_local_colors = MappedArray<uint8_t>();
+
+    if (min_num_colors <= std::numeric_limits<uint8_t>::max() + size_t(1))
+        m_local_colors = MappedArray<uint8_t>(num_entries, mapped, m_directory);
+    else if (min_num_colors <= std::numeric_limits<uint16_t>::max() + size_t(1))
+        m_local_colors = MappedArray<uint16_t>(num_entries, mapped, m_directory);
+    else
+        m_local_colors = MappedArray<uint32_t>(num_entries, mapped, m_directory);
+    advise_access();
+}
+
+void PairColorMatrix::widen()
+{
+    const auto mapped = m_storage == PairColoringStorage::MAPPED_FILE;
+
+    if (auto local_colors = std::get_if<MappedArray<uint8_t>>(&m_local_colors))
+        m_local_colors = convert<uint16_t>(*local_colors, mapped, m_directory);
+    else if (auto local_colors = std::get_if<MappedArray<uint16_t>>(&m_local_colors))
+        m_local_colors = convert<uint32_t>(*local_colors, mapped, m_directory);
+    else
+        throw std::overflow_error("PairColorMatrix::widen: too many colors");
+    advise_access();
+}
+
+void PairColorMatrix::advise_access() const
+{
+    if (m_layout == PairColoringLayout::FULL)
+        std::visit([](const auto& local_colors) { local_colors.advise_sequential(); }, m_local_colors);
+}
+
+size_t PairColorMatrix::get_max_num_colors() const
+{
+    return std::visit(
+        [](const auto& local_colors)
+        {
+            using T = std::remove_pointer_t<decltype(local_colors.data())>;
+            return static_cast<size_t>(std::numeric_limits<std::remove_const_t<T>>::max()) + 1;
+        },
+        m_local_colors);
+}
+
+uint32_t PairColorMatrix::add_color(Color color)
+{
+    auto [it, inserted] = m_local_ids.emplace(color, static_cast<uint32_t>(m_palette.size()));
+
+    if (inserted)
+    {
+        m_palette.push_back(color);
+        m_transpose.push_back(std::numeric_limits<uint32_t>::max());
+
+        if (m_palette.size() > get_max_num_colors())
+            widen();
+    }
+
+    return it->second;
+}
+
+uint32_t PairColorMatrix::add_color_pair(Color color, Color transposed_color)
+{
+    const auto it = m_pair_local_ids.find({ color, transposed_color });
+    if (it != m_pair_local_ids.end())
+        return it->second;
+
+    const auto local_color = static_cast<uint32_t>(m_palette.size());
+    const auto transposed_local_color = (color == transposed_color) ? local_color : local_color + 1;
+
+    m_palette.push_back(color);
+    m_transpose.push_back(transposed_local_color);
+    m_pair_local_ids.emplace(std::make_pair(color, transposed_color), local_color);
+    if (transposed_local_color != local_color)
+    {
+        m_palette.push_back(transposed_color);
+        m_transpose.push_back(local_color);
+        m_pair_local_ids.emplace(std::make_pair(transposed_color, color), transposed_local_color);
+    }
+
+    while (m_palette.size() > get_max_num_colors())
+        widen();
+
+    return local_color;
+}
+
+void PairColorMatrix::add_transpose(uint32_t local_color, uint32_t transposed_local_color)
+{
+    m_transpose.at(local_color) = transposed_local_color;
+    m_transpose.at(transposed_local_color) = local_color;
+}
+
+void PairColorMatrix::set_row(int i, const std::vector<uint32_t>& local_colors)
+{
+    const auto begin = index_of(i, m_layout == PairColoringLayout::FULL ? 0 : i);
+
+    std::visit(
+        [&](auto& storage)
+        {
+            using T = std::remove_pointer_t<decltype(storage.data())>;
+            for (size_t offset = 0; offset < local_colors.size(); ++offset)
+                storage[begin + offset] = static_cast<T>(local_colors[offset]);
+        },
+        m_local_colors);
+}
+
+int PairColorMatrix::get_num_nodes() const { return m_num_nodes; }
+
+PairColoringLayout PairColorMatrix::get_layout() const { return m_layout; }
+
+size_t PairColorMatrix::get_num_colors() const { return m_palette.size(); }
+
+size_t PairColorMatrix::get_num_entries() const
+{
+    const auto n = static_cast<size_t>(m_num_nodes);
+    return m_layout == PairColoringLayout::FULL ? n * n : n * (n + 1) / 2;
+}
+
+size_t PairColorMatrix::get_bytes_per_entry() const
+{
+    return visit([](const auto* data) { return sizeof(*data); });
+}
+
+PairColoringStorage PairColorMatrix::get_storage() const { return m_storage; }
+
+const std::string& PairColorMatrix::get_directory() const { return m_directory; }
+
+const std::vector<Color>& PairColorMatrix::get_palette() const { return m_palette; }
+
+const std::vector<uint32_t>& PairColorMatrix::get_transpose() const { return m_transpose; }
+
+uint32_t PairColorMatrix::get_local_color(int i, int j) const
+{
+    return visit(
+        [&](const auto* data) -> uint32_t
+        {
+            if (m_layout == PairColoringLayout::FULL || i <= j)
+                return data[index_of(i, j)];
+            return m_transpose[data[index_of(j, i)]];
+        });
+}
+
+void PairColorMatrix::will_need_row(int i) const
+{
+    if (i < 0 || i >= m_num_nodes)
+        return;
+
+    const auto begin = index_of(i, m_layout == PairColoringLayout::FULL ? 0 : i);
+    const auto count = static_cast<size_t>(m_layout == PairColoringLayout::FULL ? m_num_nodes : m_num_nodes - i);
+    std::visit([&](const auto& local_colors) { local_colors.will_need(begin, count); }, m_local_colors);
+}
+
+std::pair<std::vector<int>, std::vector<int>> PairColorMatrix::get_frequencies() const
+{
+    std::vector<int> counts(m_palette.size(), 0);
+
+    visit(
+        [&](const auto* data)
+        {
+            if (m_layout == PairColoringLayout::FULL)
+            {
+                for (size_t index = 0; index < get_num_entries(); ++index)
+                    ++counts[data[index]];
+            }
+            else
+            {
+                for (int i = 0; i < m_num_nodes; ++i)
+                {
+                    ++counts[data[index_of(i, i)]];
+                    for (int j = i + 1; j < m_num_nodes; ++j)
+                    {
+                        const auto local_color = data[index_of(i, j)];
+                        ++counts[local_color];
+                        ++counts[m_transpose[local_color]];
+                    }
+                }
+            }
+        });
+
+    // Local colors of add_color_pair may share their global color.
+    std::vector<int> unique;
+    std::vector<int> nonzero_counts;
+    std::unordered_map<Color, size_t> positions;
+    for (size_t local_color = 0; local_color < counts.size(); ++local_color)
+    {
+        if (counts[local_color] > 0)
+        {
+            auto [it, inserted] = positions.emplace(m_palette[local_color], unique.size());
+            if (inserted)
+            {
+                unique.push_back(m_palette[local_color]);
+                nonzero_counts.push_back(0);
+            }
+            nonzero_counts[it->second] += counts[local_color];
+        }
+    }
+    return { std::move(unique), std::move(nonzero_counts) };
+}
+
+void PairColorMatrix::write(std::ostream& out) const
+{
+    write_binary<int32_t>(out, m_num_nodes);
+    write_binary<uint8_t>(out, static_cast<uint8_t>(m_layout));
+    write_binary_vector(out, m_palette);
+    write_binary_vector(out, m_transpose);
+    write_binary<uint8_t>(out, static_cast<uint8_t>(get_bytes_per_entry()));
+    std::visit([&](const auto& local_colors) { write_mapped_array(out, local_colors); }, m_local_colors);
+}
+
+void PairColorMatrix::read(std::istream& in)
+{
+    const auto num_nodes = read_binary<int32_t>(in);
+    const auto layout = static_cast<PairColoringLayout>(read_binary<uint8_t>(in));
+    if (num_nodes < 0 || (layout != PairColoringLayout::FULL && layout != PairColoringLayout::UPPER_TRIANGLE))
+    {
+        throw std::runtime_error("PairColorMatrix::read: invalid header");
+    }
+
+    auto palette = read_binary_vector<Color>(in);
+    auto transpose = read_binary_vector<uint32_t>(in);
+    if (transpose.size() != palette.size())
+    {
+        throw std::runtime_error("PairColorMatrix::read: transpose does not match the palette");
+    }
+
+    m_num_nodes = num_nodes;
+    m_layout = layout;
+    m_local_colors = MappedArray<uint8_t>();
+
+    const auto num_entries = get_num_entries();
+    const auto mapped = m_storage == PairColoringStorage::MAPPED_FILE;
+    const auto bytes_per_entry = read_binary<uint8_t>(in);
+    if (bytes_per_entry == sizeof(uint8_t))
+        m_local_colors = read_mapped_array<uint8_t>(in, num_entries, mapped, m_directory);
+    else if (bytes_per_entry == sizeof(uint16_t))
+        m_local_colors = read_mapped_array<uint16_t>(in, num_entries, mapped, m_directory);
+    else if (bytes_per_entry == sizeof(uint32_t))
+        m_local_colors = read_mapped_array<uint32_t>(in, num_entries, mapped, m_directory);
+    else
+        throw std::runtime_error("PairColorMatrix::read: invalid entry width");
+    advise_access();
+
+    visit(
+        [&](const auto* data)
+        {
+            for (size_t index = 0; index < get_num_entries(); ++index)
+            {
+                if (data[index] >= palette.size())
+                    throw std::runtime_error("PairColorMatrix::read: local color out of range");
+            }
+        });
+
+    m_palette = std::move(palette);
+    m_transpose = std::move(transpose);
+    m_local_ids.clear();
+    m_pair_local_ids.clear();
+    for (size_t local_color = 0; local_color < m_palette.size(); ++local_color)
+    {
+        m_local_ids.emplace(m_palette[local_color], static_cast<uint32_t>(local_color));
+        if (m_transpose[local_color] < m_palette.size())
+            m_pair_local_ids.emplace(std::make_pair(m_palette[local_color], m_palette[m_transpose[local_color]]), static_cast<uint32_t>(local_color));
+    }
+}
+
+}
@@ -0,0 +1,229 @@
+#include "wl/details/relational_weisfeiler_leman.hpp"
+
+#include "wl/details/utils.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+namespace wl
+{
+
+// Heads of atom contexts lie below all negated object labels, so atoms and objects never share a color.
+static constexpr ContextColor ATOM_CONTEXT_OFFSET = static_cast<ContextColor>(INT_MIN) - 1;
+
+// -----
+// RelationalStructure
+// -----
+
+RelationalStructure::RelationalStructure() : m_object_labels(), m_predicates(), m_argument_offsets(1, 0), m_arguments(), m_occurrences() {}
+
+int RelationalStructure::add_object(int label)
+{
+    if (label < 0)
+    {
+        throw std::invalid_argument("label must be non-negative");
+    }
+
+    int object = get_num_objects();
+    m_object_labels.emplace_back(label);
+    m_occurrences.emplace_back();
+
+    return object;
+}
+
+int RelationalStructure::add_atom(int predicate, const std::vector<int>& arguments)
+{
+    if (predicate < 0)
+    {
+        throw std::invalid_argument("predicate must be non-negative");
+    }
+    for (const auto object : arguments)
+    {
+        if (object < 0 || object >= get_num_objects())
+        {
+            throw std::out_of_range("argument out of range");
+        }
+    }
+
+    int atom = get_num_atoms();
+    m_predicates.emplace_back(predicate);
+    for (int position = 0; position < static_cast<int>(arguments.size()); ++position)
+    {
+        m_arguments.emplace_back(arguments[position]);
+        m_occurrences[arguments[position]].push_back(AtomOccurrence { atom, position });
+    }
+    m_argument_offsets.emplace_back(static_cast<int>(m_arguments.size()));
+
+    return atom;
+}
+
+int RelationalStructure::get_num_objects() const { return static_cast<int>(m_object_labels.size()); }
+
+int RelationalStructure::get_num_atoms() const { return static_cast<int>(m_predicates.size()); }
+
+int RelationalStructure::get_object_label(int object) const { return m_object_labels.at(object); }
+
+const std::vector<int>& RelationalStructure::get_object_labels() const { return m_object_labels; }
+
+int RelationalStructure::get_predicate(int atom) const { return m_predicates.at(atom); }
+
+std::span<const int> RelationalStructure::get_arguments(int atom) const
+{
+    const auto begin = m_argument_offsets.at(atom);
+    return std::span<const int>(m_arguments.data() + begin, m_argument_offsets[atom + 1] - begin);
+}
+
+const std::vector<AtomOccurrence>& RelationalStructure::get_occurrences(int object) const { return m_occurrences.at(object); }
+
+EdgeColoredGraph RelationalStructure::to_graph() const
+{
+    const auto first_predicate_label = m_object_labels.empty() ? 0 : *std::max_element(m_object_labels.begin(), m_object_labels.end()) + 1;
+
+    auto graph = EdgeColoredGraph(false);
+    for (const auto label : m_object_labels)
+    {
+        graph.add_node(label);
+    }
+    for (int atom = 0; atom < get_num_atoms(); ++atom)
+    {
+        const auto node = graph.add_node(first_predicate_label + m_predicates[atom]);
+        const auto arguments = get_arguments(atom);
+        for (int position = 0; position < static_cast<int>(arguments.size()); ++position)
+        {
+            graph.add_edge(arguments[position], node, position);
+        }
+    }
+    return graph;
+}
+
+// -----
+// RelationalWeisfeilerLeman
+// -----
+
+RelationalWeisfeilerLeman::RelationalWeisfeilerLeman(bool ignore_counting, std::shared_ptr<ColorFunction> color_function) :
+    m_color_function(color_function ? std::move(color_function) : std::make_shared<ColorFunction>()),
+    m_ignore_counting(ignore_counting)
+{
+}
+
+bool RelationalWeisfeilerLeman::get_ignore_counting() const { return m_ignore_counting; }
+
+const std::shared_ptr<ColorFunction>& RelationalWeisfeilerLeman::get_color_function() const { return m_color_function; }
+
+size_t RelationalWeisfeilerLeman::get_coloring_function_size() const { return m_color_function->size(); }
+
+Color RelationalWeisfeilerLeman::get_new_color(NodeColorContext&& node_color_context)
+{
+    auto& occurrence_colors = std::get<1>(node_color_context);
+
+    std::sort(occurrence_colors.begin(), occurrence_colors.end());
+
+    if (m_ignore_counting)
+    {
+        auto last = std::unique(occurrence_colors.begin(), occurrence_colors.end());
+        occurrence_colors.erase(last, occurrence_colors.end());
+    }
+
+    return m_color_function->get_or_insert(std::move(node_color_context));
+}
+
+GraphColoring RelationalWeisfeilerLeman::compute_initial_coloring(const RelationalStructure& structure)
+{
+    const int num_objects = structure.get_num_objects();
+    auto current_coloring = std::vector<int>(num_objects);
+
+    for (int object = 0; object < num_objects; ++object)
+    {
+        // Both labels and colors are natural numbers.
+        // We make the labels negative so that they are not confused with colors.
+
+        current_coloring[object] = m_color_function->get_or_insert({ -static_cast<ContextColor>(structure.get_object_label(object)) - 1, {}, {} });
+    }
+
+    return GraphColoring { std::move(current_coloring) };
+}
+
+GraphColoring RelationalWeisfeilerLeman::compute_atom_coloring(const RelationalStructure& structure, const GraphColoring& object_coloring)
+{
+    const int num_atoms = structure.get_num_atoms();
+    auto atom_coloring = std::vector<int>(num_atoms);
+
+    for (int atom = 0; atom < num_atoms; ++atom)
+    {
+        // The arguments are ordered by position, so they are neither sorted nor deduplicated.
+        auto argument_colors = std::vector<AdjacentColor>();
+        const auto arguments = structure.get_arguments(atom);
+        argument_colors.reserve(arguments.size());
+        for (int position = 0; position < static_cast<int>(arguments.size()); ++position)
+        {
+            argument_colors.emplace_back(object_coloring.colorings[arguments[position]], position);
+        }
+
+        atom_coloring[atom] = m_color_function->get_or_insert({ ATOM_CONTEXT_OFFSET - structure.get_predicate(atom), std::move(argument_colors), {} });
+    }
+
+    return GraphColoring { std::move(atom_coloring) };
+}
+
+bool RelationalWeisfeilerLeman::compute_next_coloring(const RelationalStructure& structure,
+                                                      const GraphColoring& current_coloring,
+                                                      GraphColoring& ref_next_coloring)
+{
+    const auto atom_coloring = compute_atom_coloring(structure, current_coloring);
+
+    for (int object = 0; object < structure.get_num_objects(); ++object)
+    {
+        const auto& occurrences = structure.get_occurrences(object);
+
+        auto occurrence_colors = std::vector<AdjacentColor>();
+        occurrence_colors.reserve(occurrences.size());
+        for (const auto& occurrence : occurrences)
+        {
+            occurrence_colors.emplace_back(atom_coloring.colorings[occurrence.atom], occurrence.position);
+        }
+
+        ref_next_coloring.colorings[object] = get_new_color({ current_coloring.colorings[object], std::move(occurrence_colors), {} });
+    }
+
+    return current_coloring.is_identical_to(ref_next_coloring);
+}
+
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> RelationalWeisfeilerLeman::compute_coloring(const RelationalStructure& structure,
+                                                                                                         size_t max_num_iterations)
+{
+    auto current_coloring = compute_initial_coloring(structure);
+    auto next_coloring = GraphColoring { std::vector<int>(current_coloring.colorings.size()) };
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
+    {
+        ++num_iterations;
+
+        bool is_stable_i = compute_next_coloring(structure, current_coloring, next_coloring);
+
+        std::swap(current_coloring, next_coloring);
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
+    }
+
+    const auto atom_coloring = compute_atom_coloring(structure, current_coloring);
+    current_coloring.colorings.insert(current_coloring.colorings.end(), atom_coloring.colorings.begin(), atom_coloring.colorings.end());
+
+    auto [unique, counts] = current_coloring.get_frequencies();
+    lexical_sort(unique, counts);
+    return { is_stable, num_iterations, std::move(unique), std::move(counts) };
+}
+
+}
@@ -0,0 +1,138 @@
+#include "wl/details/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace wl
+{
+
+// The pool and index of the worker that runs on this thread
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local int t_worker_index = -1;
+
+ThreadPool::ThreadPool(size_t num_threads) : m_queues(), m_threads(), m_next_queue(0), m_mutex(), m_condition(), m_num_pending(0), m_stop(false)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::run_worker, this, static_cast<int>(i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+const std::shared_ptr<ThreadPool>& ThreadPool::get_default()
+{
+    static const auto pool = std::make_shared<ThreadPool>();
+    return pool;
+}
+
+size_t ThreadPool::get_num_threads() const { return m_threads.size(); }
+
+int ThreadPool::get_worker_index() const { return t_pool == this ? t_worker_index : -1; }
+
+void ThreadPool::push(std::function<void()>&& task)
+{
+    auto worker_index = get_worker_index();
+    auto& queue = *m_queues[worker_index >= 0 ? worker_index : m_next_queue.fetch_add(1) % m_queues.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_num_pending;
+    }
+    m_condition.notify_one();
+}
+
+bool ThreadPool::pop(int worker_index, std::function<void()>& ref_task)
+{
+    // Own queue first, newest task first
+    if (worker_index >= 0)
+    {
+        auto& queue = *m_queues[worker_index];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            ref_task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --m_num_pending;
+            return true;
+        }
+    }
+
+    // Steal the oldest task of another queue
+    const auto num_queues = m_queues.size();
+    const auto first = static_cast<size_t>(worker_index + 1);
+    for (size_t offset = 0; offset < num_queues; ++offset)
+    {
+        auto& queue = *m_queues[(first + offset) % num_queues];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            ref_task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --m_num_pending;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::run_pending_task()
+{
+    auto task = std::function<void()>();
+    if (!pop(get_worker_index(), task))
+    {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::run_worker(int worker_index)
+{
+    t_pool = this;
+    t_worker_index = worker_index;
+
+    auto task = std::function<void()>();
+    while (true)
+    {
+        if (pop(worker_index, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [&]() { return m_stop || m_num_pending.load() > 0; });
+        if (m_stop && m_num_pending.load() == 0)
+        {
+            break;
+        }
+    }
+}
+
+}
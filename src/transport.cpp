@@ -0,0 +1,187 @@
+#include "wl/details/transport.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace wl
+{
+
+// -----------------
+// InProcessNetwork
+// -----------------
+
+InProcessNetwork::InProcessNetwork(int num_ranks) : m_num_ranks(num_ranks), m_mailboxes()
+{
+    if (num_ranks < 1)
+    {
+        throw std::invalid_argument("num_ranks must be positive");
+    }
+
+    for (int i = 0; i < num_ranks * num_ranks; ++i)
+    {
+        m_mailboxes.push_back(std::make_unique<Mailbox>());
+    }
+}
+
+int InProcessNetwork::get_num_ranks() const { return m_num_ranks; }
+
+void InProcessNetwork::send(int source, int destination, const Message& message)
+{
+    auto& mailbox = *m_mailboxes.at(source * m_num_ranks + destination);
+    {
+        std::lock_guard lock(mailbox.mutex);
+        mailbox.messages.push_back(message);
+    }
+    mailbox.condition.notify_one();
+}
+
+Message InProcessNetwork::receive(int source, int destination)
+{
+    auto& mailbox = *m_mailboxes.at(source * m_num_ranks + destination);
+    std::unique_lock lock(mailbox.mutex);
+    mailbox.condition.wait(lock, [&]() { return !mailbox.messages.empty(); });
+    auto message = std::move(mailbox.messages.front());
+    mailbox.messages.pop_front();
+    return message;
+}
+
+// -------------------
+// InProcessTransport
+// -------------------
+
+InProcessTransport::InProcessTransport(std::shared_ptr<InProcessNetwork> network, int rank) : m_network(std::move(network)), m_rank(rank)
+{
+    if (rank < 0 || rank >= m_network->get_num_ranks())
+    {
+        throw std::invalid_argument("rank out of range");
+    }
+}
+
+int InProcessTransport::get_rank() const { return m_rank; }
+
+int InProcessTransport::get_num_ranks() const { return m_network->get_num_ranks(); }
+
+void InProcessTransport::send(int destination, const Message& message) { m_network->send(m_rank, destination, message); }
+
+Message InProcessTransport::receive(int source) { return m_network->receive(source, m_rank); }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// ----------------
+// SocketTransport
+// ----------------
+
+#ifdef MSG_NOSIGNAL
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL;  // Report closed peers as errors instead of raising SIGPIPE
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+
+static void write_all(int socket, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        const auto written = ::send(socket, bytes, size, SEND_FLAGS);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("SocketTransport::send: ") + std::strerror(errno));
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+static void read_all(int socket, void* data, size_t size)
+{
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0)
+    {
+        const auto num_read = ::recv(socket, bytes, size, 0);
+        if (num_read < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("SocketTransport::receive: ") + std::strerror(errno));
+        }
+        if (num_read == 0)
+        {
+            throw std::runtime_error("SocketTransport::receive: connection closed");
+        }
+        bytes += num_read;
+        size -= static_cast<size_t>(num_read);
+    }
+}
+
+SocketTransport::SocketTransport(int rank, std::vector<int> sockets) : m_rank(rank), m_sockets(std::move(sockets))
+{
+    if (rank < 0 || rank >= static_cast<int>(m_sockets.size()))
+    {
+        throw std::invalid_argument("rank out of range");
+    }
+}
+
+SocketTransport::~SocketTransport()
+{
+    for (const auto& socket : m_sockets)
+    {
+        if (socket >= 0)
+            ::close(socket);
+    }
+}
+
+int SocketTransport::get_rank() const { return m_rank; }
+
+int SocketTransport::get_num_ranks() const { return static_cast<int>(m_sockets.size()); }
+
+void SocketTransport::send(int destination, const Message& message)
+{
+    const auto size = static_cast<uint64_t>(message.size());
+    write_all(m_sockets.at(destination), &size, sizeof(size));
+    write_all(m_sockets.at(destination), message.data(), message.size() * sizeof(int));
+}
+
+Message SocketTransport::receive(int source)
+{
+    uint64_t size = 0;
+    read_all(m_sockets.at(source), &size, sizeof(size));
+    auto message = Message(size);
+    read_all(m_sockets.at(source), message.data(), message.size() * sizeof(int));
+    return message;
+}
+
+std::vector<std::vector<int>> SocketTransport::create_socket_mesh(int num_ranks)
+{
+    auto sockets = std::vector<std::vector<int>>(num_ranks, std::vector<int>(num_ranks, -1));
+
+    for (int i = 0; i < num_ranks; ++i)
+    {
+        for (int j = i + 1; j < num_ranks; ++j)
+        {
+            int pair[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+            {
+                throw std::runtime_error(std::string("SocketTransport::create_socket_mesh: ") + std::strerror(errno));
+            }
+            sockets[i][j] = pair[0];
+            sockets[j][i] = pair[1];
+        }
+    }
+
+    return sockets;
+}
+
+#endif
+
+}
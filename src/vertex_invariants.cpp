@@ -0,0 +1,81 @@
+#include "wl/details/vertex_invariants.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace wl
+{
+
+std::vector<int64_t> count_triangles(const EdgeColoredGraph& graph)
+{
+    const auto num_nodes = graph.get_num_nodes();
+
+    // Sorted distinct neighbors of each node in the underlying simple undirected graph
+    auto neighbors = std::vector<std::vector<int>>(num_nodes);
+    for (int v = 0; v < num_nodes; ++v)
+    {
+        auto& adjacent = neighbors[v];
+        adjacent = graph.get_outbound_adjacent(v);
+        adjacent.insert(adjacent.end(), graph.get_inbound_adjacent(v).begin(), graph.get_inbound_adjacent(v).end());
+        std::sort(adjacent.begin(), adjacent.end());
+        adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+        adjacent.erase(std::remove(adjacent.begin(), adjacent.end(), v), adjacent.end());
+    }
+
+    // Every triangle u < v < w is found once, from its edge (u, v) and the common neighbors above v.
+    auto triangles = std::vector<int64_t>(num_nodes, 0);
+    for (int u = 0; u < num_nodes; ++u)
+    {
+        const auto& first = neighbors[u];
+        for (auto it = std::upper_bound(first.begin(), first.end(), u); it != first.end(); ++it)
+        {
+            const auto v = *it;
+            const auto& second = neighbors[v];
+
+            auto i = std::upper_bound(first.begin(), first.end(), v);
+            auto j = std::upper_bound(second.begin(), second.end(), v);
+            while (i != first.end() && j != second.end())
+            {
+                if (*i < *j)
+                    ++i;
+                else if (*j < *i)
+                    ++j;
+                else
+                {
+                    ++triangles[u];
+                    ++triangles[v];
+                    ++triangles[*i];
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+    }
+    return triangles;
+}
+
+std::vector<int> compute_degree_seeded_coloring(const EdgeColoredGraph& graph, const std::vector<int>& alpha)
+{
+    const auto num_nodes = graph.get_num_nodes();
+
+    auto keys = std::vector<std::pair<int, int>>(num_nodes);
+    for (int v = 0; v < num_nodes; ++v)
+    {
+        keys[v] = { alpha.at(v), static_cast<int>(graph.get_outbound_adjacent(v).size()) };
+    }
+
+    auto sorted_keys = keys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    sorted_keys.erase(std::unique(sorted_keys.begin(), sorted_keys.end()), sorted_keys.end());
+
+    auto coloring = std::vector<int>(num_nodes);
+    for (int v = 0; v < num_nodes; ++v)
+    {
+        coloring[v] = 1 + static_cast<int>(std::lower_bound(sorted_keys.begin(), sorted_keys.end(), keys[v]) - sorted_keys.begin());
+    }
+    return coloring;
+}
+
+}
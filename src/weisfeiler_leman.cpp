@@ -1,103 +1,216 @@
 #include "wl/details/weisfeiler_leman.hpp"
 
+#include "wl/details/utils.hpp"
+
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
 namespace wl
 {
 
-/*
- * TODO: Refactor the interface to use runtime polymorphism instead. This class is currently unnecessary.
- */
-
-WeisfeilerLeman::WeisfeilerLeman(int k) : WeisfeilerLeman(k, false) {}
+// Rounds that compute_node_color_history allocates up front. Runs with more rounds grow the buffer.
+static constexpr size_t MAX_NUM_PREALLOCATED_ROUNDS = 16;
 
-WeisfeilerLeman::WeisfeilerLeman(int k, bool ignore_counting) : m_k(k), m_1wl(ignore_counting), m_2wl(ignore_counting)
+std::unique_ptr<WeisfeilerLemanBase> create_weisfeiler_leman(int k,
+                                                             bool ignore_counting,
+                                                             std::shared_ptr<ColorFunction> color_function,
+                                                             const PairColoringOptions& pair_coloring_options)
 {
-    if (k < 1 || k > 2)
+    if (!color_function)
     {
-        throw std::invalid_argument("k must be either 1 or 2");
+        color_function = std::make_shared<ColorFunction>();
     }
-}
 
-int WeisfeilerLeman::get_k() const { return m_k; }
-
-bool WeisfeilerLeman::get_ignore_counting() const
-{
-    if (get_k() == 1)
+    if (k == 1)
     {
-        return m_1wl.get_ignore_counting();
+        if (ignore_counting)
+        {
+            return std::make_unique<WeisfeilerLeman1D<CountingMode::SET>>(std::move(color_function));
+        }
+        return std::make_unique<WeisfeilerLeman1D<CountingMode::MULTISET>>(std::move(color_function));
     }
 
-    if (get_k() == 2)
+    if (k == 2)
     {
-        return m_2wl.get_ignore_counting();
+        if (ignore_counting)
+        {
+            return std::make_unique<WeisfeilerLeman2D<CountingMode::SET>>(std::move(color_function), pair_coloring_options);
+        }
+        return std::make_unique<WeisfeilerLeman2D<CountingMode::MULTISET>>(std::move(color_function), pair_coloring_options);
     }
 
-    throw std::runtime_error("internal error");
+    throw std::invalid_argument("k must be either 1 or 2");
 }
 
-size_t WeisfeilerLeman::get_coloring_function_size() const
+WeisfeilerLeman::WeisfeilerLeman(int k) : WeisfeilerLeman(k, false) {}
+
+WeisfeilerLeman::WeisfeilerLeman(int k, bool ignore_counting) : WeisfeilerLeman(k, ignore_counting, nullptr) {}
+
+WeisfeilerLeman::WeisfeilerLeman(int k, bool ignore_counting, std::shared_ptr<ColorFunction> color_function) :
+    WeisfeilerLeman(k, ignore_counting, std::move(color_function), PairColoringOptions())
 {
-    if (get_k() == 1)
-    {
-        return m_1wl.get_coloring_function_size();
-    }
+}
 
-    if (get_k() == 2)
-    {
-        return m_2wl.get_coloring_function_size();
-    }
+WeisfeilerLeman::WeisfeilerLeman(int k,
+                                 bool ignore_counting,
+                                 std::shared_ptr<ColorFunction> color_function,
+                                 const PairColoringOptions& pair_coloring_options) :
+    m_engine(create_weisfeiler_leman(k, ignore_counting, std::move(color_function), pair_coloring_options))
+{
+}
+
+int WeisfeilerLeman::get_k() const { return m_engine->get_k(); }
+
+bool WeisfeilerLeman::get_ignore_counting() const { return m_engine->get_ignore_counting(); }
+
+const std::shared_ptr<ColorFunction>& WeisfeilerLeman::get_color_function() const { return m_engine->get_color_function(); }
+
+size_t WeisfeilerLeman::get_coloring_function_size() const { return m_engine->get_coloring_function_size(); }
+
+bool WeisfeilerLeman::get_invariant_seeding() const { return m_engine->get_invariant_seeding(); }
+
+void WeisfeilerLeman::set_invariant_seeding(bool invariant_seeding)
+{
+    if (m_cache && invariant_seeding != m_engine->get_invariant_seeding())
+        m_cache->clear();
 
-    throw std::runtime_error("internal error");
+    m_engine->set_invariant_seeding(invariant_seeding);
+}
+
+void WeisfeilerLeman::set_cache_capacity(size_t capacity)
+{
+    if (capacity == 0)
+        m_cache.reset();
+    else
+        m_cache = std::make_unique<ResultCache<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>>(capacity);
+}
+
+CacheStatistics WeisfeilerLeman::get_cache_statistics() const { return m_cache ? m_cache->get_statistics() : CacheStatistics(); }
+
+static uint64_t get_cache_key(const EdgeColoredGraph& graph, size_t max_num_iterations)
+{
+    auto key = graph.get_content_hash();
+    hash_combine(key, max_num_iterations);
+    return key;
 }
 
 std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman::compute_coloring(const EdgeColoredGraph& graph, size_t max_num_iterations)
 {
-    if (get_k() == 1)
-    {
-        return m_1wl.compute_coloring(graph, max_num_iterations);
-    }
+    if (!m_cache)
+        return m_engine->compute_coloring(graph, max_num_iterations);
 
-    if (get_k() == 2)
-    {
-        return m_2wl.compute_coloring(graph, max_num_iterations);
-    }
+    const auto key = get_cache_key(graph, max_num_iterations);
+    if (auto result = m_cache->find(key))
+        return std::move(*result);
 
-    throw std::runtime_error("internal error");
+    auto result = m_engine->compute_coloring(graph, max_num_iterations);
+    m_cache->insert(key, result);
+    return result;
 }
 
-GraphColoring WeisfeilerLeman::compute_initial_coloring(const EdgeColoredGraph& graph)
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman::compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations)
 {
-    if (get_k() == 1)
-    {
-        return m_1wl.compute_initial_coloring(graph);
-    }
+    if (!m_cache)
+        return m_engine->compute_coloring_parallel(graph, pool, max_num_iterations);
 
-    if (get_k() == 2)
-    {
-        return m_2wl.compute_initial_coloring(graph);
-    }
+    const auto key = get_cache_key(graph, max_num_iterations);
+    if (auto result = m_cache->find(key))
+        return std::move(*result);
 
-    throw std::runtime_error("internal error");
+    auto result = m_engine->compute_coloring_parallel(graph, pool, max_num_iterations);
+    m_cache->insert(key, result);
+    return result;
 }
 
-bool WeisfeilerLeman::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman::compute_coloring_with_checkpoints(const EdgeColoredGraph& graph, const CheckpointOptions& options, size_t max_num_iterations)
 {
-    if (get_k() == 1)
-    {
-        return m_1wl.compute_next_coloring(graph, current_coloring, ref_next_coloring);
-    }
+    return m_engine->compute_coloring_with_checkpoints(graph, options, max_num_iterations);
+}
 
-    if (get_k() == 2)
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman::resume_coloring(const EdgeColoredGraph& graph, const std::string& path, const CheckpointOptions& options, size_t max_num_iterations)
+{
+    // The checkpoint replaces the color function, so memoized histograms may use other colors.
+    if (m_cache)
+        m_cache->clear();
+
+    return m_engine->resume_coloring(graph, path, options, max_num_iterations);
+}
+
+std::tuple<bool, size_t, NodeColorHistory>
+WeisfeilerLeman::compute_node_color_history(const EdgeColoredGraph& graph, size_t max_num_iterations, std::ostream* stream)
+{
+    const auto num_nodes = graph.get_num_nodes();
+
+    auto history = NodeColorHistory();
+    history.num_nodes = num_nodes;
+    history.colors.reserve(static_cast<size_t>(num_nodes) * (std::min(max_num_iterations, MAX_NUM_PREALLOCATED_ROUNDS) + 1));
+
+    auto record = [&](const GraphColoring& coloring)
     {
-        return m_2wl.compute_next_coloring(graph, current_coloring, ref_next_coloring);
+        const auto begin = history.colors.size();
+        for (int node = 0; node < num_nodes; ++node)
+        {
+            // 2-FWL colorings are indexed by pairs (i, j) at i * num_nodes + j
+            const auto index = (get_k() == 1) ? static_cast<size_t>(node) : static_cast<size_t>(node) * num_nodes + node;
+            history.colors.push_back(static_cast<int32_t>(coloring.colorings[index]));
+        }
+        ++history.num_rounds;
+
+        if (stream)
+        {
+            stream->write(reinterpret_cast<const char*>(history.colors.data() + begin), static_cast<std::streamsize>(num_nodes * sizeof(int32_t)));
+            if (!*stream)
+            {
+                throw std::runtime_error("compute_node_color_history: failed to write round " + std::to_string(history.num_rounds - 1));
+            }
+        }
+    };
+
+    auto current_coloring = compute_initial_coloring(graph);
+    auto next_coloring = GraphColoring { std::vector<int>(current_coloring.colorings.size()) };
+    record(current_coloring);
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
+    {
+        ++num_iterations;
+
+        bool is_stable_i = compute_next_coloring(graph, current_coloring, next_coloring);
+
+        std::swap(current_coloring, next_coloring);
+        record(current_coloring);
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
     }
 
-    throw std::runtime_error("internal error");
+    return { is_stable, num_iterations, std::move(history) };
+}
+
+GraphColoring WeisfeilerLeman::compute_initial_coloring(const EdgeColoredGraph& graph) { return m_engine->compute_initial_coloring(graph); }
+
+bool WeisfeilerLeman::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+{
+    return m_engine->compute_next_coloring(graph, current_coloring, ref_next_coloring);
 }
 
 }
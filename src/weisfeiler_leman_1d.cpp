@@ -1,52 +1,71 @@
 #include "wl/details/weisfeiler_leman_1d.hpp"
 
+#include "wl/details/kernels.hpp"
 #include "wl/details/utils.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <future>
+#include <stdexcept>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace wl
 {
 
-WeisfeilerLeman1D::WeisfeilerLeman1D() : WeisfeilerLeman1D(false) {}
+static constexpr int MIN_CHUNK_SIZE = 256;
 
-WeisfeilerLeman1D::WeisfeilerLeman1D(bool ignore_counting) : m_color_function(), m_ignore_counting(ignore_counting) {}
+// Largest bitset of adjacent colors in set mode. Rounds with more (color, edge label) pairs sort vectors instead.
+static constexpr size_t MAX_NUM_BITSET_WORDS = 16;
 
-bool WeisfeilerLeman1D::get_ignore_counting() const { return m_ignore_counting; }
+template<CountingMode Mode>
+WeisfeilerLeman1D<Mode>::WeisfeilerLeman1D() : WeisfeilerLeman1D(std::make_shared<ColorFunction>()) {}
 
-size_t WeisfeilerLeman1D::get_coloring_function_size() const { return m_color_function.size(); }
-
-std::vector<AdjacentColor> WeisfeilerLeman1D::get_colors_pairs(const std::vector<Color>& node_colors,
-                                                               const std::vector<int>& node_indices,
-                                                               const std::vector<Color>& edge_colors,
-                                                               const std::vector<int>& edge_indices)
+template<CountingMode Mode>
+WeisfeilerLeman1D<Mode>::WeisfeilerLeman1D(std::shared_ptr<ColorFunction> color_function) :
+    m_color_function(std::move(color_function)),
+    m_invariant_seeding(false)
 {
-    assert(node_indices.size() == edge_indices.size());
-
-    std::vector<AdjacentColor> adjacent_colors;
-
-    for (size_t index = 0; index < node_indices.size(); ++index)
+    if (!m_color_function)
     {
-        adjacent_colors.emplace_back(node_colors[node_indices[index]], edge_colors[edge_indices[index]]);
+        throw std::invalid_argument("color_function must not be null");
     }
-
-    return adjacent_colors;
 }
 
-Color WeisfeilerLeman1D::get_new_color(NodeColorContext&& node_color_context)
+template<CountingMode Mode>
+int WeisfeilerLeman1D<Mode>::get_k() const { return 1; }
+
+template<CountingMode Mode>
+bool WeisfeilerLeman1D<Mode>::get_ignore_counting() const { return Mode == CountingMode::SET; }
+
+template<CountingMode Mode>
+const std::shared_ptr<ColorFunction>& WeisfeilerLeman1D<Mode>::get_color_function() const { return m_color_function; }
+
+template<CountingMode Mode>
+size_t WeisfeilerLeman1D<Mode>::get_coloring_function_size() const { return m_color_function->size(); }
+
+template<CountingMode Mode>
+bool WeisfeilerLeman1D<Mode>::get_invariant_seeding() const { return m_invariant_seeding; }
+
+template<CountingMode Mode>
+void WeisfeilerLeman1D<Mode>::set_invariant_seeding(bool invariant_seeding) { m_invariant_seeding = invariant_seeding; }
+
+template<CountingMode Mode>
+Color WeisfeilerLeman1D<Mode>::get_new_color(NodeColorContext&& node_color_context)
 {
     auto& first_colors = std::get<1>(node_color_context);
     auto& second_colors = std::get<2>(node_color_context);
 
-    std::sort(first_colors.begin(), first_colors.end());
-    std::sort(second_colors.begin(), second_colors.end());
+    sort_adjacent_colors(first_colors);
+    sort_adjacent_colors(second_colors);
 
-    if (m_ignore_counting)
+    if constexpr (Mode == CountingMode::SET)
     {
         auto first_last = std::unique(first_colors.begin(), first_colors.end());
         first_colors.erase(first_last, first_colors.end());
@@ -55,37 +74,156 @@ Color WeisfeilerLeman1D::get_new_color(NodeColorContext&& node_color_context)
         second_colors.erase(second_last, second_colors.end());
     }
 
-    auto it = m_color_function.find(node_color_context);
+    return m_color_function->get_or_insert(std::move(node_color_context));
+}
 
-    if (it == m_color_function.end())
+template<CountingMode Mode>
+typename WeisfeilerLeman1D<Mode>::BitsetIndex WeisfeilerLeman1D<Mode>::get_bitset_index(const EdgeColoredGraph& graph,
+                                                                                      const GraphColoring& current_coloring) const
+{
+    auto index = BitsetIndex();
+
+    if constexpr (Mode == CountingMode::SET)
     {
-        int color = static_cast<int>(m_color_function.size());
-        m_color_function.emplace(std::move(node_color_context), color);
-        return color;
+        auto get_sorted_unique = [](std::vector<int> values)
+        {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            return values;
+        };
+
+        auto get_ranks = [](const std::vector<int>& sorted_values, const std::vector<int>& values)
+        {
+            auto ranks = std::vector<int>(values.size());
+            for (size_t i = 0; i < values.size(); ++i)
+                ranks[i] = static_cast<int>(std::lower_bound(sorted_values.begin(), sorted_values.end(), values[i]) - sorted_values.begin());
+            return ranks;
+        };
+
+        index.colors = get_sorted_unique(current_coloring.colorings);
+        index.labels = get_sorted_unique(graph.get_edge_labels());
+
+        const auto num_pairs = index.colors.size() * index.labels.size();
+        if (num_pairs > 64 * MAX_NUM_BITSET_WORDS)
+        {
+            return index;
+        }
+
+        index.enabled = true;
+        index.num_words = (num_pairs + 63) / 64;
+        index.node_ranks = get_ranks(index.colors, current_coloring.colorings);
+        index.edge_ranks = get_ranks(index.labels, graph.get_edge_labels());
     }
 
-    return it->second;
+    return index;
 }
 
-bool WeisfeilerLeman1D::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+template<CountingMode Mode>
+template<bool Directed>
+void WeisfeilerLeman1D<Mode>::compute_next_coloring_bitset_impl(const EdgeColoredGraph& graph,
+                                                                const GraphColoring& current_coloring,
+                                                                GraphColoring& ref_next_coloring,
+                                                                const BitsetIndex& index,
+                                                                int begin,
+                                                                int end)
 {
-    for (int node = 0; node < graph.get_num_nodes(); ++node)
+    const auto num_words = index.num_words;
+    const auto num_labels = index.labels.size();
+
+    auto add_bits = [&](uint64_t* words, const std::vector<int>& adjacent, const std::vector<EdgeId>& edges)
+    {
+        for (size_t i = 0; i < adjacent.size(); ++i)
+        {
+            const auto bit = index.node_ranks[adjacent[i]] * num_labels + index.edge_ranks[edges[i]];
+            words[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    };
+
+    // Bits in increasing order are the pairs in sorted order, so decoding yields the same context as sorting and removing duplicates.
+    auto get_adjacent_colors = [&](const uint64_t* words)
     {
-        auto outgoing_colors =
-            get_colors_pairs(current_coloring.colorings, graph.get_outbound_adjacent(node), graph.get_edge_labels(), graph.get_outbound_edges(node));
+        auto adjacent_colors = std::vector<AdjacentColor>();
+        for (size_t w = 0; w < num_words; ++w)
+        {
+            for (auto word = words[w]; word != 0; word &= word - 1)
+            {
+                const auto bit = w * 64 + static_cast<size_t>(std::countr_zero(word));
+                adjacent_colors.emplace_back(index.colors[bit / num_labels], index.labels[bit % num_labels]);
+            }
+        }
+        return adjacent_colors;
+    };
 
-        auto ingoing_colors =
-            graph.is_directed() ?
-                get_colors_pairs(current_coloring.colorings, graph.get_inbound_adjacent(node), graph.get_edge_labels(), graph.get_inbound_edges(node)) :
-                std::vector<AdjacentColor>();
+    auto hash_words = [](const std::vector<uint64_t>& words)
+    {
+        uint64_t seed = words.size();
+        for (const auto& word : words)
+            hash_combine(seed, word);
+        return static_cast<size_t>(seed);
+    };
+
+    // The signature of a node is its color followed by the bitsets of its outgoing and ingoing adjacent colors.
+    // Nodes with equal signatures have equal contexts, so the color function is only consulted once per signature.
+    auto signature = std::vector<uint64_t>(1 + (Directed ? 2 : 1) * num_words);
+    auto known_signatures = std::unordered_map<std::vector<uint64_t>, Color, decltype(hash_words)>(0, hash_words);
+
+    for (int node = begin; node < end; ++node)
+    {
+        std::fill(signature.begin(), signature.end(), 0);
+        signature[0] = static_cast<uint32_t>(current_coloring.colorings[node]);
+        add_bits(signature.data() + 1, graph.get_outbound_adjacent(node), graph.get_outbound_edges(node));
+        if constexpr (Directed)
+        {
+            add_bits(signature.data() + 1 + num_words, graph.get_inbound_adjacent(node), graph.get_inbound_edges(node));
+        }
 
-        ref_next_coloring.colorings[node] = get_new_color({ current_coloring.colorings[node], std::move(outgoing_colors), std::move(ingoing_colors) });
+        auto it = known_signatures.find(signature);
+        if (it == known_signatures.end())
+        {
+            auto outgoing_colors = get_adjacent_colors(signature.data() + 1);
+            auto ingoing_colors = Directed ? get_adjacent_colors(signature.data() + 1 + num_words) : std::vector<AdjacentColor>();
+            auto color = m_color_function->get_or_insert({ current_coloring.colorings[node], std::move(outgoing_colors), std::move(ingoing_colors) });
+            it = known_signatures.emplace(signature, color).first;
+        }
+        ref_next_coloring.colorings[node] = it->second;
     }
+}
+
+template<CountingMode Mode>
+void WeisfeilerLeman1D<Mode>::compute_next_coloring_range(const EdgeColoredGraph& graph,
+                                                          const GraphColoring& current_coloring,
+                                                          GraphColoring& ref_next_coloring,
+                                                          const BitsetIndex& index,
+                                                          int begin,
+                                                          int end)
+{
+    if (index.enabled)
+    {
+        if (graph.is_directed())
+            compute_next_coloring_bitset_impl<true>(graph, current_coloring, ref_next_coloring, index, begin, end);
+        else
+            compute_next_coloring_bitset_impl<false>(graph, current_coloring, ref_next_coloring, index, begin, end);
+    }
+    else
+    {
+        if (graph.is_directed())
+            compute_next_coloring_impl<EdgeColoredGraph, true>(graph, current_coloring, ref_next_coloring, begin, end);
+        else
+            compute_next_coloring_impl<EdgeColoredGraph, false>(graph, current_coloring, ref_next_coloring, begin, end);
+    }
+}
+
+template<CountingMode Mode>
+bool WeisfeilerLeman1D<Mode>::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+{
+    compute_next_coloring_range(graph, current_coloring, ref_next_coloring, get_bitset_index(graph, current_coloring), 0, graph.get_num_nodes());
 
     return current_coloring.is_identical_to(ref_next_coloring);
 }
 
-std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman1D::compute_coloring(const EdgeColoredGraph& graph, size_t max_num_iterations)
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman1D<Mode>::compute_coloring(const EdgeColoredGraph& graph,
+                                                                                                       size_t max_num_iterations)
 {
     auto num_nodes = graph.get_num_nodes();
 
@@ -120,21 +258,71 @@ std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman1D::
     return { is_stable, num_iterations, std::move(unique), std::move(counts) };
 }
 
-GraphColoring WeisfeilerLeman1D::compute_initial_coloring(const EdgeColoredGraph& graph)
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman1D<Mode>::compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations)
 {
     auto num_nodes = graph.get_num_nodes();
-    auto current_coloring = std::vector<int>(num_nodes);
 
-    for (int node = 0; node < num_nodes; ++node)
+    // A few chunks per thread, so that stealing can balance nodes of uneven degree
+    const auto chunk_size = std::max(MIN_CHUNK_SIZE, num_nodes / static_cast<int>(4 * pool.get_num_threads()) + 1);
+
+    auto current_coloring = compute_initial_coloring(graph);
+    auto next_coloring = GraphColoring { std::vector<int>(num_nodes) };
+
+    size_t num_iterations = 0;
+    bool is_stable = false;
+
+    while (true)
     {
-        // Both graph labels and colors are natural numbers.
-        // We make the graph labels negative so that they are not confused with colors.
+        ++num_iterations;
+
+        const auto index = get_bitset_index(graph, current_coloring);
+
+        auto futures = std::vector<std::future<void>>();
+        for (int begin = 0; begin < num_nodes; begin += chunk_size)
+        {
+            const auto end = std::min(num_nodes, begin + chunk_size);
+            futures.push_back(pool.submit([&, begin, end]() { compute_next_coloring_range(graph, current_coloring, next_coloring, index, begin, end); }));
+        }
+        // Wait for all chunks before rethrowing, e.g., an UnseenContextError, since they reference the colorings on this stack.
+        for (auto& future : futures)
+        {
+            pool.wait(future);
+        }
+        for (auto& future : futures)
+        {
+            future.get();
+        }
 
-        auto node_label = -graph.get_node_label(node) - 1;
-        current_coloring[node] = get_new_color({ node_label, {}, {} });
+        bool is_stable_i = current_coloring.is_identical_to(next_coloring);
+
+        std::swap(current_coloring, next_coloring);
+
+        if (is_stable_i)
+        {
+            is_stable = true;
+            break;
+        }
+
+        if (num_iterations == max_num_iterations)
+        {
+            break;
+        }
     }
 
-    return GraphColoring { std::move(current_coloring) };
+    auto [unique, counts] = current_coloring.get_frequencies();
+    lexical_sort(unique, counts);
+    return { is_stable, num_iterations, std::move(unique), std::move(counts) };
+}
+
+template<CountingMode Mode>
+GraphColoring WeisfeilerLeman1D<Mode>::compute_initial_coloring(const EdgeColoredGraph& graph)
+{
+    return compute_initial_coloring<EdgeColoredGraph>(graph);
 }
 
+template class WeisfeilerLeman1D<CountingMode::MULTISET>;
+template class WeisfeilerLeman1D<CountingMode::SET>;
+
 }
@@ -1,46 +1,85 @@
 #include "wl/details/weisfeiler_leman_2d.hpp"
 
+#include "wl/details/checkpoint.hpp"
+#include "wl/details/kernels.hpp"
 #include "wl/details/utils.hpp"
+#include "wl/details/vertex_invariants.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+#include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace wl
 {
 
-WeisfeilerLeman2D::WeisfeilerLeman2D() : WeisfeilerLeman2D(false) {}
+template<CountingMode Mode>
+WeisfeilerLeman2D<Mode>::WeisfeilerLeman2D() : WeisfeilerLeman2D(std::make_shared<ColorFunction>()) {}
 
-WeisfeilerLeman2D::WeisfeilerLeman2D(bool ignore_counting) : m_color_function(), m_ignore_counting(ignore_counting) {}
-
-bool WeisfeilerLeman2D::get_ignore_counting() const { return m_ignore_counting; }
-
-size_t WeisfeilerLeman2D::get_coloring_function_size() const { return m_color_function.size(); }
-
-std::vector<Color> WeisfeilerLeman2D::get_colors(const std::vector<Color>& colors, const std::vector<int>& indices)
+template<CountingMode Mode>
+WeisfeilerLeman2D<Mode>::WeisfeilerLeman2D(std::shared_ptr<ColorFunction> color_function) : WeisfeilerLeman2D(std::move(color_function), PairColoringOptions())
 {
-    auto result = std::vector<int>(indices.size());
+}
 
-    for (const auto& i : indices)
+template<CountingMode Mode>
+WeisfeilerLeman2D<Mode>::WeisfeilerLeman2D(std::shared_ptr<ColorFunction> color_function, const PairColoringOptions& options) :
+    m_color_function(std::move(color_function)),
+    m_options(options),
+    m_invariant_seeding(false)
+{
+    if (!m_color_function)
     {
-        result.emplace_back(colors[i]);
+        throw std::invalid_argument("color_function must not be null");
     }
-
-    return result;
 }
 
-Color WeisfeilerLeman2D::get_new_color(NodeColorContext&& node_color_context)
+template<CountingMode Mode>
+int WeisfeilerLeman2D<Mode>::get_k() const { return 2; }
+
+template<CountingMode Mode>
+bool WeisfeilerLeman2D<Mode>::get_ignore_counting() const { return Mode == CountingMode::SET; }
+
+template<CountingMode Mode>
+const std::shared_ptr<ColorFunction>& WeisfeilerLeman2D<Mode>::get_color_function() const { return m_color_function; }
+
+template<CountingMode Mode>
+const PairColoringOptions& WeisfeilerLeman2D<Mode>::get_pair_coloring_options() const { return m_options; }
+
+template<CountingMode Mode>
+size_t WeisfeilerLeman2D<Mode>::get_coloring_function_size() const { return m_color_function->size(); }
+
+template<CountingMode Mode>
+bool WeisfeilerLeman2D<Mode>::get_invariant_seeding() const { return m_invariant_seeding; }
+
+template<CountingMode Mode>
+void WeisfeilerLeman2D<Mode>::set_invariant_seeding(bool invariant_seeding) { m_invariant_seeding = invariant_seeding; }
+
+namespace
 {
-    auto& first_colors = std::get<1>(node_color_context);
-    auto& second_colors = std::get<2>(node_color_context);
 
-    std::sort(first_colors.begin(), first_colors.end());
-    std::sort(second_colors.begin(), second_colors.end());
+/// @brief Sort the adjacent colors of a context, and remove duplicates in set mode.
+template<CountingMode Mode>
+void canonicalize_context(NodeColorContext& ref_node_color_context)
+{
+    auto& first_colors = std::get<1>(ref_node_color_context);
+    auto& second_colors = std::get<2>(ref_node_color_context);
 
-    if (m_ignore_counting)
+    sort_adjacent_colors(first_colors);
+    sort_adjacent_colors(second_colors);
+
+    if constexpr (Mode == CountingMode::SET)
     {
         auto first_last = std::unique(first_colors.begin(), first_colors.end());
         first_colors.erase(first_last, first_colors.end());
@@ -48,67 +87,256 @@ Color WeisfeilerLeman2D::get_new_color(NodeColorContext&& node_color_context)
         auto second_last = std::unique(second_colors.begin(), second_colors.end());
         second_colors.erase(second_last, second_colors.end());
     }
+}
+
+/// @brief Atomic types of the pairs of a graph, computed from the sparse edge lists in O(n^2 + m).
+///
+/// The atomic type of (i, j) encodes the labels of i and j, the labels of the edges i -> j and j -> i, and the self-loops of i and j.
+/// Only the pairs on the diagonal or joined by an edge have their own context. All other pairs share a default type per
+/// pair of node classes, where two nodes are in the same class iff they have the same label and self-loops.
+///
+/// The contexts are built in parallel on a thread pool. Colors are assigned lazily on the first lookup, so a row-major scan assigns them
+/// in the same order as computing the atomic type of each pair on its own.
+template<CountingMode Mode>
+class AtomicTypes
+{
+private:
+    static constexpr int MIN_NUM_NODES_PER_TASK = 256;
+    static constexpr Color UNKNOWN = -1;
+
+    ColorFunction& m_color_function;
+    const std::vector<int>& m_node_labels;  // Indexed by node. Natural numbers
+
+    std::vector<std::vector<int>> m_columns;                // Indexed by row i. Sorted nodes j such that (i, j) has its own context
+    std::vector<std::vector<NodeColorContext>> m_contexts;  // Indexed by row. Canonical contexts of the pairs in m_columns
+    std::vector<std::vector<Color>> m_colors;               // Indexed by row. Colors of the pairs in m_columns, or UNKNOWN
+
+    std::vector<int> m_node_classes;                       // Indexed by node
+    std::vector<std::vector<AdjacentColor>> m_self_loops;  // Indexed by class. Canonical self-loop colors of its nodes
+    std::unordered_map<uint64_t, Color> m_default_colors;  // Indexed by src class * num classes + dst class
 
-    auto it = m_color_function.find(node_color_context);
+    int m_row;                                // Row of the current row-major scan
+    std::vector<Color> m_row_default_colors;  // Indexed by dst class. Default colors of the pairs of m_row, or UNKNOWN
 
-    if (it == m_color_function.end())
+    static Color get_edge_color(int label) { return label; }
+    static Color get_self_loop_color(int label) { return -label - 1; }
+
+    NodeColorContext get_default_context(int i, int j) const
     {
-        int color = static_cast<int>(m_color_function.size());
-        m_color_function.emplace(std::move(node_color_context), color);
-        return color;
+        // Both graph labels and colors are natural numbers.
+        // We make the graph labels negative so that they are not confused with colors.
+
+        return { -static_cast<ContextColor>(pairing_function(m_node_labels[i], m_node_labels[j])) - 1,
+                 m_self_loops[m_node_classes[i]],
+                 m_self_loops[m_node_classes[j]] };
     }
 
-    return it->second;
-}
+    void compute_rows(const EdgeColoredGraph& graph, int begin, int end)
+    {
+        const auto& edge_labels = graph.get_edge_labels();
+        auto entries = std::vector<std::tuple<int, bool, AdjacentColor>>();
 
-int WeisfeilerLeman2D::get_subgraph_color(int src_node, int dst_node, const EdgeColoredGraph& graph)
-{
-    const auto& node_labels = graph.get_node_labels();
-    const auto& edge_labels = graph.get_edge_labels();
+        for (int i = begin; i < end; ++i)
+        {
+            // Collect the edges between i and its adjacent nodes j as the forward (i -> j) or backward (j -> i) colors of (i, j).
+            // Edges keep their label as color, self-loops get a negative color, so the two never collide.
+            entries.clear();
+
+            const auto& outbound_adjacent = graph.get_outbound_adjacent(i);
+            const auto& outbound_edges = graph.get_outbound_edges(i);
+            for (size_t k = 0; k < outbound_adjacent.size(); ++k)
+            {
+                const auto j = outbound_adjacent[k];
+                entries.emplace_back(j, false, AdjacentColor { get_edge_color(edge_labels[outbound_edges[k]]), m_node_labels[j] });
+            }
+
+            const auto& inbound_adjacent = graph.get_inbound_adjacent(i);
+            const auto& inbound_edges = graph.get_inbound_edges(i);
+            for (size_t k = 0; k < inbound_adjacent.size(); ++k)
+            {
+                const auto j = inbound_adjacent[k];
+                entries.emplace_back(j, true, AdjacentColor { get_edge_color(edge_labels[inbound_edges[k]]), m_node_labels[i] });
+            }
 
-    auto src_label = node_labels[src_node];
-    auto dst_label = node_labels[dst_node];
+            std::sort(entries.begin(), entries.end());
 
-    auto forward_edge_labels = get_colors(edge_labels, graph.get_edges(src_node, dst_node));
-    auto self_src_edge_labels = get_colors(edge_labels, graph.get_edges(src_node, src_node));
-    auto backward_edge_labels = get_colors(edge_labels, graph.get_edges(dst_node, src_node));
-    auto self_dst_edge_labels = get_colors(edge_labels, graph.get_edges(dst_node, dst_node));
+            auto& columns = m_columns[i];
+            auto& contexts = m_contexts[i];
 
-    // Encode the subgraph as a vector of the colors of the nodes and the edges.
-    // We use a pairing function to give them a unique color to distinguish between self-loops and normal edges.
+            for (const auto& [j, backward, color] : entries)
+            {
+                if (columns.empty() || columns.back() != j)
+                {
+                    columns.push_back(j);
+                    contexts.push_back(get_default_context(i, j));
+                }
+
+                auto& adjacent_colors = backward ? std::get<2>(contexts.back()) : std::get<1>(contexts.back());
+                adjacent_colors.push_back(color);
+            }
 
-    auto forward_colors = std::vector<AdjacentColor>();
-    auto backward_colors = std::vector<AdjacentColor>();
+            // The diagonal always has its own context, even without self-loops.
+            const auto diagonal = std::lower_bound(columns.begin(), columns.end(), i);
+            if (diagonal == columns.end() || *diagonal != i)
+            {
+                contexts.insert(contexts.begin() + (diagonal - columns.begin()), get_default_context(i, i));
+                columns.insert(diagonal, i);
+            }
+
+            for (auto& context : contexts)
+            {
+                canonicalize_context<Mode>(context);
+            }
 
-    for (const auto& label : forward_edge_labels)
+            m_colors[i].assign(columns.size(), UNKNOWN);
+        }
+    }
+
+    Color get_default_color(int i, int j)
     {
-        forward_colors.emplace_back(pairing_function(0, label), dst_label);
+        const auto dst_class = m_node_classes[j];
+
+        if (i == m_row && m_row_default_colors[dst_class] != UNKNOWN)
+            return m_row_default_colors[dst_class];
+
+        const auto key = static_cast<uint64_t>(m_node_classes[i]) * m_self_loops.size() + dst_class;
+        auto it = m_default_colors.find(key);
+        if (it == m_default_colors.end())
+        {
+            auto context = get_default_context(i, j);
+            canonicalize_context<Mode>(context);
+            it = m_default_colors.emplace(key, m_color_function.get_or_insert(std::move(context))).first;
+        }
+
+        if (i == m_row)
+            m_row_default_colors[dst_class] = it->second;
+
+        return it->second;
     }
 
-    for (const auto& label : self_src_edge_labels)
+public:
+    AtomicTypes(ColorFunction& color_function, const EdgeColoredGraph& graph, const std::vector<int>& node_labels, ThreadPool& pool) :
+        m_color_function(color_function),
+        m_node_labels(node_labels),
+        m_columns(graph.get_num_nodes()),
+        m_contexts(graph.get_num_nodes()),
+        m_colors(graph.get_num_nodes()),
+        m_node_classes(graph.get_num_nodes()),
+        m_self_loops(),
+        m_default_colors(),
+        m_row(-1),
+        m_row_default_colors()
     {
-        forward_colors.emplace_back(pairing_function(1, label), src_label);
+        const auto num_nodes = graph.get_num_nodes();
+        const auto& edge_labels = graph.get_edge_labels();
+
+        // Group the nodes into classes by their label and self-loops.
+        auto classes = std::map<std::pair<int, std::vector<AdjacentColor>>, int>();
+
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            auto context = NodeColorContext();
+            for (const auto& edge : graph.get_edges(i, i))
+            {
+                std::get<1>(context).emplace_back(get_self_loop_color(edge_labels[edge]), m_node_labels[i]);
+            }
+            canonicalize_context<Mode>(context);
+
+            auto [it, inserted] = classes.emplace(std::make_pair(m_node_labels[i], std::get<1>(context)), static_cast<int>(m_self_loops.size()));
+            if (inserted)
+                m_self_loops.push_back(std::move(std::get<1>(context)));
+            m_node_classes[i] = it->second;
+        }
+
+        m_row_default_colors.assign(m_self_loops.size(), UNKNOWN);
+
+        // Build the contexts of the diagonal and the adjacent pairs in parallel over the rows.
+        const auto num_tasks = std::min<int>(std::max<size_t>(1, pool.get_num_threads()), std::max(1, num_nodes / MIN_NUM_NODES_PER_TASK));
+        if (num_tasks > 1)
+        {
+            auto futures = std::vector<std::future<void>>();
+            for (int t = 0; t < num_tasks; ++t)
+            {
+                const auto begin = static_cast<int>(static_cast<int64_t>(num_nodes) * t / num_tasks);
+                const auto end = static_cast<int>(static_cast<int64_t>(num_nodes) * (t + 1) / num_tasks);
+                futures.push_back(pool.submit([this, &graph, begin, end]() { compute_rows(graph, begin, end); }));
+            }
+            // Wait for all tasks before rethrowing, since they reference this object.
+            for (auto& future : futures)
+                pool.wait(future);
+            for (auto& future : futures)
+                future.get();
+        }
+        else
+        {
+            compute_rows(graph, 0, num_nodes);
+        }
     }
 
-    for (const auto& label : backward_edge_labels)
+    /// @brief Start a row-major scan of row i, which caches the default colors of the row.
+    void begin_row(int i)
     {
-        backward_colors.emplace_back(pairing_function(0, label), src_label);
+        if (m_row < 0 || m_node_classes[m_row] != m_node_classes[i])
+            std::fill(m_row_default_colors.begin(), m_row_default_colors.end(), UNKNOWN);
+        m_row = i;  // Rows of the same class share their default colors
     }
 
-    for (const auto& label : self_dst_edge_labels)
+    /// @brief Return the atomic type of the pair (i, j), assigning a new color if it is unseen.
+    Color get_color(int i, int j)
     {
-        backward_colors.emplace_back(pairing_function(1, label), dst_label);
+        const auto& columns = m_columns[i];
+        const auto it = std::lower_bound(columns.begin(), columns.end(), j);
+
+        if (it == columns.end() || *it != j)
+            return get_default_color(i, j);
+
+        const auto index = static_cast<size_t>(it - columns.begin());
+        auto& color = m_colors[i][index];
+        if (color == UNKNOWN)
+            color = m_color_function.get_or_insert(std::move(m_contexts[i][index]));
+        return color;
     }
+};
 
-    // Both graph labels and colors are natural numbers.
-    // We make the graph labels negative so that they are not confused with colors.
 
-    return get_new_color({ -pairing_function(src_label, dst_label) - 1, std::move(forward_colors), std::move(backward_colors) });
+}
+
+template<CountingMode Mode>
+Color WeisfeilerLeman2D<Mode>::get_new_color(NodeColorContext&& node_color_context)
+{
+    canonicalize_context<Mode>(node_color_context);
+
+    return m_color_function->get_or_insert(std::move(node_color_context));
+}
+
+template<CountingMode Mode>
+std::vector<int> WeisfeilerLeman2D<Mode>::compute_seed_labels(const EdgeColoredGraph& graph)
+{
+    const auto num_nodes = graph.get_num_nodes();
+    const auto triangles = (Mode == CountingMode::MULTISET) ? count_triangles(graph) : std::vector<int64_t>();
+    auto labels = std::vector<int>(num_nodes);
+
+    for (int node = 0; node < num_nodes; ++node)
+    {
+        auto context = get_degree_context<Mode>(graph, node);
+
+        // The color of (v, v) determines the number of common neighbors of v and each neighbor, and thus the triangles through v.
+        // In set mode, it does not determine the count, so only the degrees seed.
+        if constexpr (Mode == CountingMode::MULTISET)
+        {
+            const auto num_triangles = static_cast<uint32_t>(std::min<int64_t>(triangles[node], INT_MAX));
+            std::get<0>(context) = -static_cast<ContextColor>(pairing_function(graph.get_node_label(node), num_triangles)) - 1;
+        }
+
+        labels[node] = get_new_color(std::move(context));
+    }
+    return labels;
 }
 
 inline static int index_of_pair(int first_node, int second_node, int num_nodes) { return first_node * num_nodes + second_node; }
 
-bool WeisfeilerLeman2D::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
+template<CountingMode Mode>
+bool WeisfeilerLeman2D<Mode>::compute_next_coloring(const EdgeColoredGraph& graph, const GraphColoring& current_coloring, GraphColoring& ref_next_coloring)
 {
     const auto num_nodes = graph.get_num_nodes();
 
@@ -139,21 +367,259 @@ bool WeisfeilerLeman2D::compute_next_coloring(const EdgeColoredGraph& graph, con
     return current_coloring.is_identical_to(ref_next_coloring);
 }
 
-std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman2D::compute_coloring(const EdgeColoredGraph& graph, size_t max_num_iterations)
+// Side length of the tiles of transpose_matrix, so that a tile of rows and a tile of columns stay in the cache
+static constexpr int TRANSPOSE_TILE_SIZE = 64;
+
+/// @brief Copy the transpose of the full n x n matrix data to a mapped file in directory, tile by tile.
+template<typename T>
+static MappedArray<T> transpose_matrix(const T* data, int num_nodes, const std::string& directory)
+{
+    const auto n = static_cast<size_t>(num_nodes);
+    auto columns = MappedArray<T>(n * n, true, directory);
+    auto* out = columns.data();
+
+    for (size_t row_begin = 0; row_begin < n; row_begin += TRANSPOSE_TILE_SIZE)
+    {
+        const auto row_end = std::min(n, row_begin + TRANSPOSE_TILE_SIZE);
+        for (size_t column_begin = 0; column_begin < n; column_begin += TRANSPOSE_TILE_SIZE)
+        {
+            const auto column_end = std::min(n, column_begin + TRANSPOSE_TILE_SIZE);
+            for (size_t i = row_begin; i < row_end; ++i)
+            {
+                for (size_t j = column_begin; j < column_end; ++j)
+                    out[j * n + i] = data[i * n + j];
+            }
+        }
+    }
+    return columns;
+}
+
+/// @brief True iff the pairs have the same partition into color classes.
+static bool is_same_partition(const PairColorMatrix& first, const PairColorMatrix& second)
+{
+    const auto num_nodes = first.get_num_nodes();
+    auto first_to_second = std::unordered_map<Color, Color>();
+    auto second_to_first = std::unordered_map<Color, Color>();
+
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        for (int j = 0; j < num_nodes; ++j)
+        {
+            const auto first_color = first.get_color(i, j);
+            const auto second_color = second.get_color(i, j);
+            if (first_to_second.emplace(first_color, second_color).first->second != second_color
+                || second_to_first.emplace(second_color, first_color).first->second != first_color)
+                return false;
+        }
+    }
+    return true;
+}
+
+template<CountingMode Mode>
+bool WeisfeilerLeman2D<Mode>::may_merge_colors() const
+{
+    return m_color_function->is_frozen() && m_color_function->get_unseen_context_policy() == UnseenContextPolicy::UNKNOWN_COLOR;
+}
+
+template<CountingMode Mode>
+template<typename T, bool Triangle>
+Color WeisfeilerLeman2D<Mode>::get_pair_color(const T* data, const T* columns, const PairColorMatrix& current, int i, int j)
+{
+    const auto num_nodes = current.get_num_nodes();
+    const auto& palette = current.get_palette();
+    const auto& transpose = current.get_transpose();
+
+    const auto get_local_color = [&](int first_node, int second_node) -> uint32_t
+    {
+        if constexpr (Triangle)
+        {
+            if (first_node > second_node)
+                return transpose[data[current.index_of(second_node, first_node)]];
+        }
+        return data[current.index_of(first_node, second_node)];
+    };
+
+    auto compositions = std::vector<AdjacentColor>(num_nodes);
+
+    if constexpr (Triangle)
+    {
+        for (int k = 0; k < num_nodes; ++k)
+        {
+            compositions[k] = { palette[get_local_color(i, k)], palette[get_local_color(k, j)] };
+        }
+    }
+    else if (columns)
+    {
+        compose_pair_colors(data + current.index_of(i, 0), columns + current.index_of(j, 0), 1, palette.data(), num_nodes, compositions.data());
+    }
+    else
+    {
+        // Row i and column j are strided arrays, which the kernel gathers with vector instructions where available.
+        compose_pair_colors(data + current.index_of(i, 0), data + current.index_of(0, j), num_nodes, palette.data(), num_nodes, compositions.data());
+    }
+
+    return get_new_color({ palette[get_local_color(i, j)], std::move(compositions), {} });
+}
+
+template<CountingMode Mode>
+template<typename T, bool Triangle>
+void WeisfeilerLeman2D<Mode>::compute_next_matrix_impl(const T* data, const PairColorMatrix& current, PairColorMatrix& ref_next)
+{
+    const auto num_nodes = current.get_num_nodes();
+    const auto merges_colors = may_merge_colors();
+    auto row = std::vector<uint32_t>();
+
+    // Strided column reads touch one page per entry, which thrashes a mapped file once it exceeds the RAM.
+    // A transposed copy in the full layout turns every column into a sequential read. The upper triangle layout reads columns in place.
+    auto columns = MappedArray<T>();
+    if (!Triangle && current.get_storage() == PairColoringStorage::MAPPED_FILE)
+    {
+        columns = transpose_matrix(data, num_nodes, current.get_directory());
+    }
+    const auto* column_data = columns.data();
+
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        row.clear();
+        current.will_need_row(i + 1);
+
+        for (int j = (Triangle ? i : 0); j < num_nodes; ++j)
+        {
+            const auto ij_color = get_pair_color<T, Triangle>(data, column_data, current, i, j);
+
+            if constexpr (Triangle)
+            {
+                if (merges_colors)
+                {
+                    // Pairs of the unknown color need not have transposes of one color, so every pair colors its transpose.
+                    const auto ji_color = (i == j) ? ij_color : get_pair_color<T, Triangle>(data, column_data, current, j, i);
+                    row.push_back(ref_next.add_color_pair(ij_color, ji_color));
+                    continue;
+                }
+            }
+
+            const auto ij_local_color = ref_next.add_color(ij_color);
+
+            if constexpr (Triangle)
+            {
+                // The first pair of each color also colors its transpose, which determines the transpose of the color.
+                if (ref_next.get_transpose()[ij_local_color] == std::numeric_limits<uint32_t>::max())
+                {
+                    const auto ji_local_color = (i == j) ? ij_local_color : ref_next.add_color(get_pair_color<T, Triangle>(data, column_data, current, j, i));
+                    ref_next.add_transpose(ij_local_color, ji_local_color);
+                }
+            }
+
+            row.push_back(ij_local_color);
+        }
+
+        ref_next.set_row(i, row);
+    }
+}
+
+template<CountingMode Mode>
+bool WeisfeilerLeman2D<Mode>::compute_next_matrix(const PairColorMatrix& current, PairColorMatrix& ref_next)
+{
+    // The next coloring refines the current one, so it needs at least as many colors.
+    ref_next.reset(current.get_num_nodes(), current.get_layout(), current.get_num_colors());
+
+    current.visit(
+        [&](const auto* data)
+        {
+            using T = std::remove_cv_t<std::remove_pointer_t<decltype(data)>>;
+            if (current.get_layout() == PairColoringLayout::UPPER_TRIANGLE)
+                compute_next_matrix_impl<T, true>(data, current, ref_next);
+            else
+                compute_next_matrix_impl<T, false>(data, current, ref_next);
+        });
+
+    // The unknown color may merge classes while others split, so only the same partition is stable.
+    if (may_merge_colors())
+        return is_same_partition(current, ref_next);
+
+    // The next coloring refines the current one, so it is stable iff the number of colors did not change.
+    return ref_next.get_num_colors() == current.get_num_colors();
+}
+
+template<CountingMode Mode>
+void WeisfeilerLeman2D<Mode>::compute_initial_matrix(const EdgeColoredGraph& graph, ThreadPool& pool, PairColorMatrix& ref_matrix)
 {
     const auto num_nodes = graph.get_num_nodes();
+    const auto triangle = (m_options.layout == PairColoringLayout::UPPER_TRIANGLE);
+    const auto merges_colors = may_merge_colors();
+    const auto seed_labels = m_invariant_seeding ? compute_seed_labels(graph) : std::vector<int>();
+    auto atomic_types = AtomicTypes<Mode>(*m_color_function, graph, m_invariant_seeding ? seed_labels : graph.get_node_labels(), pool);
+    auto row = std::vector<uint32_t>();
 
-    auto current_coloring = compute_initial_coloring(graph);
-    auto next_coloring = GraphColoring { std::vector<int>(num_nodes * num_nodes) };
+    ref_matrix.reset(num_nodes, m_options.layout, 1);
+
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        atomic_types.begin_row(i);
+        row.clear();
+
+        for (int j = (triangle ? i : 0); j < num_nodes; ++j)
+        {
+            if (triangle && merges_colors)
+            {
+                const auto ij_color = atomic_types.get_color(i, j);
+                row.push_back(ref_matrix.add_color_pair(ij_color, (i == j) ? ij_color : atomic_types.get_color(j, i)));
+                continue;
+            }
+
+            const auto ij_local_color = ref_matrix.add_color(atomic_types.get_color(i, j));
+
+            if (triangle && ref_matrix.get_transpose()[ij_local_color] == std::numeric_limits<uint32_t>::max())
+            {
+                const auto ji_local_color = (i == j) ? ij_local_color : ref_matrix.add_color(atomic_types.get_color(j, i));
+                ref_matrix.add_transpose(ij_local_color, ji_local_color);
+            }
 
-    size_t num_iterations = 0;
+            row.push_back(ij_local_color);
+        }
+
+        ref_matrix.set_row(i, row);
+    }
+}
+
+// Header of checkpoints: "WL2C" and the format version
+static constexpr uint32_t CHECKPOINT_MAGIC = 0x43324c57;
+static constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+template<CountingMode Mode>
+void WeisfeilerLeman2D<Mode>::write_checkpoint(const EdgeColoredGraph& graph, const PairColorMatrix& coloring, size_t num_iterations, const std::string& path) const
+{
+    write_file_atomically(path,
+                          [&](std::ostream& out)
+                          {
+                              write_binary<uint32_t>(out, CHECKPOINT_MAGIC);
+                              write_binary<uint32_t>(out, CHECKPOINT_VERSION);
+                              write_binary<uint8_t>(out, get_ignore_counting());
+                              write_binary<uint64_t>(out, graph.get_content_hash());
+                              write_binary<uint64_t>(out, num_iterations);
+                              coloring.write(out);
+                              m_color_function->write(out);
+                          });
+}
+
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman2D<Mode>::refine_matrix(PairColorMatrix&& current_coloring,
+                                                                                                    size_t num_iterations,
+                                                                                                    const EdgeColoredGraph& graph,
+                                                                                                    const CheckpointOptions* options,
+                                                                                                    size_t max_num_iterations)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto next_coloring = PairColorMatrix(m_options);
+    auto last_checkpoint_time = Clock::now();
     bool is_stable = false;
 
     while (true)
     {
         ++num_iterations;
 
-        bool is_stable_i = compute_next_coloring(graph, current_coloring, next_coloring);
+        bool is_stable_i = compute_next_matrix(current_coloring, next_coloring);
 
         std::swap(current_coloring, next_coloring);
 
@@ -167,6 +633,19 @@ std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman2D::
         {
             break;
         }
+
+        if (options)
+        {
+            const auto now = Clock::now();
+            const auto is_round_due = options->every_num_rounds > 0 && num_iterations % options->every_num_rounds == 0;
+            const auto is_time_due = options->every_num_seconds > 0 && std::chrono::duration<double>(now - last_checkpoint_time).count() >= options->every_num_seconds;
+
+            if (is_round_due || is_time_due)
+            {
+                write_checkpoint(graph, current_coloring, num_iterations, options->path);
+                last_checkpoint_time = now;
+            }
+        }
     }
 
     auto [unique, counts] = current_coloring.get_frequencies();
@@ -174,21 +653,101 @@ std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman2D::
     return { is_stable, num_iterations, std::move(unique), std::move(counts) };
 }
 
-GraphColoring WeisfeilerLeman2D::compute_initial_coloring(const EdgeColoredGraph& graph)
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>> WeisfeilerLeman2D<Mode>::compute_coloring(const EdgeColoredGraph& graph,
+                                                                                                       size_t max_num_iterations)
+{
+    return compute_coloring_parallel(graph, *ThreadPool::get_default(), max_num_iterations);
+}
+
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman2D<Mode>::compute_coloring_parallel(const EdgeColoredGraph& graph, ThreadPool& pool, size_t max_num_iterations)
+{
+    auto current_coloring = PairColorMatrix(m_options);
+
+    compute_initial_matrix(graph, pool, current_coloring);
+
+    return refine_matrix(std::move(current_coloring), 0, graph, nullptr, max_num_iterations);
+}
+
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman2D<Mode>::compute_coloring_with_checkpoints(const EdgeColoredGraph& graph, const CheckpointOptions& options, size_t max_num_iterations)
+{
+    auto current_coloring = PairColorMatrix(m_options);
+
+    compute_initial_matrix(graph, *ThreadPool::get_default(), current_coloring);
+
+    return refine_matrix(std::move(current_coloring), 0, graph, &options, max_num_iterations);
+}
+
+template<CountingMode Mode>
+std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+WeisfeilerLeman2D<Mode>::resume_coloring(const EdgeColoredGraph& graph, const std::string& path, const CheckpointOptions& options, size_t max_num_iterations)
+{
+    auto in = std::ifstream(path, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("resume_coloring: cannot open " + path);
+    }
+
+    if (read_binary<uint32_t>(in) != CHECKPOINT_MAGIC || read_binary<uint32_t>(in) != CHECKPOINT_VERSION)
+    {
+        throw std::runtime_error("resume_coloring: " + path + " is not a checkpoint of this version");
+    }
+    if (read_binary<uint8_t>(in) != get_ignore_counting())
+    {
+        throw std::invalid_argument("resume_coloring: the checkpoint was written with a different counting mode");
+    }
+    if (read_binary<uint64_t>(in) != graph.get_content_hash())
+    {
+        throw std::invalid_argument("resume_coloring: the checkpoint was written for a different graph");
+    }
+
+    const auto num_iterations = read_binary<uint64_t>(in);
+
+    auto current_coloring = PairColorMatrix(m_options);
+    current_coloring.read(in);
+    if (current_coloring.get_num_nodes() != graph.get_num_nodes())
+    {
+        throw std::runtime_error("resume_coloring: the checkpoint does not match the graph");
+    }
+
+    m_color_function->read(in);
+
+    return refine_matrix(std::move(current_coloring), num_iterations, graph, &options, max_num_iterations);
+}
+
+template<CountingMode Mode>
+GraphColoring WeisfeilerLeman2D<Mode>::compute_initial_coloring(const EdgeColoredGraph& graph)
+{
+    return compute_initial_coloring(graph, *ThreadPool::get_default());
+}
+
+template<CountingMode Mode>
+GraphColoring WeisfeilerLeman2D<Mode>::compute_initial_coloring(const EdgeColoredGraph& graph, ThreadPool& pool)
 {
     const auto num_nodes = graph.get_num_nodes();
+    const auto seed_labels = m_invariant_seeding ? compute_seed_labels(graph) : std::vector<int>();
+    auto atomic_types = AtomicTypes<Mode>(*m_color_function, graph, m_invariant_seeding ? seed_labels : graph.get_node_labels(), pool);
     auto current_coloring = std::vector<int>(num_nodes * num_nodes);
 
     for (int first_node = 0; first_node < num_nodes; ++first_node)
     {
+        atomic_types.begin_row(first_node);
+
         for (int second_node = 0; second_node < num_nodes; ++second_node)
         {
             const auto pair_index = index_of_pair(first_node, second_node, num_nodes);
-            current_coloring[pair_index] = get_subgraph_color(first_node, second_node, graph);
+            current_coloring[pair_index] = atomic_types.get_color(first_node, second_node);
         }
     }
 
     return GraphColoring { std::move(current_coloring) };
 }
 
+template class WeisfeilerLeman2D<CountingMode::MULTISET>;
+template class WeisfeilerLeman2D<CountingMode::SET>;
+
 }
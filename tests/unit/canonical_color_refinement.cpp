@@ -1,5 +1,6 @@
 #include "wl/details/canonical_color_refinement.hpp"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 
 namespace wl::tests
@@ -137,6 +138,225 @@ TEST(WLTests, Canonical)
     auto factor_matrix_2 = color_refinement2.get_quotient_matrix();
 
     EXPECT_NE(factor_matrix, factor_matrix_2);
+
+    // The flat partition lists the same cells with 0-based vertices
+    const auto& coloring = color_refinement2.get_coloring();
+    const auto& nodes = color_refinement2.get_partition_nodes();
+    const auto& offsets = color_refinement2.get_partition_offsets();
+    ASSERT_EQ(offsets.size(), coloring.size() + 1);
+    for (size_t c = 0; c < coloring.size(); ++c)
+    {
+        auto cell = std::set<int>();
+        for (int i = offsets[c]; i < offsets[c + 1]; ++i)
+        {
+            cell.insert(nodes[i] + 1);
+            EXPECT_EQ(color_refinement2.get_node_colors().at(nodes[i]), static_cast<int>(c) + 1);
+        }
+        EXPECT_EQ(cell, coloring[c]);
+    }
+
+    // A later call on a larger graph leaves the shared partition of the earlier call unchanged.
+    const auto partition = color_refinement2.get_partition();
+    const auto expected_nodes = partition->partition_nodes;
+    auto path = EdgeColoredGraph(false);
+    for (int i = 0; i < 100; ++i)
+        path.add_node(1);
+    for (int i = 0; i + 1 < 100; ++i)
+        path.add_edge(i, i + 1);
+    color_refinement2.calculate(path, true);
+    EXPECT_NE(color_refinement2.get_partition(), partition);
+    EXPECT_EQ(partition->partition_nodes, expected_nodes);
+    EXPECT_EQ(partition->node_colors.size(), graph2.get_num_nodes());
+}
+
+TEST(WLTests, CanonicalEquivalenceClasses)
+{
+    auto create_cycle = [](int num_nodes, int label)
+    {
+        auto graph = EdgeColoredGraph(false);
+        for (int i = 0; i < num_nodes; ++i)
+            graph.add_node(label);
+        for (int i = 0; i < num_nodes; ++i)
+            graph.add_edge(i, (i + 1) % num_nodes);
+        return graph;
+    };
+
+    auto create_path = [](int num_nodes)
+    {
+        auto graph = EdgeColoredGraph(false);
+        for (int i = 0; i < num_nodes; ++i)
+            graph.add_node(1);
+        for (int i = 0; i + 1 < num_nodes; ++i)
+            graph.add_edge(i, i + 1);
+        return graph;
+    };
+
+    // Two triangles and a 6-cycle are 1-WL equivalent, a path is not, and neither is a 6-cycle with another label
+    auto two_triangles = create_cycle(3, 1);
+    two_triangles.add_node(1);
+    two_triangles.add_node(1);
+    two_triangles.add_node(1);
+    two_triangles.add_edge(3, 4);
+    two_triangles.add_edge(4, 5);
+    two_triangles.add_edge(5, 3);
+    const auto cycle = create_cycle(6, 1);
+    const auto path = create_path(6);
+    const auto other_cycle = create_cycle(6, 2);
+    const auto triangle = create_cycle(3, 1);
+
+    auto color_refinement = CanonicalColorRefinement();
+    const auto result = color_refinement.calculate_equivalence_classes({ &cycle, &path, &two_triangles, &other_cycle, &triangle, &path });
+    EXPECT_EQ(result.class_ids, (std::vector<int> { 0, 1, 0, 2, 3, 1 }));
+    ASSERT_EQ(result.quotient_matrices.size(), 4);
+    EXPECT_EQ(result.quotient_matrices[0], (std::vector<QuotientEntry> { { 1, 1, 2 } }));
+    EXPECT_EQ(result.quotient_matrices[0], result.quotient_matrices[2]);
+
+    // The path has the classes of its ends (1), their neighbors (2), and the middle (3), in canonical order within the batch
+    EXPECT_EQ(result.quotient_matrices[1], (std::vector<QuotientEntry> { { 1, 2, 1 }, { 2, 1, 1 }, { 2, 3, 1 }, { 3, 2, 1 }, { 3, 3, 1 } }));
+}
+
+TEST(WLTests, CanonicalSparseQuotientMatrix)
+{
+    // A long path with a few chords has many colors, most of them with a single vertex.
+    auto graph = EdgeColoredGraph(false);
+    const int num_nodes = 200;
+    for (int i = 0; i < num_nodes; ++i)
+        graph.add_node(i % 7 == 0 ? 2 : 1);
+    for (int i = 0; i + 1 < num_nodes; ++i)
+        graph.add_edge(i, i + 1);
+    for (int i = 0; i + 13 < num_nodes; i += 11)
+        graph.add_edge(i, i + 13);
+
+    auto color_refinement = CanonicalColorRefinement();
+    color_refinement.calculate(graph, true);
+
+    // Dense reference: the out-neighbors of the smallest vertex of each color, counted per color
+    const auto& colors = color_refinement.get_node_colors();
+    const auto& nodes = color_refinement.get_partition_nodes();
+    const auto& offsets = color_refinement.get_partition_offsets();
+    const auto k = static_cast<int>(offsets.size()) - 1;
+    ASSERT_GT(k, num_nodes / 4);
+
+    auto expected = std::vector<QuotientEntry>();
+    for (int row = 1; row <= k; ++row)
+    {
+        auto frequency = std::vector<int>(k + 1, 0);
+        for (const auto& v : graph.get_outbound_adjacent(nodes[offsets[row - 1]]))
+            ++frequency[colors[v]];
+        for (int column = 1; column <= k; ++column)
+        {
+            if (frequency[column] > 0)
+                expected.push_back({ row, column, frequency[column] });
+        }
+    }
+    EXPECT_EQ(color_refinement.get_quotient_matrix(), expected);
+}
+
+TEST(WLTests, CanonicalParallelMatchesSerial)
+{
+    // Large enough for parallel color degrees of the initial cells and parallel splits of many colors at once.
+    const int num_nodes = 12000;
+    uint64_t state = 7;
+    const auto next = [&](int bound) { return static_cast<int>((state = state * 6364136223846793005ULL + 1442695040888963407ULL) >> 33) % bound; };
+
+    auto pool = ThreadPool(4);
+    for (const auto directed : { false, true })
+    {
+        auto graph = EdgeColoredGraph(directed);
+        for (int i = 0; i < num_nodes; ++i)
+            graph.add_node(1 + next(2));
+        for (int i = 0; i < 2 * num_nodes; ++i)
+            graph.add_edge(next(num_nodes), next(num_nodes));
+
+        for (const auto use_stack : { false, true })
+        {
+            auto serial = CanonicalColorRefinement(0, use_stack);
+            serial.calculate(graph, true);
+            auto parallel = CanonicalColorRefinement(0, use_stack);
+            parallel.calculate_parallel(graph, pool, true);
+
+            EXPECT_EQ(parallel.get_node_colors(), serial.get_node_colors());
+            EXPECT_EQ(parallel.get_partition_offsets(), serial.get_partition_offsets());
+            EXPECT_EQ(parallel.get_partition_nodes(), serial.get_partition_nodes());
+            EXPECT_EQ(parallel.get_quotient_matrix(), serial.get_quotient_matrix());
+        }
+    }
+}
+
+TEST(WLTests, CanonicalResultCache)
+{
+    auto graph = EdgeColoredGraph(false);
+    for (int i = 0; i < 60; ++i)
+        graph.add_node(i % 5 == 0 ? 2 : 1);
+    for (int i = 0; i + 1 < 60; ++i)
+        graph.add_edge(i, i + 1);
+    for (int i = 0; i + 7 < 60; i += 9)
+        graph.add_edge(i, i + 7);
+
+    auto alpha = std::vector<int>(60, 1);
+    alpha[3] = 2;
+
+    auto reference = CanonicalColorRefinement();
+    auto cached = CanonicalColorRefinement();
+    cached.set_cache_capacity(4);
+
+    const auto expect_equal = [&]
+    {
+        EXPECT_EQ(cached.get_coloring(), reference.get_coloring());
+        EXPECT_EQ(cached.get_node_colors(), reference.get_node_colors());
+        EXPECT_EQ(cached.get_partition_nodes(), reference.get_partition_nodes());
+        EXPECT_EQ(cached.get_partition_offsets(), reference.get_partition_offsets());
+        EXPECT_EQ(cached.get_quotient_matrix(), reference.get_quotient_matrix());
+    };
+
+    // A hit without a stored quotient matrix computes it, later hits restore it.
+    for (const auto calculate_qm : { false, true, true })
+    {
+        reference.calculate(graph, calculate_qm);
+        cached.calculate(graph, calculate_qm);
+        expect_equal();
+    }
+
+    // The initial coloring is part of the key.
+    reference.calculate(graph, alpha, true);
+    cached.calculate(graph, alpha, true);
+    expect_equal();
+    reference.calculate(graph, true);
+    cached.calculate(graph, true);
+    expect_equal();
+
+    const auto statistics = cached.get_cache_statistics();
+    EXPECT_EQ(statistics.num_hits, 3);
+    EXPECT_EQ(statistics.num_misses, 2);
+    EXPECT_EQ(statistics.size, 2);
+}
+
+TEST(WLTests, CanonicalInvariantSeeding)
+{
+    uint64_t state = 3;
+    const auto next = [&](int bound) { return static_cast<int>((state = state * 6364136223846793005ULL + 1442695040888963407ULL) >> 33) % bound; };
+
+    for (const auto directed : { false, true })
+    {
+        auto graph = EdgeColoredGraph(directed);
+        for (int i = 0; i < 200; ++i)
+            graph.add_node(1 + next(2));
+        for (int i = 0; i < 300; ++i)
+            graph.add_edge(next(200), next(200));
+
+        auto reference = CanonicalColorRefinement();
+        reference.calculate(graph);
+        auto seeded = CanonicalColorRefinement();
+        seeded.set_invariant_seeding(true);
+        seeded.calculate(graph);
+
+        // The same cells, possibly in another order
+        auto reference_cells = reference.get_coloring();
+        auto seeded_cells = seeded.get_coloring();
+        std::sort(reference_cells.begin(), reference_cells.end());
+        std::sort(seeded_cells.begin(), seeded_cells.end());
+        EXPECT_EQ(seeded_cells, reference_cells);
+    }
 }
 
 }
@@ -0,0 +1,92 @@
+#include "wl/details/canonical_labeling.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+namespace wl::tests
+{
+
+/// @brief Copy the graph with vertex v renamed to permutation[v].
+static EdgeColoredGraph permute(const EdgeColoredGraph& graph, const std::vector<int>& permutation)
+{
+    const int n = graph.get_num_nodes();
+    std::vector<int> inverse(n);
+    for (int v = 0; v < n; ++v)
+        inverse[permutation[v]] = v;
+
+    auto result = EdgeColoredGraph(graph.is_directed());
+    for (int v = 0; v < n; ++v)
+        result.add_node(graph.get_node_label(inverse[v]));
+    for (int v = 0; v < n; ++v)
+    {
+        for (const auto& w : graph.get_outbound_adjacent(v))
+        {
+            if (graph.is_directed() || v < w)
+                result.add_edge(permutation[v], permutation[w]);
+        }
+    }
+    return result;
+}
+
+static EdgeColoredGraph create_cycles(int num_cycles, int cycle_length)
+{
+    auto graph = EdgeColoredGraph(false);
+    for (int i = 0; i < num_cycles * cycle_length; ++i)
+        graph.add_node(1);
+    for (int c = 0; c < num_cycles; ++c)
+    {
+        for (int i = 0; i < cycle_length; ++i)
+            graph.add_edge(c * cycle_length + i, c * cycle_length + (i + 1) % cycle_length);
+    }
+    return graph;
+}
+
+TEST(WLTests, CanonicalLabelingDistinguishesRegularGraphs)
+{
+    const auto hexagon = create_cycles(1, 6);
+    const auto triangles = create_cycles(2, 3);
+
+    // 1-WL does not distinguish the graphs
+    auto refinement = CanonicalColorRefinement(0);
+    refinement.calculate(hexagon, true);
+    const auto hexagon_quotient = refinement.get_quotient_matrix_string();
+    refinement.calculate(triangles, true);
+    EXPECT_EQ(hexagon_quotient, refinement.get_quotient_matrix_string());
+
+    auto labeling = CanonicalLabeling();
+    const auto hexagon_form = labeling.calculate(hexagon);
+    EXPECT_FALSE(labeling.get_automorphism_generators().empty());
+    const auto triangles_form = labeling.calculate(triangles);
+    EXPECT_NE(hexagon_form, triangles_form);
+    EXPECT_NE(hexagon_form.hash, triangles_form.hash);
+}
+
+TEST(WLTests, CanonicalLabelingInvariantUnderPermutation)
+{
+    auto graph = EdgeColoredGraph(true);
+    for (int i = 0; i < 9; ++i)
+        graph.add_node(1 + i % 2);
+    for (int i = 0; i < 9; ++i)
+    {
+        graph.add_edge(i, (i + 1) % 9);
+        graph.add_edge(i, (i + 3) % 9);
+    }
+
+    auto labeling = CanonicalLabeling();
+    const auto form = labeling.calculate(graph);
+
+    auto permutation = std::vector<int>(graph.get_num_nodes());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    auto rng = std::mt19937(42);
+    for (int i = 0; i < 10; ++i)
+    {
+        std::shuffle(permutation.begin(), permutation.end(), rng);
+        const auto permuted_form = labeling.calculate(permute(graph, permutation));
+        EXPECT_EQ(form, permuted_form);
+        EXPECT_EQ(form.hash, permuted_form.hash);
+    }
+}
+
+}
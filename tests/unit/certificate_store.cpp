@@ -0,0 +1,81 @@
+#include "wl/details/certificate_store.hpp"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace wl::tests
+{
+
+static EdgeColoredGraph create_cycle(int num_nodes)
+{
+    auto graph = EdgeColoredGraph(false);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_node();
+    }
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_edge(i, (i + 1) % num_nodes);
+    }
+    return graph;
+}
+
+TEST(CertificateStoreTests, InsertAndFind)
+{
+    for (bool verify : { false, true })
+    {
+        auto options = CertificateStoreOptions();
+        options.num_bloom_filter_bits = 1 << 12;
+        options.verify = verify;
+        auto store = CertificateStore(options);
+
+        const auto a = CertificateStore::make_certificate({ 0, 1 }, { 3, 4 });
+        const auto b = CertificateStore::make_certificate({ 0, 1 }, { 4, 3 });
+        const auto c = CertificateStore::make_certificate(std::vector<QuotientEntry> { { 1, 1, 2 } });
+
+        EXPECT_FALSE(store.contains(a));
+        EXPECT_EQ(store.insert(a), std::make_pair(size_t(0), true));
+        EXPECT_EQ(store.insert(b), std::make_pair(size_t(1), true));
+        EXPECT_EQ(store.insert(a), std::make_pair(size_t(0), false));
+        EXPECT_EQ(store.find(b), 1);
+        EXPECT_FALSE(store.contains(c));
+        EXPECT_EQ(store.find(c), CertificateStore::NOT_FOUND);
+        EXPECT_EQ(store.size(), 2);
+    }
+}
+
+TEST(CertificateStoreTests, InsertColoringConcurrent)
+{
+    auto options = CertificateStoreOptions();
+    options.num_bloom_filter_bits = 1 << 16;
+    options.verify = true;
+    auto store = CertificateStore(options);
+    auto engine = WeisfeilerLeman(1);
+
+    // Cycles of different length have different 1-WL histograms, and each one is inserted by all threads
+    const int num_threads = 4;
+    const int num_graphs = 40;
+    auto num_inserted = std::vector<int>(num_threads, 0);
+    auto threads = std::vector<std::thread>();
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                for (int i = 0; i < num_graphs; ++i)
+                {
+                    const auto graph = create_cycle(3 + (i + t) % num_graphs);
+                    num_inserted[t] += store.insert_coloring(engine, graph).second ? 1 : 0;
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(store.size(), num_graphs);
+    EXPECT_EQ(num_inserted[0] + num_inserted[1] + num_inserted[2] + num_inserted[3], num_graphs);
+}
+
+}
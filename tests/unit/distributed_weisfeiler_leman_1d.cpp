@@ -0,0 +1,182 @@
+#include "random_graph.hpp"
+#include "wl/details/distributed_weisfeiler_leman_1d.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace wl::tests
+{
+
+/// @brief Run the coordinator on the calling thread and one thread per worker, which keep their shards in ref_shards.
+template<typename T>
+static std::tuple<bool, size_t, std::vector<int>, std::vector<int>> compute_distributed(const std::vector<GraphPartition>& partitions,
+                                                                                       bool ignore_counting,
+                                                                                       std::vector<std::unique_ptr<T>>& ref_transports,
+                                                                                       DistributedWeisfeilerLeman1D& ref_coordinator,
+                                                                                       std::vector<ColorFunctionShard>& ref_shards)
+{
+    const auto num_workers = static_cast<int>(partitions.size());
+    ref_shards.resize(num_workers);
+    auto threads = std::vector<std::thread>();
+    for (int w = 0; w < num_workers; ++w)
+    {
+        threads.emplace_back([&, w]() { run_weisfeiler_leman_1d_worker(*ref_transports[w + 1], partitions[w], ref_shards[w], ignore_counting); });
+    }
+    auto result = ref_coordinator.compute_coloring(*ref_transports[0]);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return result;
+}
+
+template<typename T>
+static std::tuple<bool, size_t, std::vector<int>, std::vector<int>>
+compute_distributed(const EdgeColoredGraph& graph, int num_workers, bool ignore_counting, std::vector<std::unique_ptr<T>>& ref_transports)
+{
+    auto coordinator = DistributedWeisfeilerLeman1D(ignore_counting);
+    auto shards = std::vector<ColorFunctionShard>();
+    return compute_distributed(partition_graph(graph, num_workers), ignore_counting, ref_transports, coordinator, shards);
+}
+
+static std::vector<std::unique_ptr<InProcessTransport>> create_transports(int num_ranks)
+{
+    auto network = std::make_shared<InProcessNetwork>(num_ranks);
+    auto transports = std::vector<std::unique_ptr<InProcessTransport>>();
+    for (int rank = 0; rank < num_ranks; ++rank)
+    {
+        transports.push_back(std::make_unique<InProcessTransport>(network, rank));
+    }
+    return transports;
+}
+
+TEST(DistributedWLTests, MatchesSerial)
+{
+    auto rng = std::mt19937(0);
+
+    for (int trial = 0; trial < 40; ++trial)
+    {
+        const auto num_nodes = 1 + static_cast<int>(rng() % 30);
+        const auto graph = create_random_graph(num_nodes, static_cast<int>(rng() % (2 * num_nodes)), trial % 2 == 1, rng);
+
+        for (bool ignore_counting : { false, true })
+        {
+            auto serial = WeisfeilerLeman(1, ignore_counting);
+            const auto expected = serial.compute_coloring(graph);
+
+            for (int num_workers : { 1, 3, 7 })
+            {
+                auto transports = create_transports(num_workers + 1);
+                EXPECT_EQ(compute_distributed(graph, num_workers, ignore_counting, transports), expected);
+            }
+        }
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(DistributedWLTests, SocketTransport)
+{
+    auto rng = std::mt19937(1);
+    const auto graph = create_random_graph(200, 400, true, rng);
+    const int num_workers = 4;
+
+    auto serial = WeisfeilerLeman(1);
+    const auto expected = serial.compute_coloring(graph);
+
+    auto sockets = SocketTransport::create_socket_mesh(num_workers + 1);
+    auto transports = std::vector<std::unique_ptr<SocketTransport>>();
+    for (int rank = 0; rank <= num_workers; ++rank)
+    {
+        transports.push_back(std::make_unique<SocketTransport>(rank, sockets[rank]));
+    }
+    EXPECT_EQ(compute_distributed(graph, num_workers, false, transports), expected);
+}
+#endif
+
+TEST(DistributedWLTests, SpreadsColorFunction)
+{
+    auto rng = std::mt19937(2);
+    const auto graphs = std::vector<EdgeColoredGraph> { create_random_graph(300, 500, false, rng), create_random_graph(200, 400, true, rng) };
+    const int num_workers = 4;
+
+    // One coordinator and the same shards for both graphs continue one color function, like a serial engine.
+    auto serial = WeisfeilerLeman(1);
+    auto coordinator = DistributedWeisfeilerLeman1D();
+    auto shards = std::vector<ColorFunctionShard>();
+    for (const auto& graph : graphs)
+    {
+        auto transports = create_transports(num_workers + 1);
+        EXPECT_EQ(compute_distributed(partition_graph(graph, num_workers), false, transports, coordinator, shards), serial.compute_coloring(graph));
+    }
+
+    // Every context is in exactly one shard, and no worker holds all of them.
+    size_t total_size = 0;
+    for (const auto& shard : shards)
+    {
+        EXPECT_LT(shard.size(), coordinator.get_coloring_function_size());
+        total_size += shard.size();
+    }
+    EXPECT_EQ(total_size, coordinator.get_coloring_function_size());
+    EXPECT_EQ(total_size, serial.get_coloring_function_size());
+}
+
+TEST(DistributedWLTests, DistributeGraph)
+{
+    auto rng = std::mt19937(3);
+    const int num_workers = 3;
+
+    for (bool directed : { false, true })
+    {
+        const auto graph = create_random_graph(50, 120, directed, rng);
+        const auto boundaries = get_partition_boundaries(graph.get_num_nodes(), num_workers);
+
+        // Each worker reads every num_workers-th edge and the labels of its vertices, as if from its own slice of the input files.
+        auto edges = std::vector<std::vector<LabeledEdge>>(num_workers);
+        size_t num_edges = 0;
+        for (int u = 0; u < graph.get_num_nodes(); ++u)
+        {
+            const auto& adjacent = graph.get_outbound_adjacent(u);
+            const auto& edge_ids = graph.get_outbound_edges(u);
+            for (size_t k = 0; k < adjacent.size(); ++k)
+            {
+                // Undirected edges are stored in both directions with consecutive ids, of which we take the first.
+                if (directed || edge_ids[k] % 2 == 0)
+                    edges[num_edges++ % num_workers].push_back(LabeledEdge { u, adjacent[k], graph.get_edge_label(edge_ids[k]) });
+            }
+        }
+
+        auto transports = create_transports(num_workers + 1);
+        auto partitions = std::vector<GraphPartition>(num_workers);
+        auto threads = std::vector<std::thread>();
+        for (int w = 0; w < num_workers; ++w)
+        {
+            threads.emplace_back(
+                [&, w]()
+                {
+                    auto node_labels = std::vector<int>(graph.get_node_labels().begin() + boundaries[w], graph.get_node_labels().begin() + boundaries[w + 1]);
+                    partitions[w] = distribute_graph(*transports[w + 1], graph.get_num_nodes(), directed, std::move(node_labels), edges[w]);
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        // Same adjacency as partition_graph up to the order of the neighbors of each vertex
+        const auto expected = partition_graph(graph, num_workers);
+        for (int w = 0; w < num_workers; ++w)
+        {
+            EXPECT_EQ(partitions[w].node_labels, expected[w].node_labels);
+            EXPECT_EQ(partitions[w].outbound_offsets, expected[w].outbound_offsets);
+            EXPECT_EQ(partitions[w].inbound_offsets, expected[w].inbound_offsets);
+        }
+
+        auto coordinator = DistributedWeisfeilerLeman1D();
+        auto shards = std::vector<ColorFunctionShard>();
+        EXPECT_EQ(compute_distributed(partitions, false, transports, coordinator, shards), WeisfeilerLeman(1).compute_coloring(graph));
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+#include "wl/details/graph_io.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace wl::tests
+{
+
+static std::string write_temporary_file(const std::string& name, const std::string& contents)
+{
+    const auto path = (std::filesystem::temp_directory_path() / ("wl_graph_io_" + name)).string();
+    auto stream = std::ofstream(path, std::ios::binary);
+    stream << contents;
+    return path;
+}
+
+static std::vector<std::pair<int, int>> get_undirected_edges(const EdgeColoredGraph& graph)
+{
+    auto edges = std::vector<std::pair<int, int>>();
+    for (int u = 0; u < graph.get_num_nodes(); ++u)
+    {
+        for (const auto& v : graph.get_outbound_adjacent(u))
+        {
+            if (u <= v)
+                edges.emplace_back(u, v);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+TEST(GraphIOTests, Graph6)
+{
+    // Petersen graph
+    const auto petersen = parse_graph6("IheA@GUAo");
+    EXPECT_EQ(petersen.get_num_nodes(), 10);
+    EXPECT_EQ(get_undirected_edges(petersen).size(), 15);
+    for (int v = 0; v < 10; ++v)
+    {
+        EXPECT_EQ(petersen.get_outbound_adjacent(v).size(), 3);
+    }
+
+    // Example of the sparse6 specification
+    const auto sparse = parse_graph6(":Fa@x^");
+    EXPECT_EQ(sparse.get_num_nodes(), 7);
+    EXPECT_EQ(get_undirected_edges(sparse), (std::vector<std::pair<int, int>> { { 0, 1 }, { 0, 2 }, { 1, 2 }, { 5, 6 } }));
+
+    // Many lines are split among threads, but the graphs keep their order
+    auto contents = std::string(">>graph6<<IheA@GUAo\n");
+    for (int i = 0; i < 100; ++i)
+    {
+        contents += (i % 2 == 0) ? ":Fa@x^\n" : "IheA@GUAo\r\n";
+    }
+    const auto graphs = read_graphs(write_temporary_file("graphs.g6", contents), false, 4);
+    ASSERT_EQ(graphs.size(), 101);
+    for (size_t i = 1; i < graphs.size(); ++i)
+    {
+        EXPECT_EQ(graphs[i].get_num_nodes(), (i % 2 == 1) ? 7 : 10);
+    }
+}
+
+TEST(GraphIOTests, DimacsAndEdgeList)
+{
+    const auto dimacs = read_graphs(write_temporary_file("graph.dimacs", "c triangle with a pendant vertex\np edge 4 4\ne 1 2\ne 2 3\ne 3 1\ne 3 4 2\nn 4 7\n"), true, 3);
+    ASSERT_EQ(dimacs.size(), 1);
+    const auto& graph = dimacs[0];
+    EXPECT_TRUE(graph.is_directed());
+    EXPECT_EQ(graph.get_num_nodes(), 4);
+    EXPECT_EQ(graph.get_num_edges(), 4);
+    EXPECT_EQ(graph.get_node_labels(), (std::vector<int> { 0, 0, 0, 7 }));
+    EXPECT_EQ(graph.get_edge_label(graph.get_edges(2, 3).at(0)), 2);
+
+    const auto edge_list = read_edge_list(write_temporary_file("graph.txt", "# comment\n0 1\n1 2\n2 0\n2 3 2\nn 3 7\n"), true, 2);
+    EXPECT_EQ(edge_list.get_num_nodes(), 4);
+    EXPECT_EQ(edge_list.get_node_labels(), graph.get_node_labels());
+    EXPECT_EQ(edge_list.get_edge_labels(), graph.get_edge_labels());
+    for (int v = 0; v < 4; ++v)
+    {
+        EXPECT_EQ(edge_list.get_outbound_adjacent(v), graph.get_outbound_adjacent(v));
+    }
+
+    EXPECT_THROW(read_edge_list(write_temporary_file("invalid.txt", "0 x\n")), std::runtime_error);
+
+    // Vertices out of range, including ones whose count v + 1 would overflow
+    EXPECT_THROW(read_dimacs(write_temporary_file("invalid.dimacs", "n 0 5\n")), std::runtime_error);
+    EXPECT_THROW(read_dimacs(write_temporary_file("invalid.dimacs", "e -2147483648 1\n")), std::runtime_error);
+    EXPECT_THROW(read_edge_list(write_temporary_file("invalid.txt", "n -1 5\n")), std::runtime_error);
+    EXPECT_THROW(read_edge_list(write_temporary_file("invalid.txt", "0 2147483647\n")), std::runtime_error);
+}
+
+}
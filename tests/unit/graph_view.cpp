@@ -0,0 +1,83 @@
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <gtest/gtest.h>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace wl::tests
+{
+
+/// @brief A user graph type in compressed sparse row form that is colored as a GraphView without conversion.
+struct CsrGraph
+{
+    bool directed;
+    std::vector<int> labels;
+    std::vector<int> outbound_offsets;
+    std::vector<std::pair<int, int>> outbound;  // (neighbor, edge label)
+    std::vector<int> inbound_offsets;
+    std::vector<std::pair<int, int>> inbound;
+
+    int get_num_nodes() const { return static_cast<int>(labels.size()); }
+    int get_node_label(int node) const { return labels[node]; }
+    bool is_directed() const { return directed; }
+
+    static auto get_neighbors(const std::vector<int>& offsets, const std::vector<std::pair<int, int>>& adjacency, int node)
+    {
+        return std::ranges::subrange(adjacency.begin() + offsets[node], adjacency.begin() + offsets[node + 1])
+               | std::views::transform([](const std::pair<int, int>& entry) { return LabeledNeighbor { entry.first, entry.second }; });
+    }
+
+    auto get_outbound_neighbors(int node) const { return get_neighbors(outbound_offsets, outbound, node); }
+    auto get_inbound_neighbors(int node) const { return get_neighbors(inbound_offsets, inbound, node); }
+};
+
+static_assert(GraphView<CsrGraph>);
+
+static CsrGraph to_csr(const EdgeColoredGraph& graph)
+{
+    auto csr = CsrGraph { graph.is_directed(), graph.get_node_labels(), { 0 }, {}, { 0 }, {} };
+    for (int node = 0; node < graph.get_num_nodes(); ++node)
+    {
+        for (const auto& [neighbor, label] : graph.get_outbound_neighbors(node))
+            csr.outbound.emplace_back(neighbor, label);
+        for (const auto& [neighbor, label] : graph.get_inbound_neighbors(node))
+            csr.inbound.emplace_back(neighbor, label);
+        csr.outbound_offsets.push_back(static_cast<int>(csr.outbound.size()));
+        csr.inbound_offsets.push_back(static_cast<int>(csr.inbound.size()));
+    }
+    return csr;
+}
+
+TEST(GraphViewTests, MatchesEdgeColoredGraph)
+{
+    for (bool directed : { false, true })
+    {
+        auto graph = EdgeColoredGraph(directed);
+        for (int i = 0; i < 12; ++i)
+        {
+            graph.add_node(i % 4 == 0 ? 1 : 0);
+        }
+        for (int i = 0; i < 12; ++i)
+        {
+            graph.add_edge(i, (i + 1) % 12, i % 3 == 0 ? 1 : 0);
+            graph.add_edge(i, (i + 5) % 12);
+        }
+        const auto csr = to_csr(graph);
+
+        for (bool ignore_counting : { false, true })
+        {
+            auto engine = WeisfeilerLeman(1, ignore_counting);
+            const auto expected = engine.compute_coloring(graph);
+            const auto size = engine.get_coloring_function_size();
+
+            // Same color function, so the view must reproduce the colors without adding any.
+            EXPECT_EQ(engine.compute_coloring(csr), expected);
+            EXPECT_EQ(engine.get_coloring_function_size(), size);
+        }
+    }
+
+    EXPECT_THROW(WeisfeilerLeman(2).compute_coloring(to_csr(EdgeColoredGraph(false))), std::logic_error);
+}
+
+}
@@ -0,0 +1,99 @@
+#include "random_graph.hpp"
+#include "wl/details/canonical_color_refinement.hpp"
+#include "wl/details/job_queue.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace wl::tests
+{
+
+TEST(JobQueueTests, ColoringMatchesSerial)
+{
+    auto rng = std::mt19937(0);
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for (int i = 0; i < 30; ++i)
+    {
+        const auto num_nodes = (i % 10 == 0) ? 600 : 5 + static_cast<int>(rng() % 50);
+        graphs.push_back(create_random_graph(num_nodes, 2 * num_nodes, i % 2 == 1, rng));
+    }
+
+    auto pool = std::make_shared<ThreadPool>(4);
+    auto queue = JobQueue(pool, 500);
+
+    for (bool ignore_counting : { false, true })
+    {
+        // The serial runs fill the color function, so the jobs find all contexts and yield exactly the same colors
+        auto engine = WeisfeilerLeman(1, ignore_counting);
+        auto expected = std::vector<ColoringResult>();
+        for (const auto& graph : graphs)
+        {
+            expected.push_back(engine.compute_coloring(graph));
+        }
+
+        auto futures = std::vector<std::future<ColoringResult>>();
+        for (const auto& graph : graphs)
+        {
+            futures.push_back(queue.submit_coloring(engine, graph));
+        }
+        for (size_t i = 0; i < graphs.size(); ++i)
+        {
+            EXPECT_EQ(futures[i].get(), expected[i]);
+        }
+
+        // With a fresh color function, split jobs may name the colors differently, but the partition is the same
+        auto fresh_engine = WeisfeilerLeman(1, ignore_counting);
+        auto [is_stable, num_iterations, unique, counts] = fresh_engine.compute_coloring_parallel(graphs[0], *pool);
+        auto expected_counts = std::get<3>(expected[0]);
+        std::sort(counts.begin(), counts.end());
+        std::sort(expected_counts.begin(), expected_counts.end());
+        EXPECT_EQ(is_stable, std::get<0>(expected[0]));
+        EXPECT_EQ(num_iterations, std::get<1>(expected[0]));
+        EXPECT_EQ(counts, expected_counts);
+    }
+}
+
+TEST(JobQueueTests, PairColoringOnPool)
+{
+    auto rng = std::mt19937(2);
+    const auto graph = create_random_graph(520, 1040, false, rng);
+
+    // The atomic types are built in sub-tasks of a task of the pool, but colored in row-major order, so the colors do not depend on the pool.
+    // A pool with one thread builds them in a single task.
+    auto pool = ThreadPool(4);
+    auto engine = WeisfeilerLeman2D<CountingMode::MULTISET>();
+    auto future = pool.submit([&]() { return engine.compute_initial_coloring(graph, pool); });
+
+    auto serial_pool = ThreadPool(1);
+    auto serial_engine = WeisfeilerLeman2D<CountingMode::MULTISET>();
+    EXPECT_EQ(future.get().colorings, serial_engine.compute_initial_coloring(graph, serial_pool).colorings);
+}
+
+TEST(JobQueueTests, Refinement)
+{
+    auto rng = std::mt19937(1);
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for (int i = 0; i < 20; ++i)
+    {
+        graphs.push_back(create_random_graph(5 + i, 10 + 2 * i, false, rng, { .min_node_label = 1, .num_edge_labels = 1 }));
+    }
+
+    auto queue = JobQueue(std::make_shared<ThreadPool>(3));
+    auto futures = std::vector<std::future<RefinementResult>>();
+    for (const auto& graph : graphs)
+    {
+        futures.push_back(queue.submit_refinement(graph));
+    }
+
+    auto color_refinement = CanonicalColorRefinement();
+    for (size_t i = 0; i < graphs.size(); ++i)
+    {
+        color_refinement.calculate(graphs[i], true);
+        const auto result = futures[i].get();
+        EXPECT_EQ(result.coloring, color_refinement.get_coloring());
+        EXPECT_EQ(result.quotient_matrix, color_refinement.get_quotient_matrix());
+    }
+}
+
+}
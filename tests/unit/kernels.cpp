@@ -0,0 +1,112 @@
+#include "wl/details/kernels.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+
+namespace wl::tests
+{
+
+TEST(KernelTests, SortAdjacentColors)
+{
+    auto rng = std::mt19937(11);
+    const auto next = [&]() { return static_cast<int>(rng()); };
+
+    // Short vectors are sorted as pairs, long ones as packed keys, both with negative and extreme colors.
+    for (const size_t size : { 0, 5, 64, 1000 })
+    {
+        auto colors = std::vector<AdjacentColor>();
+        for (size_t i = 0; i < size; ++i)
+            colors.emplace_back(next() % 7, next());
+        if (size > 0)
+        {
+            colors.emplace_back(INT_MIN, INT_MAX);
+            colors.emplace_back(INT_MAX, INT_MIN);
+        }
+
+        auto expected = colors;
+        std::sort(expected.begin(), expected.end());
+        sort_adjacent_colors(colors);
+        EXPECT_EQ(colors, expected);
+    }
+}
+
+TEST(KernelTests, IsShiftedCopy)
+{
+    auto first = std::vector<int>(3000);
+    for (size_t i = 0; i < first.size(); ++i)
+        first[i] = static_cast<int>(i % 17);
+
+    auto second = first;
+    for (auto& color : second)
+        color += 5;
+    EXPECT_TRUE(is_shifted_copy(first.data(), second.data(), first.size(), 5));
+    EXPECT_FALSE(is_shifted_copy(first.data(), second.data(), first.size(), 4));
+
+    // A mismatch in the last partial block
+    second.back() += 1;
+    EXPECT_FALSE(is_shifted_copy(first.data(), second.data(), first.size(), 5));
+    EXPECT_TRUE(is_shifted_copy(first.data(), second.data(), first.size() - 1, 5));
+
+    // The addition wraps around
+    const auto low = std::vector<int> { INT_MIN, 0 };
+    const auto high = std::vector<int> { INT_MAX, -1 };
+    EXPECT_TRUE(is_shifted_copy(low.data(), high.data(), low.size(), -1));
+}
+
+TEST(KernelTests, CountColors)
+{
+    // Dense colors are counted in an array, sparse ones in a hash map
+    for (const auto spread : { 1, 100000 })
+    {
+        auto colors = std::vector<int>();
+        auto expected = std::map<int, int>();
+        for (int i = 0; i < 500; ++i)
+        {
+            const auto color = (i * i % 37 - 18) * spread;
+            colors.push_back(color);
+            ++expected[color];
+        }
+
+        auto unique = std::vector<int>();
+        auto counts = std::vector<int>();
+        count_colors(colors, unique, counts);
+
+        auto actual = std::map<int, int>();
+        for (size_t i = 0; i < unique.size(); ++i)
+            actual.emplace(unique[i], counts[i]);
+        EXPECT_EQ(unique.size(), expected.size());
+        EXPECT_EQ(actual, expected);
+    }
+
+    auto unique = std::vector<int> { 1 };
+    auto counts = std::vector<int> { 1 };
+    count_colors({}, unique, counts);
+    EXPECT_TRUE(unique.empty());
+    EXPECT_TRUE(counts.empty());
+}
+
+TEST(KernelTests, ComposePairColors)
+{
+    const int num_nodes = 5;
+    const auto palette = std::vector<Color> { 10, 20, 30, 40 };
+    auto data = std::vector<uint16_t>(num_nodes * num_nodes);
+    for (size_t index = 0; index < data.size(); ++index)
+        data[index] = static_cast<uint16_t>(index % palette.size());
+
+    const int i = 1;
+    const int j = 3;
+    auto compositions = std::vector<AdjacentColor>(num_nodes);
+    compose_pair_colors(data.data() + i * num_nodes, data.data() + j, num_nodes, palette.data(), num_nodes, compositions.data());
+    for (int k = 0; k < num_nodes; ++k)
+    {
+        EXPECT_EQ(compositions[k], AdjacentColor(palette[data[i * num_nodes + k]], palette[data[k * num_nodes + j]]));
+    }
+
+    const auto target = get_kernel_target();
+    EXPECT_TRUE(target == "x86-64-v4" || target == "x86-64-v3" || target == "default") << target;
+}
+
+}
@@ -0,0 +1,139 @@
+#include "wl/details/min_hash.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <map>
+
+namespace wl::tests
+{
+
+/// @brief A path with node labels 0, 1, 2 in turn, except that the label of one node may be changed.
+static EdgeColoredGraph create_path(int num_nodes, int changed_node = -1)
+{
+    auto graph = EdgeColoredGraph(false);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_node(i == changed_node ? 3 : i % 3);
+    }
+    for (int i = 0; i + 1 < num_nodes; ++i)
+    {
+        graph.add_edge(i, i + 1);
+    }
+    return graph;
+}
+
+/// @brief A complete graph with equally labeled nodes.
+static EdgeColoredGraph create_clique(int num_nodes, int label = 0)
+{
+    auto graph = EdgeColoredGraph(false);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_node(label);
+    }
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        for (int j = i + 1; j < num_nodes; ++j)
+        {
+            graph.add_edge(i, j);
+        }
+    }
+    return graph;
+}
+
+static std::vector<GraphColoring> compute_rounds(WeisfeilerLeman& engine, const EdgeColoredGraph& graph, size_t max_num_iterations)
+{
+    auto rounds = std::vector<GraphColoring> { engine.compute_initial_coloring(graph) };
+    for (size_t i = 0; i < max_num_iterations; ++i)
+    {
+        auto next_coloring = rounds.back();
+        const auto is_stable = engine.compute_next_coloring(graph, rounds.back(), next_coloring);
+        rounds.push_back(std::move(next_coloring));
+        if (is_stable)
+            break;
+    }
+    return rounds;
+}
+
+/// @brief Exact weighted Jaccard similarity of the multisets of (round, color).
+static double compute_similarity(const std::vector<GraphColoring>& first_rounds, const std::vector<GraphColoring>& second_rounds)
+{
+    auto counts = std::map<std::pair<size_t, int>, std::pair<int, int>>();
+    for (size_t round = 0; round < first_rounds.size(); ++round)
+    {
+        for (const auto color : first_rounds[round].colorings)
+        {
+            ++counts[{ round, color }].first;
+        }
+    }
+    for (size_t round = 0; round < second_rounds.size(); ++round)
+    {
+        for (const auto color : second_rounds[round].colorings)
+        {
+            ++counts[{ round, color }].second;
+        }
+    }
+
+    double num_min = 0;
+    double num_max = 0;
+    for (const auto& [element, count] : counts)
+    {
+        num_min += std::min(count.first, count.second);
+        num_max += std::max(count.first, count.second);
+    }
+    return num_min / num_max;
+}
+
+TEST(MinHashTests, EstimatesWeightedJaccard)
+{
+    const size_t max_num_iterations = 3;
+    auto engine = WeisfeilerLeman(1);
+    const auto sketcher = MinHashSketcher(512, 7);
+
+    const auto path = create_path(300);
+    const auto [is_stable, num_iterations, sketch] = sketcher.compute_sketch(engine, path, max_num_iterations);
+    EXPECT_FALSE(is_stable);
+    EXPECT_EQ(num_iterations, max_num_iterations);
+    EXPECT_EQ(sketch.values.size(), 512);
+
+    // Sketching inside the coloring loop equals sketching the rounds afterwards.
+    const auto path_rounds = compute_rounds(engine, path, max_num_iterations);
+    EXPECT_EQ(sketch, sketcher.compute_sketch(path_rounds));
+    EXPECT_EQ(sketch.estimate_similarity(std::get<2>(sketcher.compute_sketch(engine, create_path(300), max_num_iterations))), 1.0);
+
+    for (const auto& other : { create_path(300, 150), create_path(250), create_path(100), create_clique(20) })
+    {
+        const auto exact = compute_similarity(path_rounds, compute_rounds(engine, other, max_num_iterations));
+        const auto estimate = sketch.estimate_similarity(std::get<2>(sketcher.compute_sketch(engine, other, max_num_iterations)));
+        EXPECT_NEAR(estimate, exact, 0.1) << exact;
+    }
+}
+
+TEST(MinHashTests, IndexReturnsNearDuplicates)
+{
+    const size_t max_num_iterations = 3;
+    auto engine = WeisfeilerLeman(1);
+    const auto sketcher = MinHashSketcher(128);
+    auto index = MinHashIndex(32, 4);
+
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for (int label = 4; label < 8; ++label)
+    {
+        graphs.push_back(create_clique(10 * label, label));
+    }
+    graphs.push_back(create_path(400));
+
+    for (size_t id = 0; id < graphs.size(); ++id)
+    {
+        EXPECT_EQ(index.insert(std::get<2>(sketcher.compute_sketch(engine, graphs[id], max_num_iterations))), id);
+    }
+    EXPECT_EQ(index.size(), graphs.size());
+
+    // A path with one changed label shares almost all colors with the indexed path and none with the cliques of other labels.
+    const auto query = std::get<2>(sketcher.compute_sketch(engine, create_path(400, 200), max_num_iterations));
+    EXPECT_EQ(index.query(query), (std::vector<size_t> { 4 }));
+    EXPECT_EQ(index.query(std::get<2>(sketcher.compute_sketch(engine, graphs[2], max_num_iterations))), (std::vector<size_t> { 2 }));
+
+    EXPECT_THROW(index.query(MinHashSketch { std::vector<uint64_t>(64) }), std::invalid_argument);
+}
+
+}
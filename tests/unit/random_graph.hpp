@@ -0,0 +1,46 @@
+#ifndef WL_TESTS_RANDOM_GRAPH_HPP_
+#define WL_TESTS_RANDOM_GRAPH_HPP_
+
+#include "wl/details/edge_colored_graph.hpp"
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+
+namespace wl::tests
+{
+
+struct RandomGraphOptions
+{
+    int min_node_label = 0;   // Node labels are in [min_node_label, min_node_label + num_node_labels)
+    int num_node_labels = 2;  //
+    int num_edge_labels = 2;  // Edge labels are in [0, num_edge_labels)
+    bool simple = true;       // Skip self-loops and edges between nodes that are already adjacent in either direction
+};
+
+/// @brief A graph with num_edges random edges, or fewer if it is simple.
+inline EdgeColoredGraph create_random_graph(int num_nodes, int num_edges, bool directed, std::mt19937& ref_rng, const RandomGraphOptions& options = RandomGraphOptions())
+{
+    auto graph = EdgeColoredGraph(directed);
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_node(options.min_node_label + static_cast<int>(ref_rng() % options.num_node_labels));
+    }
+    auto edges = std::set<std::pair<int, int>>();
+    for (int i = 0; i < num_edges; ++i)
+    {
+        const auto u = static_cast<int>(ref_rng() % num_nodes);
+        const auto v = static_cast<int>(ref_rng() % num_nodes);
+        const auto label = static_cast<int>(ref_rng() % options.num_edge_labels);
+        if (!options.simple || (u != v && edges.emplace(std::min(u, v), std::max(u, v)).second))
+        {
+            graph.add_edge(u, v, label);
+        }
+    }
+    return graph;
+}
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "wl/details/relational_weisfeiler_leman.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+namespace wl::tests
+{
+
+/// @brief A state of gripper: rooms, balls, and grippers with the robot in room A.
+static RelationalStructure create_gripper_state()
+{
+    enum Predicate
+    {
+        ROOM,
+        BALL,
+        GRIPPER,
+        AT_ROBBY,
+        AT,
+        FREE,
+        CARRY
+    };
+
+    auto structure = RelationalStructure();
+    const auto room_a = structure.add_object();
+    const auto room_b = structure.add_object();
+    const auto left = structure.add_object();
+    const auto right = structure.add_object();
+    auto balls = std::vector<int>();
+    for (int i = 0; i < 4; ++i)
+    {
+        balls.push_back(structure.add_object());
+    }
+
+    structure.add_atom(ROOM, { room_a });
+    structure.add_atom(ROOM, { room_b });
+    structure.add_atom(GRIPPER, { left });
+    structure.add_atom(GRIPPER, { right });
+    for (const auto ball : balls)
+    {
+        structure.add_atom(BALL, { ball });
+    }
+    structure.add_atom(AT_ROBBY, { room_a });
+    structure.add_atom(AT, { balls[0], room_a });
+    structure.add_atom(AT, { balls[1], room_a });
+    structure.add_atom(AT, { balls[2], room_b });
+    structure.add_atom(CARRY, { balls[3], left });
+    structure.add_atom(FREE, { right });
+    return structure;
+}
+
+/// @brief A random structure with unary, binary, and ternary atoms, including repeated arguments.
+static RelationalStructure create_random_structure(int num_objects, int num_atoms, std::mt19937& ref_rng)
+{
+    const auto next = [&](int bound) { return static_cast<int>(ref_rng() % bound); };
+
+    auto structure = RelationalStructure();
+    for (int i = 0; i < num_objects; ++i)
+    {
+        structure.add_object(next(2));
+    }
+    for (int i = 0; i < num_atoms; ++i)
+    {
+        auto arguments = std::vector<int>(1 + next(3));
+        for (auto& argument : arguments)
+        {
+            argument = next(num_objects);
+        }
+        structure.add_atom(next(3), arguments);
+    }
+    return structure;
+}
+
+/// @brief The stable coloring of the objects by relational 1-WL.
+static GraphColoring compute_stable_object_coloring(RelationalWeisfeilerLeman& engine, const RelationalStructure& structure)
+{
+    auto current_coloring = engine.compute_initial_coloring(structure);
+    auto next_coloring = current_coloring;
+    while (!engine.compute_next_coloring(structure, current_coloring, next_coloring))
+    {
+        std::swap(current_coloring, next_coloring);
+    }
+    return next_coloring;
+}
+
+/// @brief The stable coloring of the objects by 1-WL on the encoding with auxiliary nodes.
+static GraphColoring compute_stable_encoded_coloring(const RelationalStructure& structure, bool ignore_counting)
+{
+    const auto graph = structure.to_graph();
+    auto engine = WeisfeilerLeman(1, ignore_counting);
+    auto current_coloring = engine.compute_initial_coloring(graph);
+    auto next_coloring = current_coloring;
+    while (!engine.compute_next_coloring(graph, current_coloring, next_coloring))
+    {
+        std::swap(current_coloring, next_coloring);
+    }
+    next_coloring.colorings.resize(structure.get_num_objects());
+    return next_coloring;
+}
+
+TEST(RelationalWLTests, GripperState)
+{
+    const auto structure = create_gripper_state();
+    EXPECT_EQ(structure.get_num_objects(), 8);
+    EXPECT_EQ(structure.get_num_atoms(), 14);
+    EXPECT_EQ(std::vector<int>(structure.get_arguments(9).begin(), structure.get_arguments(9).end()), (std::vector<int> { 4, 0 }));
+
+    auto engine = RelationalWeisfeilerLeman();
+    const auto coloring = compute_stable_object_coloring(engine, structure);
+
+    // The two balls in room A are the only objects that cannot be told apart.
+    const auto& colors = coloring.colorings;
+    EXPECT_EQ(colors[4], colors[5]);
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = i + 1; j < 8; ++j)
+        {
+            if (i != 4 || j != 5)
+            {
+                EXPECT_NE(colors[i], colors[j]) << i << " " << j;
+            }
+        }
+    }
+
+    const auto [is_stable, num_iterations, unique, counts] = engine.compute_coloring(structure);
+    EXPECT_TRUE(is_stable);
+    EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), 0), structure.get_num_objects() + structure.get_num_atoms());
+}
+
+TEST(RelationalWLTests, MatchesAuxiliaryNodeEncoding)
+{
+    for (const auto ignore_counting : { false, true })
+    {
+        for (uint32_t seed = 0; seed < 20; ++seed)
+        {
+            auto rng = std::mt19937(seed);
+            const auto structure = create_random_structure(30, 40, rng);
+
+            auto engine = RelationalWeisfeilerLeman(ignore_counting);
+            const auto coloring = compute_stable_object_coloring(engine, structure);
+            EXPECT_TRUE(coloring.is_identical_to(compute_stable_encoded_coloring(structure, ignore_counting))) << seed;
+        }
+    }
+}
+
+TEST(RelationalWLTests, ArgumentOrder)
+{
+    // Adding the objects in the other order gives an isomorphic structure, swapping the arguments or the predicate does not.
+    const auto create = [](int predicate, bool swap_arguments, bool swap_objects)
+    {
+        auto structure = RelationalStructure();
+        const auto first = structure.add_object(swap_objects ? 1 : 0);
+        const auto second = structure.add_object(swap_objects ? 0 : 1);
+        const auto a = swap_objects ? second : first;
+        const auto b = swap_objects ? first : second;
+        structure.add_atom(predicate, swap_arguments ? std::vector<int> { b, a } : std::vector<int> { a, b });
+        return structure;
+    };
+
+    auto engine = RelationalWeisfeilerLeman();
+    const auto reference = engine.compute_coloring(create(0, false, false));
+    EXPECT_EQ(reference, engine.compute_coloring(create(0, false, true)));
+    EXPECT_NE(reference, engine.compute_coloring(create(0, true, false)));
+    EXPECT_NE(reference, engine.compute_coloring(create(1, false, false)));
+
+    auto structure = RelationalStructure();
+    structure.add_object();
+    EXPECT_THROW(structure.add_atom(0, { 1 }), std::out_of_range);
+    EXPECT_THROW(structure.add_atom(-1, { 0 }), std::invalid_argument);
+}
+
+}
@@ -0,0 +1,650 @@
+#include "random_graph.hpp"
+#include "wl/details/utils.hpp"
+#include "wl/details/vertex_invariants.hpp"
+#include "wl/details/weisfeiler_leman.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace wl::tests
+{
+
+/// @brief A cycle with num_nodes nodes and a path of length path_length attached to node 0.
+static EdgeColoredGraph create_lollipop(int num_nodes, int path_length, bool directed)
+{
+    auto graph = EdgeColoredGraph(directed);
+    for (int i = 0; i < num_nodes + path_length; ++i)
+    {
+        graph.add_node(i == 0 ? 1 : 0);
+    }
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        graph.add_edge(i, (i + 1) % num_nodes, i % 2);
+    }
+    for (int i = 0; i < path_length; ++i)
+    {
+        graph.add_edge(i == 0 ? 0 : num_nodes + i - 1, num_nodes + i);
+    }
+    return graph;
+}
+
+static std::vector<EdgeColoredGraph> create_graphs()
+{
+    auto graphs = std::vector<EdgeColoredGraph>();
+    for (int num_nodes = 3; num_nodes < 9; ++num_nodes)
+    {
+        for (int path_length = 0; path_length < 4; ++path_length)
+        {
+            graphs.push_back(create_lollipop(num_nodes, path_length, false));
+            graphs.push_back(create_lollipop(num_nodes, path_length, true));
+        }
+    }
+    return graphs;
+}
+
+TEST(WLTests, Factory)
+{
+    for (int k = 1; k <= 2; ++k)
+    {
+        for (bool ignore_counting : { false, true })
+        {
+            auto engine = create_weisfeiler_leman(k, ignore_counting, std::make_shared<ColorFunction>());
+            EXPECT_EQ(engine->get_k(), k);
+            EXPECT_EQ(engine->get_ignore_counting(), ignore_counting);
+        }
+    }
+    EXPECT_THROW(create_weisfeiler_leman(3, false, std::make_shared<ColorFunction>()), std::invalid_argument);
+}
+
+TEST(WLTests, SharedColorFunctionConcurrent)
+{
+    const auto graphs = create_graphs();
+
+    for (int k = 1; k <= 2; ++k)
+    {
+        auto serial = WeisfeilerLeman(k);
+        auto serial_results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>();
+        for (const auto& graph : graphs)
+        {
+            serial_results.push_back(serial.compute_coloring(graph));
+        }
+
+        auto color_function = std::make_shared<ColorFunction>();
+        auto concurrent_results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>(graphs.size());
+        auto threads = std::vector<std::thread>();
+        const size_t num_threads = 4;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back(
+                [&, t]()
+                {
+                    auto engine = WeisfeilerLeman(k, false, color_function);
+                    for (size_t i = t; i < graphs.size(); i += num_threads)
+                    {
+                        concurrent_results[i] = engine.compute_coloring(graphs[i]);
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < graphs.size(); ++i)
+        {
+            EXPECT_EQ(std::get<0>(serial_results[i]), std::get<0>(concurrent_results[i]));
+            EXPECT_EQ(std::get<1>(serial_results[i]), std::get<1>(concurrent_results[i]));
+
+            for (size_t j = 0; j < graphs.size(); ++j)
+            {
+                const auto serial_equal = std::get<2>(serial_results[i]) == std::get<2>(serial_results[j])
+                                          && std::get<3>(serial_results[i]) == std::get<3>(serial_results[j]);
+                const auto concurrent_equal = std::get<2>(concurrent_results[i]) == std::get<2>(concurrent_results[j])
+                                              && std::get<3>(concurrent_results[i]) == std::get<3>(concurrent_results[j]);
+                EXPECT_EQ(serial_equal, concurrent_equal);
+            }
+        }
+        EXPECT_EQ(serial.get_coloring_function_size(), color_function->size());
+    }
+}
+
+TEST(WLTests, FrozenColorFunction)
+{
+    const auto graphs = create_graphs();
+
+    for (int k = 1; k <= 2; ++k)
+    {
+        auto color_function = std::make_shared<ColorFunction>();
+        auto engine = WeisfeilerLeman(k, false, color_function);
+
+        // Train on the undirected graphs only.
+        auto trained_results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>();
+        for (size_t i = 0; i < graphs.size(); i += 2)
+        {
+            trained_results.push_back(engine.compute_coloring(graphs[i]));
+        }
+
+        color_function->freeze();
+        EXPECT_TRUE(color_function->is_frozen());
+        EXPECT_THROW(color_function->freeze(), std::logic_error);
+        const auto size = color_function->size();
+
+        // Concurrent inference reproduces the trained colors and maps unseen contexts to the unknown color.
+        auto results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>(graphs.size());
+        auto threads = std::vector<std::thread>();
+        const size_t num_threads = 4;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back(
+                [&, t]()
+                {
+                    for (size_t i = t; i < graphs.size(); i += num_threads)
+                    {
+                        results[i] = engine.compute_coloring(graphs[i]);
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < graphs.size(); ++i)
+        {
+            const auto& colors = std::get<2>(results[i]);
+            const auto has_unknown_color = std::find(colors.begin(), colors.end(), UNKNOWN_COLOR) != colors.end();
+            if (i % 2 == 0)
+            {
+                EXPECT_EQ(results[i], trained_results[i / 2]);
+                EXPECT_FALSE(has_unknown_color);
+            }
+            else
+            {
+                EXPECT_TRUE(has_unknown_color);
+            }
+        }
+        EXPECT_EQ(color_function->size(), size);
+    }
+
+    for (int k = 1; k <= 2; ++k)
+    {
+        auto color_function = std::make_shared<ColorFunction>();
+        auto engine = WeisfeilerLeman(k, false, color_function);
+        const auto trained_result = engine.compute_coloring(graphs[0]);
+
+        color_function->freeze(UnseenContextPolicy::THROW);
+        EXPECT_EQ(engine.compute_coloring(graphs[0]), trained_result);
+        EXPECT_THROW(engine.compute_coloring(graphs[1]), UnseenContextError);
+    }
+
+    // With unseen contexts, a round may merge and split colors, and pairs of the unknown color may have transposes of different colors.
+    // The compact pair colorings must agree with the expert interface, which colors every pair on its own and compares partitions.
+    // The coloring may never stabilize, so the rounds are capped. An unknown color of 0 also collides with a trained color.
+    const size_t max_num_iterations = 30;
+    for (auto layout : { PairColoringLayout::FULL, PairColoringLayout::UPPER_TRIANGLE })
+    {
+        for (Color unknown_color : { UNKNOWN_COLOR, 0 })
+        {
+            for (uint64_t seed = 0; seed < 40; ++seed)
+            {
+                auto rng = std::mt19937(seed);
+                auto color_function = std::make_shared<ColorFunction>();
+                auto engine = WeisfeilerLeman(2, false, color_function, PairColoringOptions { layout });
+                for (uint64_t i = 0; i < 3; ++i)
+                {
+                    engine.compute_coloring(create_random_graph(3 + i + seed % 5, 2 + seed % 7, false, rng, { .num_node_labels = 1, .num_edge_labels = 1, .simple = false }));
+                }
+                color_function->freeze(UnseenContextPolicy::UNKNOWN_COLOR, unknown_color);
+
+                const auto graph = create_random_graph(5 + seed % 5, 4 + seed % 11, seed % 2 == 1, rng, { .num_node_labels = 1, .num_edge_labels = 1, .simple = false });
+                auto current_coloring = engine.compute_initial_coloring(graph);
+                auto next_coloring = GraphColoring { std::vector<int>(current_coloring.colorings.size()) };
+                size_t num_iterations = 0;
+                bool is_stable = false;
+                while (!is_stable && num_iterations < max_num_iterations)
+                {
+                    ++num_iterations;
+                    is_stable = engine.compute_next_coloring(graph, current_coloring, next_coloring);
+                    std::swap(current_coloring, next_coloring);
+                }
+                auto [unique, counts] = current_coloring.get_frequencies();
+                lexical_sort(unique, counts);
+
+                EXPECT_EQ(engine.compute_coloring(graph, max_num_iterations), std::make_tuple(is_stable, num_iterations, unique, counts));
+            }
+        }
+    }
+}
+
+TEST(WLTests, CheckpointAndResume)
+{
+    const auto path = (std::filesystem::temp_directory_path() / "wl_checkpoint_test.bin").string();
+    const auto graph = create_lollipop(8, 3, false);
+
+    for (auto layout : { PairColoringLayout::FULL, PairColoringLayout::UPPER_TRIANGLE })
+    {
+        const auto options = PairColoringOptions { layout };
+
+        auto reference = WeisfeilerLeman(2, false, nullptr, options);
+        const auto expected = reference.compute_coloring(graph);
+        ASSERT_GT(std::get<1>(expected), 2);
+
+        // Stop after two rounds, with a checkpoint after the first round.
+        auto interrupted = WeisfeilerLeman(2, false, nullptr, options);
+        const auto partial = interrupted.compute_coloring_with_checkpoints(graph, CheckpointOptions { path, 1, 0 }, 2);
+        EXPECT_EQ(std::get<1>(partial), 2);
+
+        auto resumed = WeisfeilerLeman(2, false, nullptr, options);
+        EXPECT_EQ(resumed.resume_coloring(graph, path), expected);
+        EXPECT_EQ(resumed.get_coloring_function_size(), reference.get_coloring_function_size());
+
+        EXPECT_THROW(resumed.resume_coloring(create_lollipop(8, 2, false), path), std::invalid_argument);
+        EXPECT_THROW(WeisfeilerLeman(2, true).resume_coloring(graph, path), std::invalid_argument);
+    }
+
+    EXPECT_THROW(WeisfeilerLeman(1).compute_coloring_with_checkpoints(graph, CheckpointOptions { path, 1, 0 }), std::logic_error);
+    std::filesystem::remove(path);
+}
+
+/// @brief The stable coloring by the expert interface.
+static GraphColoring compute_stable_coloring(WeisfeilerLeman& engine, const EdgeColoredGraph& graph)
+{
+    auto current_coloring = engine.compute_initial_coloring(graph);
+    auto next_coloring = current_coloring;
+    while (!engine.compute_next_coloring(graph, current_coloring, next_coloring))
+        std::swap(current_coloring, next_coloring);
+    return next_coloring;
+}
+
+TEST(WLTests, InvariantSeeding)
+{
+    auto graphs = create_graphs();
+    auto rng = std::mt19937(0);
+    for (int i = 0; i < 20; ++i)
+        graphs.push_back(create_random_graph(12, 18, i % 2 == 0, rng, { .simple = false }));
+
+    for (int k = 1; k <= 2; ++k)
+    {
+        for (bool ignore_counting : { false, true })
+        {
+            auto reference = WeisfeilerLeman(k, ignore_counting);
+            auto seeded = WeisfeilerLeman(k, ignore_counting);
+            seeded.set_invariant_seeding(true);
+            EXPECT_TRUE(seeded.get_invariant_seeding());
+
+            for (const auto& graph : graphs)
+            {
+                // Seeding keeps the stable partition and never takes more rounds.
+                EXPECT_TRUE(compute_stable_coloring(seeded, graph).is_identical_to(compute_stable_coloring(reference, graph)));
+
+                const auto [reference_is_stable, reference_num_iterations, reference_unique, reference_counts] = reference.compute_coloring(graph);
+                const auto [is_stable, num_iterations, unique, counts] = seeded.compute_coloring(graph);
+                EXPECT_LE(num_iterations, reference_num_iterations);
+                EXPECT_EQ(unique.size(), reference_unique.size());
+            }
+        }
+    }
+
+    // On a path with equal labels, the first round only finds the ends, which the degrees already tell apart.
+    auto path = EdgeColoredGraph(false);
+    for (int i = 0; i < 20; ++i)
+        path.add_node(0);
+    for (int i = 0; i + 1 < 20; ++i)
+        path.add_edge(i, i + 1);
+
+    auto reference = WeisfeilerLeman(1);
+    auto seeded = WeisfeilerLeman(1);
+    seeded.set_invariant_seeding(true);
+    EXPECT_EQ(std::get<1>(seeded.compute_coloring(path)) + 1, std::get<1>(reference.compute_coloring(path)));
+
+    // Triangles separate the nodes of two triangles from those of a hexagon before any round of 2-FWL.
+    auto triangles = EdgeColoredGraph(false);
+    for (int i = 0; i < 12; ++i)
+        triangles.add_node(0);
+    for (int i = 0; i < 3; ++i)
+    {
+        triangles.add_edge(i, (i + 1) % 3);
+        triangles.add_edge(3 + i, 3 + (i + 1) % 3);
+    }
+    for (int i = 0; i < 6; ++i)
+        triangles.add_edge(6 + i, 6 + (i + 1) % 6);
+
+    EXPECT_EQ(count_triangles(triangles), (std::vector<int64_t> { 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0 }));
+    auto pair_seeded = WeisfeilerLeman(2);
+    pair_seeded.set_invariant_seeding(true);
+    const auto initial_coloring = pair_seeded.compute_initial_coloring(triangles);
+    EXPECT_NE(initial_coloring.colorings[0], initial_coloring.colorings[6 * 12 + 6]);
+}
+
+TEST(WLTests, ResultCache)
+{
+    const auto graphs = create_graphs();
+
+    for (int k = 1; k <= 2; ++k)
+    {
+        auto reference = WeisfeilerLeman(k);
+        auto cached = WeisfeilerLeman(k);
+        cached.set_cache_capacity(graphs.size());
+
+        // The second pass is answered from the cache, rebuilding an equal graph gives the same key.
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (const auto& graph : graphs)
+            {
+                EXPECT_EQ(cached.compute_coloring(graph), reference.compute_coloring(graph));
+            }
+        }
+        EXPECT_EQ(cached.compute_coloring(create_lollipop(5, 2, true)), reference.compute_coloring(create_lollipop(5, 2, true)));
+
+        auto statistics = cached.get_cache_statistics();
+        EXPECT_EQ(statistics.num_misses, graphs.size());
+        EXPECT_EQ(statistics.num_hits, graphs.size() + 1);
+        EXPECT_EQ(statistics.num_evictions, 0);
+        EXPECT_EQ(statistics.size, graphs.size());
+
+        // The iteration limit is part of the key.
+        EXPECT_EQ(cached.compute_coloring(graphs[0], 1), reference.compute_coloring(graphs[0], 1));
+        statistics = cached.get_cache_statistics();
+        EXPECT_EQ(statistics.num_misses, graphs.size() + 1);
+        EXPECT_EQ(statistics.num_evictions, 1);
+    }
+
+    // The least recently used result is evicted first.
+    auto engine = WeisfeilerLeman(1);
+    engine.set_cache_capacity(2);
+    engine.compute_coloring(graphs[0]);
+    engine.compute_coloring(graphs[1]);
+    engine.compute_coloring(graphs[0]);
+    engine.compute_coloring(graphs[2]);
+    engine.compute_coloring(graphs[0]);
+    engine.compute_coloring(graphs[1]);
+    const auto statistics = engine.get_cache_statistics();
+    EXPECT_EQ(statistics.num_hits, 2);
+    EXPECT_EQ(statistics.num_misses, 4);
+    EXPECT_EQ(statistics.num_evictions, 2);
+    EXPECT_EQ(statistics.capacity, 2);
+
+    engine.set_cache_capacity(0);
+    engine.compute_coloring(graphs[0]);
+    EXPECT_EQ(engine.get_cache_statistics().num_misses, 0);
+}
+
+TEST(WLTests, PairColoringLayouts)
+{
+    auto graphs = create_graphs();
+
+    // Enough pair colors to widen the storage beyond uint8_t
+    auto large_graph = EdgeColoredGraph(true);
+    for (int i = 0; i < 24; ++i)
+        large_graph.add_node(i % 3);
+    for (int i = 0; i < 24; ++i)
+    {
+        large_graph.add_edge(i, (i + 1) % 24, i % 2);
+        large_graph.add_edge(i, (i * 7 + 3) % 24);
+    }
+    graphs.push_back(std::move(large_graph));
+
+    for (bool ignore_counting : { false, true })
+    {
+        auto expert = WeisfeilerLeman(2, ignore_counting);
+        auto full = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { PairColoringLayout::FULL });
+        auto triangle = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { PairColoringLayout::UPPER_TRIANGLE });
+
+        auto full_results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>();
+        auto triangle_results = std::vector<std::tuple<bool, size_t, std::vector<int>, std::vector<int>>>();
+
+        for (const auto& graph : graphs)
+        {
+            // The expert interface assigns colors in the same order as the full layout.
+            auto current_coloring = expert.compute_initial_coloring(graph);
+            auto next_coloring = current_coloring;
+            size_t num_iterations = 1;
+            while (!expert.compute_next_coloring(graph, current_coloring, next_coloring))
+            {
+                std::swap(current_coloring, next_coloring);
+                ++num_iterations;
+            }
+            auto [unique, counts] = next_coloring.get_frequencies();
+            lexical_sort(unique, counts);
+
+            full_results.push_back(full.compute_coloring(graph));
+            EXPECT_EQ(std::get<1>(full_results.back()), num_iterations);
+            EXPECT_EQ(std::get<2>(full_results.back()), unique);
+            EXPECT_EQ(std::get<3>(full_results.back()), counts);
+
+            triangle_results.push_back(triangle.compute_coloring(graph));
+            EXPECT_EQ(std::get<1>(triangle_results.back()), num_iterations);
+            EXPECT_EQ(std::get<3>(triangle_results.back()).size(), counts.size());
+        }
+
+        for (size_t i = 0; i < graphs.size(); ++i)
+        {
+            for (size_t j = 0; j < graphs.size(); ++j)
+            {
+                EXPECT_EQ(full_results[i] == full_results[j], triangle_results[i] == triangle_results[j]);
+            }
+        }
+    }
+}
+
+TEST(WLTests, MappedPairColorings)
+{
+    auto graphs = create_graphs();
+    auto rng = std::mt19937(0);
+    for (int i = 0; i < 6; ++i)
+        graphs.push_back(create_random_graph(40, 60, i % 2 == 0, rng, { .simple = false }));
+
+    const auto path = (std::filesystem::temp_directory_path() / "wl_mapped_checkpoint_test.bin").string();
+
+    for (auto layout : { PairColoringLayout::FULL, PairColoringLayout::UPPER_TRIANGLE })
+    {
+        for (bool ignore_counting : { false, true })
+        {
+            auto memory = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { layout, PairColoringStorage::MEMORY });
+            auto mapped = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { layout, PairColoringStorage::MAPPED_FILE });
+
+            for (const auto& graph : graphs)
+            {
+                EXPECT_EQ(mapped.compute_coloring(graph), memory.compute_coloring(graph));
+            }
+            EXPECT_EQ(mapped.get_coloring_function_size(), memory.get_coloring_function_size());
+
+            // A checkpoint of a mapped run resumes into a mapped run.
+            const auto& graph = graphs.back();
+            auto interrupted = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { layout, PairColoringStorage::MAPPED_FILE });
+            interrupted.compute_coloring_with_checkpoints(graph, CheckpointOptions { path, 1, 0 }, 2);
+
+            auto resumed = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { layout, PairColoringStorage::MAPPED_FILE });
+            auto reference = WeisfeilerLeman(2, ignore_counting, nullptr, PairColoringOptions { layout });
+            EXPECT_EQ(resumed.resume_coloring(graph, path), reference.compute_coloring(graph));
+        }
+    }
+    std::filesystem::remove(path);
+
+    // Entries widen within the mapped file and survive a round trip through the binary form.
+    auto matrix = PairColorMatrix(PairColoringOptions { PairColoringLayout::FULL, PairColoringStorage::MAPPED_FILE });
+    matrix.reset(20, PairColoringLayout::FULL, 1);
+    for (int i = 0; i < 20; ++i)
+    {
+        auto row = std::vector<uint32_t>();
+        for (int j = 0; j < 20; ++j)
+            row.push_back(matrix.add_color(i * 20 + j));
+        matrix.set_row(i, row);
+    }
+    EXPECT_EQ(matrix.get_bytes_per_entry(), sizeof(uint16_t));
+    EXPECT_EQ(matrix.get_local_color(19, 18), 398u);
+
+    auto stream = std::stringstream();
+    matrix.write(stream);
+    auto copy = PairColorMatrix();
+    copy.read(stream);
+    EXPECT_EQ(copy.get_storage(), PairColoringStorage::MEMORY);
+    EXPECT_EQ(copy.get_frequencies(), matrix.get_frequencies());
+    EXPECT_EQ(copy.get_local_color(19, 18), 398u);
+
+    auto unmappable = PairColorMatrix(PairColoringOptions { PairColoringLayout::FULL, PairColoringStorage::MAPPED_FILE, "/nonexistent/directory" });
+    EXPECT_THROW(unmappable.reset(4, PairColoringLayout::FULL, 1), std::runtime_error);
+}
+
+TEST(WLTests, IgnoreCountingMatchesSortedSets)
+{
+    // A reference round of set-semantics 1-WL that sorts and deduplicates the adjacent colors of every node
+    auto compute_reference = [](const EdgeColoredGraph& graph, const std::vector<Color>& colors, ColorFunction& color_function)
+    {
+        auto get_adjacent_colors = [&](const std::vector<int>& adjacent, const std::vector<EdgeId>& edges)
+        {
+            auto adjacent_colors = std::vector<AdjacentColor>();
+            for (size_t i = 0; i < adjacent.size(); ++i)
+                adjacent_colors.emplace_back(colors[adjacent[i]], graph.get_edge_label(edges[i]));
+            std::sort(adjacent_colors.begin(), adjacent_colors.end());
+            adjacent_colors.erase(std::unique(adjacent_colors.begin(), adjacent_colors.end()), adjacent_colors.end());
+            return adjacent_colors;
+        };
+
+        auto next_colors = std::vector<Color>(colors.size());
+        for (int node = 0; node < graph.get_num_nodes(); ++node)
+        {
+            next_colors[node] = color_function.get_or_insert(
+                { colors[node],
+                  get_adjacent_colors(graph.get_outbound_adjacent(node), graph.get_outbound_edges(node)),
+                  graph.is_directed() ? get_adjacent_colors(graph.get_inbound_adjacent(node), graph.get_inbound_edges(node)) : std::vector<AdjacentColor>() });
+        }
+        return next_colors;
+    };
+
+    for (const auto& graph : create_graphs())
+    {
+        auto engine = WeisfeilerLeman(1, true);
+        auto reference_color_function = ColorFunction();
+
+        auto coloring = engine.compute_initial_coloring(graph);
+        auto reference_colors = std::vector<Color>();
+        for (int node = 0; node < graph.get_num_nodes(); ++node)
+            reference_colors.push_back(reference_color_function.get_or_insert({ -graph.get_node_label(node) - 1, {}, {} }));
+        ASSERT_EQ(coloring.colorings, reference_colors);
+
+        for (int iteration = 0; iteration < 5; ++iteration)
+        {
+            auto next_coloring = GraphColoring { std::vector<int>(graph.get_num_nodes()) };
+            engine.compute_next_coloring(graph, coloring, next_coloring);
+            reference_colors = compute_reference(graph, reference_colors, reference_color_function);
+            ASSERT_EQ(next_coloring.colorings, reference_colors);
+            coloring = std::move(next_coloring);
+        }
+    }
+}
+
+TEST(WLTests, AtomicTypes)
+{
+    // Large enough to build the atomic types in parallel, with multi-edges, self-loops, and isolated nodes.
+    // The edges join the first half of the nodes, so they are dense enough to repeat, and the second half stays isolated.
+    const int num_nodes = 520;
+    auto rng = std::mt19937(42);
+    auto graph = create_random_graph(num_nodes / 2, 2 * num_nodes, true, rng, { .num_node_labels = 3, .simple = false });
+    for (int v = 0; v < num_nodes / 2; v += 4)
+    {
+        graph.add_edge(v, v, static_cast<int>(rng() % 2));
+    }
+    for (int i = num_nodes / 2; i < num_nodes; ++i)
+    {
+        graph.add_node(i % 3);
+    }
+
+    const auto get_labels = [&](int src, int dst)
+    {
+        auto labels = std::vector<int>();
+        for (const auto& edge : graph.get_edges(src, dst))
+            labels.push_back(graph.get_edge_label(edge));
+        std::sort(labels.begin(), labels.end());
+        return labels;
+    };
+
+    auto engine = WeisfeilerLeman(2, false);
+    const auto coloring = engine.compute_initial_coloring(graph);
+
+    // Two pairs have the same atomic type iff their labels, the edges between them, and their self-loops match.
+    using AtomicType = std::tuple<int, int, std::vector<int>, std::vector<int>, std::vector<int>, std::vector<int>>;
+    auto colors = std::map<AtomicType, int>();
+    auto types = std::map<int, AtomicType>();
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        for (int j = 0; j < num_nodes; ++j)
+        {
+            auto type = AtomicType { graph.get_node_label(i), graph.get_node_label(j), get_labels(i, j), get_labels(j, i), get_labels(i, i), get_labels(j, j) };
+            const auto color = coloring.colorings[i * num_nodes + j];
+            ASSERT_EQ(colors.emplace(type, color).first->second, color);
+            ASSERT_EQ(types.emplace(color, type).first->second, type);
+        }
+    }
+}
+
+TEST(WLTests, LargeLabels)
+{
+    EXPECT_EQ(pairing_function(UINT32_MAX, UINT32_MAX), UINT64_MAX);
+    EXPECT_EQ(pairing_function(0, UINT32_MAX), UINT64_MAX - 2 * uint64_t(UINT32_MAX));
+
+    // Relabeling injectively must not change the colors, even with labels far beyond the range of squared ints.
+    const auto relabel = [](int label) { return label == 0 ? 0 : INT_MAX - label; };
+    for (const auto& graph : create_graphs())
+    {
+        auto relabeled = EdgeColoredGraph(graph.is_directed());
+        for (int v = 0; v < graph.get_num_nodes(); ++v)
+        {
+            relabeled.add_node(relabel(graph.get_node_label(v)));
+        }
+        for (int v = 0; v < graph.get_num_nodes(); ++v)
+        {
+            for (const auto& [u, label] : graph.get_outbound_neighbors(v))
+            {
+                if (graph.is_directed() || v <= u)
+                    relabeled.add_edge(v, u, relabel(label));
+            }
+        }
+
+        for (int k = 1; k <= 2; ++k)
+        {
+            EXPECT_EQ(WeisfeilerLeman(k).compute_coloring(graph), WeisfeilerLeman(k).compute_coloring(relabeled));
+        }
+    }
+}
+
+TEST(WLTests, NodeColorHistory)
+{
+    for (int k = 1; k <= 2; ++k)
+    {
+        for (const auto& graph : create_graphs())
+        {
+            auto engine = WeisfeilerLeman(k);
+            const auto [is_stable, num_iterations, unique, counts] = engine.compute_coloring(graph);
+
+            auto stream = std::ostringstream();
+            const auto [history_is_stable, history_num_iterations, history] = engine.compute_node_color_history(graph, std::numeric_limits<size_t>::max(), &stream);
+            EXPECT_EQ(history_is_stable, is_stable);
+            EXPECT_EQ(history_num_iterations, num_iterations);
+            EXPECT_EQ(history.num_nodes, graph.get_num_nodes());
+            EXPECT_EQ(history.num_rounds, static_cast<int>(num_iterations) + 1);
+            ASSERT_EQ(history.colors.size(), static_cast<size_t>(history.num_nodes) * history.num_rounds);
+            EXPECT_EQ(stream.str(), std::string(reinterpret_cast<const char*>(history.colors.data()), history.colors.size() * sizeof(int32_t)));
+
+            if (k == 1)
+            {
+                // The last round is the coloring of compute_coloring, whose contexts are all known by now
+                auto last_round = GraphColoring();
+                for (int node = 0; node < history.num_nodes; ++node)
+                    last_round.colorings.push_back(history.get_color(node, history.num_rounds - 1));
+                auto [last_unique, last_counts] = last_round.get_frequencies();
+                lexical_sort(last_unique, last_counts);
+                EXPECT_EQ(last_unique, unique);
+                EXPECT_EQ(last_counts, counts);
+            }
+        }
+    }
+}
+
+}